@@ -0,0 +1,50 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "libzerocoin/Zerocoin.h"
+#include "zerocoin_params.h"
+
+/* Number of operations per iteration */
+static const int OPS_PER_RUN = 100;
+
+// 3072 bit modular exponentiation with a 256 bit exponent, as in the spend proofs
+static void BigNum_PowMod(benchmark::State& state)
+{
+    CBigNum modulus(ZEROCOIN_MODULUS);
+    CBigNum base = CBigNum::randBignum(modulus);
+    CBigNum exponent = CBigNum::randBignum(CBigNum(2).pow(256));
+    while (state.KeepRunning()) {
+        CBigNum result = base.pow_mod(exponent, modulus);
+        assert(result < modulus);
+    }
+}
+
+static void BigNum_MulMod(benchmark::State& state)
+{
+    CBigNum modulus(ZEROCOIN_MODULUS);
+    CBigNum a = CBigNum::randBignum(modulus);
+    CBigNum b = CBigNum::randBignum(modulus);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < OPS_PER_RUN; i++)
+            a = a.mul_mod(b, modulus);
+    }
+}
+
+// Chains of small operations producing temporaries, as in the proof challenges and responses
+static void BigNum_Temporaries(benchmark::State& state)
+{
+    CBigNum modulus(ZEROCOIN_MODULUS);
+    CBigNum a = CBigNum::randBignum(modulus);
+    CBigNum b = CBigNum::randBignum(modulus);
+    CBigNum c = CBigNum::randBignum(modulus);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < OPS_PER_RUN; i++)
+            a = (a + b * c - b) % modulus;
+    }
+}
+
+BENCHMARK(BigNum_PowMod);
+BENCHMARK(BigNum_MulMod);
+BENCHMARK(BigNum_Temporaries);
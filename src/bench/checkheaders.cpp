@@ -0,0 +1,79 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "arith_uint256.h"
+#include "consensus/params.h"
+#include "main.h"
+#include "pow.h"
+#include "util.h"
+
+#include <boost/thread.hpp>
+
+/* Number of headers in a full headers message */
+static const int HEADERS_COUNT = MAX_HEADERS_RESULTS;
+
+// Builds a continuous chain of headers that satisfy a trivial target, starting at height 1.
+static void CreateHeaders(const Consensus::Params& consensusParams, std::vector<CBlockHeader>& headers)
+{
+    headers.resize(HEADERS_COUNT);
+    uint256 hashPrev;
+    for (int i = 0; i < HEADERS_COUNT; i++) {
+        CBlockHeader& header = headers[i];
+        header.SetNull();
+        header.nVersion = 2;
+        header.hashPrevBlock = hashPrev;
+        header.nTime = 1500000000 + i * 150;
+        header.nBits = UintToArith256(consensusParams.powLimit).GetCompact();
+        while (!CheckProofOfWork(header.GetPoWHash(i + 1), header.nBits, consensusParams))
+            header.nNonce++;
+        hashPrev = header.GetHash();
+    }
+}
+
+// Times only the proof-of-work stage of accepting a headers message, CheckBlockHeadersPoW(),
+// not the contextual checks and block index updates of AcceptBlockHeader().
+static void CheckHeadersPoWOnly(benchmark::State& state, int nThreads)
+{
+    Consensus::Params consensusParams;
+    consensusParams.powLimit = uint256S("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    std::vector<CBlockHeader> headers;
+    CreateHeaders(consensusParams, headers);
+
+    std::vector<bool> vCheck(headers.size(), true);
+
+    boost::thread_group threadGroup;
+    int nHeaderCheckThreadsOld = nHeaderCheckThreads;
+    nHeaderCheckThreads = nThreads > 1 ? nThreads : 0;
+    for (int i = 0; i < nThreads - 1; i++)
+        threadGroup.create_thread(&ThreadHeaderCheck);
+
+    std::vector<uint256> vPoWHashes;
+    bool fValid = true;
+    while (state.KeepRunning()) {
+        fValid &= CheckBlockHeadersPoW(headers, 1, vCheck, consensusParams, vPoWHashes);
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+    nHeaderCheckThreads = nHeaderCheckThreadsOld;
+
+    if (!fValid) {
+        fprintf(stderr, "CheckHeadersPoWOnly: headers failed the proof-of-work check\n");
+        abort();
+    }
+}
+
+static void CheckHeadersPoWOnly_Serial(benchmark::State& state)
+{
+    CheckHeadersPoWOnly(state, 1);
+}
+
+static void CheckHeadersPoWOnly_Parallel(benchmark::State& state)
+{
+    CheckHeadersPoWOnly(state, std::min(GetNumCores(), MAX_SCRIPTCHECK_THREADS));
+}
+
+BENCHMARK(CheckHeadersPoWOnly_Serial);
+BENCHMARK(CheckHeadersPoWOnly_Parallel);
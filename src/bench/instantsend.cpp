@@ -0,0 +1,198 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "activebznode.h"
+#include "bznodeman.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "coins.h"
+#include "instantx.h"
+#include "key.h"
+#include "main.h"
+#include "random.h"
+#include "streams.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* Bznodes in the list, the top COutPointLock::SIGNATURES_TOTAL of them vote */
+static const int BZNODES_COUNT = 1000;
+/* Lock requests in a burst and inputs per request */
+static const int LOCK_REQUESTS = 50;
+static const int LOCK_INPUTS = 2;
+/* Height of the chain tip and of the locked inputs */
+static const int CHAIN_HEIGHT = 100;
+static const int INPUTS_HEIGHT = 50;
+
+struct InstantSendBenchData;
+
+/**
+ * Installs the chain, UTXO set and bznode list of the benchmark data in the global
+ * state while it is in scope and puts back the previous ones afterwards. Chain params
+ * are switched to regtest, and back to the previous network if one was selected.
+ */
+class InstantSendBenchScope
+{
+private:
+    std::string strNetworkPrev;
+    CCoinsViewCache* pcoinsTipPrev;
+    CBlockIndex* pindexTipPrev;
+    CDataStream ssBznodesPrev;
+    CKey keyBznodePrev;
+    CPubKey pubKeyBznodePrev;
+
+public:
+    explicit InstantSendBenchScope(InstantSendBenchData& data);
+    ~InstantSendBenchScope();
+};
+
+/**
+ * A chain, a UTXO set and a bznode list, and a burst of lock requests with the
+ * votes of the quorum of their inputs, created on first use and shared by the
+ * benchmarks. They are only in the global state inside an InstantSendBenchScope.
+ */
+struct InstantSendBenchData
+{
+    std::vector<uint256> vecBlockHashes;
+    std::vector<CBlockIndex> vecBlockIndex;
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins;
+    std::vector<CBznode> vecBznodes;
+    std::vector<COutPoint> vecQuorum;
+    std::vector<CTxLockRequest> vecLockRequests;
+    std::vector<std::vector<CTxLockVote> > vecVotes;
+
+    InstantSendBenchData() :
+        vecBlockHashes(CHAIN_HEIGHT + 1),
+        vecBlockIndex(CHAIN_HEIGHT + 1),
+        coins(&coinsDummy)
+    {
+        for (int i = 0; i <= CHAIN_HEIGHT; i++) {
+            vecBlockHashes[i] = GetRandHash();
+            vecBlockIndex[i].phashBlock = &vecBlockHashes[i];
+            vecBlockIndex[i].nHeight = i;
+            vecBlockIndex[i].pprev = i > 0 ? &vecBlockIndex[i - 1] : NULL;
+        }
+
+        CMutableTransaction txFunding;
+        txFunding.vout.resize(LOCK_REQUESTS * LOCK_INPUTS, CTxOut(COIN, CScript() << OP_TRUE));
+        CTransaction txFundingFinal(txFunding);
+        coins.ModifyCoins(txFundingFinal.GetHash())->FromTx(txFundingFinal, INPUTS_HEIGHT);
+
+        std::map<COutPoint, CKey> mapBznodeKeys;
+        for (int i = 0; i < BZNODES_COUNT; i++) {
+            CKey key;
+            key.MakeNewKey(true);
+            vecBznodes.push_back(CBznode(CService(), CTxIn(COutPoint(GetRandHash(), 0)), key.GetPubKey(), key.GetPubKey(), PROTOCOL_VERSION));
+            mapBznodeKeys[vecBznodes.back().vin.prevout] = key;
+        }
+
+        InstantSendBenchScope scope(*this);
+
+        // the same rule as CTxLockVote::IsValid()
+        vecQuorum = mnodeman.GetTopRankedOutpoints(INPUTS_HEIGHT + 4, COutPointLock::SIGNATURES_TOTAL, MIN_INSTANTSEND_PROTO_VERSION);
+        assert((int)vecQuorum.size() == COutPointLock::SIGNATURES_TOTAL);
+
+        for (int i = 0; i < LOCK_REQUESTS; i++) {
+            CMutableTransaction tx;
+            for (int j = 0; j < LOCK_INPUTS; j++)
+                tx.vin.push_back(CTxIn(COutPoint(txFundingFinal.GetHash(), i * LOCK_INPUTS + j)));
+            tx.vout.push_back(CTxOut(LOCK_INPUTS * COIN / 2, CScript() << OP_TRUE));
+            vecLockRequests.push_back(CTxLockRequest(tx));
+
+            std::vector<CTxLockVote> vecRequestVotes;
+            BOOST_FOREACH(const CTxIn& txin, tx.vin) {
+                BOOST_FOREACH(const COutPoint& outpointBznode, vecQuorum) {
+                    CTxLockVote vote(tx.GetHash(), txin.prevout, outpointBznode);
+                    activeBznode.keyBznode = mapBznodeKeys[outpointBznode];
+                    activeBznode.pubKeyBznode = activeBznode.keyBznode.GetPubKey();
+                    assert(vote.Sign());
+                    vecRequestVotes.push_back(vote);
+                }
+            }
+            vecVotes.push_back(vecRequestVotes);
+        }
+    }
+
+    static InstantSendBenchData& Get()
+    {
+        static InstantSendBenchData data;
+        return data;
+    }
+};
+
+InstantSendBenchScope::InstantSendBenchScope(InstantSendBenchData& data) :
+    ssBznodesPrev(SER_DISK, CLIENT_VERSION)
+{
+    if (AreBaseParamsConfigured())
+        strNetworkPrev = Params().NetworkIDString();
+    SelectParams(CBaseChainParams::REGTEST);
+
+    LOCK(cs_main);
+    pcoinsTipPrev = pcoinsTip;
+    pindexTipPrev = chainActive.Tip();
+    ssBznodesPrev << mnodeman;
+    keyBznodePrev = activeBznode.keyBznode;
+    pubKeyBznodePrev = activeBznode.pubKeyBznode;
+
+    chainActive.SetTip(&data.vecBlockIndex.back());
+    pcoinsTip = &data.coins;
+    mnodeman.Clear();
+    for (size_t i = 0; i < data.vecBznodes.size(); i++)
+        mnodeman.Add(data.vecBznodes[i]);
+}
+
+InstantSendBenchScope::~InstantSendBenchScope()
+{
+    {
+        LOCK(cs_main);
+        activeBznode.keyBznode = keyBznodePrev;
+        activeBznode.pubKeyBznode = pubKeyBznodePrev;
+        mnodeman.Clear();
+        ssBznodesPrev >> mnodeman;
+        pcoinsTip = pcoinsTipPrev;
+        chainActive.SetTip(pindexTipPrev);
+    }
+    if (!strNetworkPrev.empty())
+        SelectParams(strNetworkPrev);
+}
+
+// The votes were verified once when they were signed, so this measures the
+// votes that reach us from several peers: signature cache, UTXO lookup, quorum
+// rank and the vote bookkeeping of the lock candidates.
+static void InstantSend_VoteBurst(benchmark::State& state)
+{
+    InstantSendBenchData& data = InstantSendBenchData::Get();
+    InstantSendBenchScope scope(data);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < data.vecLockRequests.size(); i++) {
+            CTxLockCandidate txLockCandidate(data.vecLockRequests[i]);
+            BOOST_FOREACH(const CTxIn& txin, data.vecLockRequests[i].vin)
+                txLockCandidate.AddOutPointLock(txin.prevout);
+            BOOST_FOREACH(const CTxLockVote& vote, data.vecVotes[i]) {
+                if (vote.IsValid(NULL))
+                    txLockCandidate.AddVote(vote);
+            }
+            assert(txLockCandidate.IsAllOutPointsReady());
+        }
+    }
+}
+
+static void InstantSend_QuorumRank(benchmark::State& state)
+{
+    InstantSendBenchData& data = InstantSendBenchData::Get();
+    InstantSendBenchScope scope(data);
+    COutPoint outpointOther(GetRandHash(), 0);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < data.vecQuorum.size(); i++)
+            assert(instantsend.GetLockQuorumRank(data.vecQuorum[i], INPUTS_HEIGHT + 4) == (int)i + 1);
+        assert(instantsend.GetLockQuorumRank(outpointOther, INPUTS_HEIGHT + 4) == -1);
+    }
+}
+
+BENCHMARK(InstantSend_VoteBurst);
+BENCHMARK(InstantSend_QuorumRank);
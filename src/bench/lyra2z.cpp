@@ -0,0 +1,121 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "primitives/block.h"
+#include "crypto/Lyra2Z/Lyra2Z.h"
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Sponge.h"
+
+#include <vector>
+
+/* Number of block headers to hash per iteration */
+static const int HEADERS_PER_RUN = 100;
+
+static void Lyra2Z_Alloc(benchmark::State& state)
+{
+    std::vector<char> header(80, 0);
+    char hash[32];
+    while (state.KeepRunning()) {
+        for (int i = 0; i < HEADERS_PER_RUN; i++) {
+            header[76] = i;
+            lyra2z_hash(&header[0], hash);
+        }
+    }
+}
+
+static void Lyra2Z_Context(benchmark::State& state)
+{
+    std::vector<char> header(80, 0);
+    char hash[32];
+    lyra2_ctx ctx;
+    LYRA2_init(&ctx, 8, 8);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < HEADERS_PER_RUN; i++) {
+            header[76] = i;
+            lyra2z_hash_ctx(&ctx, &header[0], hash);
+        }
+    }
+    LYRA2_free(&ctx);
+}
+
+static void Lyra2_330x256_Alloc(benchmark::State& state)
+{
+    std::vector<char> header(80, 0);
+    char hash[32];
+    while (state.KeepRunning()) {
+        header[76]++;
+        LYRA2(hash, 32, &header[0], 80, &header[0], 80, 2, 330, 256);
+    }
+}
+
+static void Lyra2_330x256_Context(benchmark::State& state)
+{
+    std::vector<char> header(80, 0);
+    char hash[32];
+    lyra2_ctx ctx;
+    LYRA2_init(&ctx, 330, 256);
+    while (state.KeepRunning()) {
+        header[76]++;
+        LYRA2_hash(&ctx, hash, 32, &header[0], 80, &header[0], 80, 2);
+    }
+    LYRA2_free(&ctx);
+}
+
+static void Lyra2Z_Impl(benchmark::State& state, int impl)
+{
+    int nDefaultImpl = spongeGetImpl();
+    if (!spongeSetImpl(impl)) {
+        while (state.KeepRunning()) {}
+        return;
+    }
+    std::vector<char> header(80, 0);
+    char hash[32];
+    lyra2_ctx ctx;
+    LYRA2_init(&ctx, 8, 8);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < HEADERS_PER_RUN; i++) {
+            header[76] = i;
+            lyra2z_hash_ctx(&ctx, &header[0], hash);
+        }
+    }
+    LYRA2_free(&ctx);
+    spongeSetImpl(nDefaultImpl);
+}
+
+static void Lyra2Z_Scalar(benchmark::State& state)
+{
+    Lyra2Z_Impl(state, SPONGE_IMPL_SCALAR);
+}
+
+static void Lyra2Z_SSE2(benchmark::State& state)
+{
+    Lyra2Z_Impl(state, SPONGE_IMPL_SSE2);
+}
+
+static void Lyra2Z_AVX2(benchmark::State& state)
+{
+    Lyra2Z_Impl(state, SPONGE_IMPL_AVX2);
+}
+
+static void BlockHeader_GetPoWHash(benchmark::State& state)
+{
+    CBlockHeader header;
+    header.SetNull();
+    while (state.KeepRunning()) {
+        for (int i = 0; i < HEADERS_PER_RUN; i++) {
+            header.nNonce = i;
+            header.GetPoWHash(1);
+        }
+    }
+}
+
+BENCHMARK(Lyra2Z_Alloc);
+BENCHMARK(Lyra2Z_Context);
+BENCHMARK(Lyra2_330x256_Alloc);
+BENCHMARK(Lyra2_330x256_Context);
+BENCHMARK(Lyra2Z_Scalar);
+BENCHMARK(Lyra2Z_SSE2);
+BENCHMARK(Lyra2Z_AVX2);
+BENCHMARK(BlockHeader_GetPoWHash);
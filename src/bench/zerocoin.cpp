@@ -0,0 +1,227 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "streams.h"
+#include "zerocoin.h"
+
+#include <vector>
+
+/* Number of coins accumulated per iteration and in the test accumulator */
+static const int COINS_PER_RUN = 10;
+/* Number of serials and public coins in the lookup tables */
+static const int STATE_COINS = 10000;
+
+/**
+ * Coins and a spend of one of them under the V1 or the V2 parameters, created on
+ * first use and shared by the benchmarks.
+ */
+struct ZerocoinBenchData
+{
+    const libzerocoin::Params* params;
+    int coinVersion;
+    std::vector<libzerocoin::PrivateCoin> coins;
+    libzerocoin::Accumulator accumulator;
+    libzerocoin::AccumulatorWitness witness;
+    libzerocoin::SpendMetaData metaData;
+    CDataStream serializedSpend;
+
+    explicit ZerocoinBenchData(bool fModulusV2) :
+        params(fModulusV2 ? ZCParamsV2() : ZCParams()),
+        coinVersion(fModulusV2 ? ZEROCOIN_TX_VERSION_2 : ZEROCOIN_TX_VERSION_1),
+        coins(CreateCoins(params, coinVersion)),
+        accumulator(params, libzerocoin::ZQ_LOVELACE),
+        witness(params, accumulator, coins[0].getPublicCoin()),
+        metaData(0, uint256()),
+        serializedSpend(SER_NETWORK, PROTOCOL_VERSION)
+    {
+        for (size_t i = 1; i < coins.size(); i++) {
+            accumulator += coins[i].getPublicCoin();
+            witness += coins[i].getPublicCoin();
+        }
+        accumulator += coins[0].getPublicCoin();
+
+        libzerocoin::CoinSpend spend(params, coins[0], accumulator, witness, metaData);
+        spend.setVersion(coinVersion);
+        serializedSpend << spend;
+    }
+
+    static std::vector<libzerocoin::PrivateCoin> CreateCoins(const libzerocoin::Params* params, int coinVersion)
+    {
+        std::vector<libzerocoin::PrivateCoin> coins;
+        for (int i = 0; i < COINS_PER_RUN; i++)
+            coins.push_back(libzerocoin::PrivateCoin(params, libzerocoin::ZQ_LOVELACE, coinVersion));
+        return coins;
+    }
+
+    static const ZerocoinBenchData& Get(bool fModulusV2)
+    {
+        if (fModulusV2) {
+            static ZerocoinBenchData dataV2(true);
+            return dataV2;
+        }
+        static ZerocoinBenchData dataV1(false);
+        return dataV1;
+    }
+};
+
+/** The parts of a serialized CoinSpend, to verify the sub-proofs one by one */
+struct ZerocoinSpendParts
+{
+    int denomination;
+    CBigNum accCommitmentToCoinValue;
+    CBigNum serialCommitmentToCoinValue;
+    CBigNum coinSerialNumber;
+    libzerocoin::AccumulatorProofOfKnowledge accumulatorPoK;
+    libzerocoin::SerialNumberSignatureOfKnowledge serialNumberSoK;
+    libzerocoin::CommitmentProofOfKnowledge commitmentPoK;
+
+    explicit ZerocoinSpendParts(const ZerocoinBenchData& data) :
+        accumulatorPoK(&data.params->accumulatorParams),
+        serialNumberSoK(data.params),
+        commitmentPoK(&data.params->serialNumberSoKCommitmentGroup, &data.params->accumulatorParams.accumulatorPoKCommitmentGroup)
+    {
+        CDataStream ss(data.serializedSpend);
+        ss >> denomination >> accCommitmentToCoinValue >> serialCommitmentToCoinValue >> coinSerialNumber;
+        ss >> accumulatorPoK >> serialNumberSoK >> commitmentPoK;
+    }
+};
+
+static void ZerocoinMint(benchmark::State& state, bool fModulusV2)
+{
+    const libzerocoin::Params* params = fModulusV2 ? ZCParamsV2() : ZCParams();
+    int coinVersion = fModulusV2 ? ZEROCOIN_TX_VERSION_2 : ZEROCOIN_TX_VERSION_1;
+    while (state.KeepRunning()) {
+        libzerocoin::PrivateCoin coin(params, libzerocoin::ZQ_LOVELACE, coinVersion);
+    }
+}
+
+static void ZerocoinCreateSpend(benchmark::State& state, bool fModulusV2)
+{
+    const ZerocoinBenchData& data = ZerocoinBenchData::Get(fModulusV2);
+    libzerocoin::Accumulator accumulator(data.accumulator);
+    while (state.KeepRunning()) {
+        libzerocoin::CoinSpend spend(data.params, data.coins[0], accumulator, data.witness, data.metaData);
+    }
+}
+
+static void ZerocoinVerifySpend(benchmark::State& state, bool fModulusV2)
+{
+    const ZerocoinBenchData& data = ZerocoinBenchData::Get(fModulusV2);
+    CDataStream ss(data.serializedSpend);
+    libzerocoin::CoinSpend spend(data.params, ss);
+    while (state.KeepRunning()) {
+        assert(spend.Verify(data.accumulator, data.metaData));
+    }
+}
+
+static void ZerocoinVerifyCommitmentPoK(benchmark::State& state, bool fModulusV2)
+{
+    ZerocoinSpendParts parts(ZerocoinBenchData::Get(fModulusV2));
+    while (state.KeepRunning()) {
+        assert(parts.commitmentPoK.Verify(parts.serialCommitmentToCoinValue, parts.accCommitmentToCoinValue));
+    }
+}
+
+static void ZerocoinVerifyAccumulatorPoK(benchmark::State& state, bool fModulusV2)
+{
+    const ZerocoinBenchData& data = ZerocoinBenchData::Get(fModulusV2);
+    ZerocoinSpendParts parts(data);
+    while (state.KeepRunning()) {
+        assert(parts.accumulatorPoK.Verify(data.accumulator, parts.accCommitmentToCoinValue));
+    }
+}
+
+static void ZerocoinVerifySerialNumberSoK(benchmark::State& state, bool fModulusV2)
+{
+    ZerocoinSpendParts parts(ZerocoinBenchData::Get(fModulusV2));
+    while (state.KeepRunning()) {
+        // only version 1.5 spends bind the metadata to this proof, version 2 spends sign it with ECDSA
+        assert(parts.serialNumberSoK.Verify(parts.coinSerialNumber, parts.serialCommitmentToCoinValue, uint256()));
+    }
+}
+
+static void ZerocoinAccumulateCoins(benchmark::State& state, bool fModulusV2)
+{
+    const ZerocoinBenchData& data = ZerocoinBenchData::Get(fModulusV2);
+    while (state.KeepRunning()) {
+        libzerocoin::Accumulator accumulator(data.params, libzerocoin::ZQ_LOVELACE);
+        for (size_t i = 0; i < data.coins.size(); i++)
+            accumulator += data.coins[i].getPublicCoin();
+    }
+}
+
+static void ZerocoinWitnessUpdate(benchmark::State& state, bool fModulusV2)
+{
+    const ZerocoinBenchData& data = ZerocoinBenchData::Get(fModulusV2);
+    libzerocoin::AccumulatorWitness witness(data.params, data.accumulator, data.coins[0].getPublicCoin());
+    while (state.KeepRunning()) {
+        witness.AddElement(data.coins[1].getPublicCoin());
+    }
+}
+
+static void Zerocoin_Mint_V1(benchmark::State& state) { ZerocoinMint(state, false); }
+static void Zerocoin_Mint_V2(benchmark::State& state) { ZerocoinMint(state, true); }
+static void Zerocoin_CreateSpend_V1(benchmark::State& state) { ZerocoinCreateSpend(state, false); }
+static void Zerocoin_CreateSpend_V2(benchmark::State& state) { ZerocoinCreateSpend(state, true); }
+static void Zerocoin_VerifySpend_V1(benchmark::State& state) { ZerocoinVerifySpend(state, false); }
+static void Zerocoin_VerifySpend_V2(benchmark::State& state) { ZerocoinVerifySpend(state, true); }
+static void Zerocoin_VerifyCommitmentPoK_V1(benchmark::State& state) { ZerocoinVerifyCommitmentPoK(state, false); }
+static void Zerocoin_VerifyCommitmentPoK_V2(benchmark::State& state) { ZerocoinVerifyCommitmentPoK(state, true); }
+static void Zerocoin_VerifyAccumulatorPoK_V1(benchmark::State& state) { ZerocoinVerifyAccumulatorPoK(state, false); }
+static void Zerocoin_VerifyAccumulatorPoK_V2(benchmark::State& state) { ZerocoinVerifyAccumulatorPoK(state, true); }
+static void Zerocoin_VerifySerialNumberSoK_V1(benchmark::State& state) { ZerocoinVerifySerialNumberSoK(state, false); }
+static void Zerocoin_VerifySerialNumberSoK_V2(benchmark::State& state) { ZerocoinVerifySerialNumberSoK(state, true); }
+static void Zerocoin_Accumulate_V1(benchmark::State& state) { ZerocoinAccumulateCoins(state, false); }
+static void Zerocoin_Accumulate_V2(benchmark::State& state) { ZerocoinAccumulateCoins(state, true); }
+static void Zerocoin_WitnessUpdate_V1(benchmark::State& state) { ZerocoinWitnessUpdate(state, false); }
+static void Zerocoin_WitnessUpdate_V2(benchmark::State& state) { ZerocoinWitnessUpdate(state, true); }
+
+static void Zerocoin_StateLookup(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+
+    // all the mints of one block, the group of a block never changes
+    CBlockIndex index;
+    index.nHeight = 1;
+    CZerocoinState zerocoinState;
+    std::vector<CBigNum> serials, pubCoins;
+    for (int i = 0; i < STATE_COINS; i++) {
+        serials.push_back(CBigNum::randBignum(ZCParamsV2()->coinCommitmentGroup.groupOrder));
+        pubCoins.push_back(CBigNum::randBignum(ZCParamsV2()->coinCommitmentGroup.modulus));
+        CBigNum previousAccValue;
+        zerocoinState.AddSpend(serials.back());
+        zerocoinState.AddMint(&index, libzerocoin::ZQ_LOVELACE, pubCoins.back(), previousAccValue);
+    }
+
+    int i = 0;
+    while (state.KeepRunning()) {
+        const CBigNum& serial = serials[i];
+        const CBigNum& pubCoin = pubCoins[i];
+        assert(zerocoinState.IsUsedCoinSerial(serial) && !zerocoinState.CanAddSpendToMempool(serial));
+        assert(zerocoinState.HasCoin(pubCoin));
+        i = (i + 1) % STATE_COINS;
+    }
+}
+
+BENCHMARK(Zerocoin_Mint_V1);
+BENCHMARK(Zerocoin_Mint_V2);
+BENCHMARK(Zerocoin_CreateSpend_V1);
+BENCHMARK(Zerocoin_CreateSpend_V2);
+BENCHMARK(Zerocoin_VerifySpend_V1);
+BENCHMARK(Zerocoin_VerifySpend_V2);
+BENCHMARK(Zerocoin_VerifyCommitmentPoK_V1);
+BENCHMARK(Zerocoin_VerifyCommitmentPoK_V2);
+BENCHMARK(Zerocoin_VerifyAccumulatorPoK_V1);
+BENCHMARK(Zerocoin_VerifyAccumulatorPoK_V2);
+BENCHMARK(Zerocoin_VerifySerialNumberSoK_V1);
+BENCHMARK(Zerocoin_VerifySerialNumberSoK_V2);
+BENCHMARK(Zerocoin_Accumulate_V1);
+BENCHMARK(Zerocoin_Accumulate_V2);
+BENCHMARK(Zerocoin_WitnessUpdate_V1);
+BENCHMARK(Zerocoin_WitnessUpdate_V2);
+BENCHMARK(Zerocoin_StateLookup);
@@ -15,6 +15,8 @@
 
 /** Object for who's going to get paid on which blocks */
 CBznodePayments mnpayments;
+/** Who got paid in the recent blocks */
+CCoinbasePayeeIndex coinbasePayeeIndex;
 
 CCriticalSection cs_vecPayees;
 CCriticalSection cs_mapBznodeBlocks;
@@ -345,6 +347,7 @@ void CBznodePayments::ProcessMessage(CNode *pfrom, std::string &strCommand, CDat
         if (!vote.CheckSignature(mnInfo.pubKeyBznode, pCurrentBlockIndex->nHeight, nDos)) {
             if (nDos) {
                 LogPrintf("BZNODEPAYMENTVOTE -- ERROR: invalid signature\n");
+                LOCK(cs_main);
                 Misbehaving(pfrom->GetId(), nDos);
             } else {
                 // only warn about anything non-critical (i.e. nDos == 0) in debug mode
@@ -904,3 +907,47 @@ void CBznodePayments::UpdatedBlockTip(const CBlockIndex *pindex) {
     
     ProcessBlock(pindex->nHeight + 5);
 }
+
+void CCoinbasePayeeIndex::BlockConnected(const CBlockIndex *pindex, const CTransaction &txCoinbase) {
+    if (fLiteMode) return;
+
+    LOCK(cs);
+    mapCoinbasePayees[pindex->nHeight] = CCoinbasePayees(pindex->GetBlockHash(), txCoinbase);
+    mapCoinbasePayees.erase(mapCoinbasePayees.begin(), mapCoinbasePayees.lower_bound(pindex->nHeight - nBlocksToKeep));
+}
+
+void CCoinbasePayeeIndex::BlockDisconnected(const CBlockIndex *pindex) {
+    LOCK(cs);
+    std::map<int, CCoinbasePayees>::iterator it = mapCoinbasePayees.find(pindex->nHeight);
+    if (it != mapCoinbasePayees.end() && it->second.hashBlock == pindex->GetBlockHash())
+        mapCoinbasePayees.erase(it);
+}
+
+bool CCoinbasePayeeIndex::GetCoinbasePayees(const CBlockIndex *pindex, CCoinbasePayees &payeesRet) {
+    {
+        LOCK(cs);
+        std::map<int, CCoinbasePayees>::const_iterator it = mapCoinbasePayees.find(pindex->nHeight);
+        if (it != mapCoinbasePayees.end() && it->second.hashBlock == pindex->GetBlockHash()) {
+            payeesRet = it->second;
+            return true;
+        }
+    }
+
+    // not connected since the start or replaced by a reorg
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+        LogPrintf("CCoinbasePayeeIndex::GetCoinbasePayees -- ReadBlockFromDisk failed, nHeight=%d\n", pindex->nHeight);
+        return false;
+    }
+    payeesRet = CCoinbasePayees(pindex->GetBlockHash(), block.vtx[0]);
+
+    LOCK(cs);
+    mapCoinbasePayees[pindex->nHeight] = payeesRet;
+    return true;
+}
+
+void CCoinbasePayeeIndex::Prune(int nHeight, int nBlocksToKeepIn) {
+    LOCK(cs);
+    nBlocksToKeep = nBlocksToKeepIn;
+    mapCoinbasePayees.erase(mapCoinbasePayees.begin(), mapCoinbasePayees.lower_bound(nHeight - nBlocksToKeep));
+}
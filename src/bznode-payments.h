@@ -15,6 +15,7 @@
 class CBznodePayments;
 class CBznodePaymentVote;
 class CBznodeBlockPayees;
+class CCoinbasePayeeIndex;
 
 static const int MNPAYMENTS_SIGNATURES_REQUIRED         = 6;
 static const int MNPAYMENTS_SIGNATURES_TOTAL            = 10;
@@ -26,11 +27,15 @@ static const int MNPAYMENTS_SIGNATURES_TOTAL            = 10;
 static const int MIN_BZNODE_PAYMENT_PROTO_VERSION_1 = 99023;
 static const int MIN_BZNODE_PAYMENT_PROTO_VERSION_2 = 99024;
 
+//! minimum number of blocks to keep payment votes and coinbase payees for
+static const int MNPAYMENTS_MIN_BLOCKS_TO_STORE = 5000;
+
 extern CCriticalSection cs_vecPayees;
 extern CCriticalSection cs_mapBznodeBlocks;
 extern CCriticalSection cs_mapBznodePayeeVotes;
 
 extern CBznodePayments mnpayments;
+extern CCoinbasePayeeIndex coinbasePayeeIndex;
 
 /// TODO: all 4 functions do not belong here really, they should be refactored/moved somewhere (main.cpp ?)
 bool IsBlockValueValid(const CBlock& block, int nBlockHeight, CAmount blockReward, std::string &strErrorRet);
@@ -181,7 +186,7 @@ public:
     std::map<int, CBznodeBlockPayees> mapBznodeBlocks;
     std::map<COutPoint, int> mapBznodesLastVote;
 
-    CBznodePayments() : nStorageCoeff(1.25), nMinBlocksToStore(5000) {}
+    CBznodePayments() : nStorageCoeff(1.25), nMinBlocksToStore(MNPAYMENTS_MIN_BLOCKS_TO_STORE) {}
 
     ADD_SERIALIZE_METHODS;
 
@@ -222,4 +227,42 @@ public:
     void UpdatedBlockTip(const CBlockIndex *pindex);
 };
 
+/** The outputs of the coinbase of one block */
+class CCoinbasePayees
+{
+public:
+    uint256 hashBlock;
+    CAmount nValueOut;
+    std::vector<CTxOut> vout;
+
+    CCoinbasePayees() : nValueOut(0) {}
+    CCoinbasePayees(const uint256& hashBlockIn, const CTransaction& txCoinbase) :
+        hashBlock(hashBlockIn), nValueOut(txCoinbase.GetValueOut()), vout(txCoinbase.vout) {}
+};
+
+/**
+ * Coinbase outputs of the recent blocks by height, kept up to date by
+ * ConnectBlock() and DisconnectBlock(), so that the last payments of the
+ * bznodes can be found without reading the blocks again.
+ */
+class CCoinbasePayeeIndex
+{
+private:
+    mutable CCriticalSection cs;
+    std::map<int, CCoinbasePayees> mapCoinbasePayees;
+    int nBlocksToKeep;
+
+public:
+    CCoinbasePayeeIndex() : nBlocksToKeep(MNPAYMENTS_MIN_BLOCKS_TO_STORE) {}
+
+    void BlockConnected(const CBlockIndex* pindex, const CTransaction& txCoinbase);
+    void BlockDisconnected(const CBlockIndex* pindex);
+
+    /** Coinbase outputs of the block pindex, read from disk and indexed if they aren't yet */
+    bool GetCoinbasePayees(const CBlockIndex* pindex, CCoinbasePayees& payeesRet);
+
+    /** Forgets the blocks more than nBlocksToKeepIn below nHeight, now and as new blocks are connected */
+    void Prune(int nHeight, int nBlocksToKeepIn);
+};
+
 #endif
@@ -111,6 +111,9 @@ bool CBznode::UpdateFromNewBroadcast(CBznodeBroadcast &mnb) {
     pubKeyBznode = mnb.pubKeyBznode;
     sigTime = mnb.sigTime;
     vchSig = mnb.vchSig;
+    if (nProtocolVersion != mnb.nProtocolVersion) {
+        mnodeman.NotifyBznodeStateChanged();
+    }
     nProtocolVersion = mnb.nProtocolVersion;
     addr = mnb.addr;
     nPoSeBanScore = 0;
@@ -143,11 +146,13 @@ bool CBznode::UpdateFromNewBroadcast(CBznodeBroadcast &mnb) {
 // and get paid this block
 //
 arith_uint256 CBznode::CalculateScore(const uint256 &blockHash) {
-    uint256 aux = ArithToUint256(UintToArith256(vin.prevout.hash) + vin.prevout.n);
-
     CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
     ss << blockHash;
-    arith_uint256 hash2 = UintToArith256(ss.GetHash());
+    return CalculateScore(blockHash, UintToArith256(ss.GetHash()));
+}
+
+arith_uint256 CBznode::CalculateScore(const uint256 &blockHash, const arith_uint256 &hash2) {
+    uint256 aux = ArithToUint256(UintToArith256(vin.prevout.hash) + vin.prevout.n);
 
     CHashWriter ss2(SER_GETHASH, PROTOCOL_VERSION);
     ss2 << blockHash;
@@ -160,6 +165,38 @@ arith_uint256 CBznode::CalculateScore(const uint256 &blockHash) {
 void CBznode::Check(bool fForce) {
     LOCK(cs);
 
+    int nActiveStateOld = nActiveState;
+    UpdateActiveState(fForce);
+    // rank tables filter on the state, make sure they get rebuilt
+    if (nActiveState != nActiveStateOld) {
+        mnodeman.NotifyBznodeStateChanged();
+    }
+}
+
+int64_t CBznode::GetNextCheckTime(int64_t nNow) {
+    LOCK(cs);
+
+    int64_t nNextCheck = nNow + BZNODE_RECHECK_SECONDS;
+    if (lastPing == CBznodePing()) return nNextCheck;
+
+    // see UpdateActiveState(), a state only changes once the ping is this old
+    const int64_t vecDeadlines[] = {
+        lastPing.sigTime + BZNODE_MIN_MNP_SECONDS,
+        lastPing.sigTime + BZNODE_EXPIRATION_SECONDS,
+        lastPing.sigTime + BZNODE_NEW_START_REQUIRED_SECONDS,
+        nTimeLastWatchdogVote + BZNODE_WATCHDOG_MAX_SECONDS + 1,
+    };
+    for (size_t i = 0; i < sizeof(vecDeadlines) / sizeof(vecDeadlines[0]); i++) {
+        if (vecDeadlines[i] > nNow && vecDeadlines[i] < nNextCheck) {
+            nNextCheck = vecDeadlines[i];
+        }
+    }
+    return nNextCheck;
+}
+
+void CBznode::UpdateActiveState(bool fForce) {
+    AssertLockHeld(cs);
+
     if (ShutdownRequested()) return;
 
     if (!fForce && (GetTime() - nTimeLastChecked < BZNODE_CHECK_SECONDS)) return;
@@ -395,55 +432,6 @@ int CBznode::GetCollateralAge() {
     return nHeight - nCacheCollateralBlock;
 }
 
-void CBznode::UpdateLastPaid(const CBlockIndex *pindex, int nMaxBlocksToScanBack) {
-    if (!pindex) {
-        LogPrintf("CBznode::UpdateLastPaid pindex is NULL\n");
-        return;
-    }
-
-    const CBlockIndex *BlockReading = pindex;
-
-    CScript mnpayee = GetScriptForDestination(pubKeyCollateralAddress.GetID());
-    LogPrint("bznode", "CBznode::UpdateLastPaidBlock -- searching for block with payment to %s\n", vin.prevout.ToStringShort());
-
-    LOCK(cs_mapBznodeBlocks);
-
-    for (int i = 0; BlockReading && BlockReading->nHeight > nBlockLastPaid && i < nMaxBlocksToScanBack; i++) {
-//        LogPrintf("mnpayments.mapBznodeBlocks.count(BlockReading->nHeight)=%s\n", mnpayments.mapBznodeBlocks.count(BlockReading->nHeight));
-//        LogPrintf("mnpayments.mapBznodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2)=%s\n", mnpayments.mapBznodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2));
-        if (mnpayments.mapBznodeBlocks.count(BlockReading->nHeight) &&
-            mnpayments.mapBznodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2)) {
-            // LogPrintf("i=%s, BlockReading->nHeight=%s\n", i, BlockReading->nHeight);
-            CBlock block;
-            if (!ReadBlockFromDisk(block, BlockReading, Params().GetConsensus())) // shouldn't really happen
-            {
-                LogPrintf("ReadBlockFromDisk failed\n");
-                continue;
-            }
-
-            CAmount nBznodePayment = GetBznodePayment(BlockReading->nHeight, block.vtx[0].GetValueOut());
-
-            BOOST_FOREACH(CTxOut txout, block.vtx[0].vout)
-            if (mnpayee == txout.scriptPubKey && nBznodePayment == txout.nValue) {
-                nBlockLastPaid = BlockReading->nHeight;
-                nTimeLastPaid = BlockReading->nTime;
-                LogPrint("bznode", "CBznode::UpdateLastPaidBlock -- searching for block with payment to %s -- found new %d\n", vin.prevout.ToStringShort(), nBlockLastPaid);
-                return;
-            }
-        }
-
-        if (BlockReading->pprev == NULL) {
-            assert(BlockReading);
-            break;
-        }
-        BlockReading = BlockReading->pprev;
-    }
-
-    // Last payment for this bznode wasn't found in latest mnpayments blocks
-    // or it was found in mnpayments blocks but wasn't found in the blockchain.
-    // LogPrint("bznode", "CBznode::UpdateLastPaidBlock -- searching for block with payment to %s -- keeping old %d\n", vin.prevout.ToStringShort(), nBlockLastPaid);
-}
-
 bool CBznodeBroadcast::Create(std::string strService, std::string strKeyBznode, std::string strTxHash, std::string strOutputIndex, std::string &strErrorRet, CBznodeBroadcast &mnbRet, bool fOffline) {
     LogPrintf("CBznodeBroadcast::Create\n");
     CTxIn txin;
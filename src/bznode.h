@@ -17,6 +17,8 @@ class CBznodeBroadcast;
 class CBznodePing;
 
 static const int BZNODE_CHECK_SECONDS               =   5;
+// recheck a bznode at least this often, its payment protocol or PoSe ban may have changed
+static const int BZNODE_RECHECK_SECONDS             =  60;
 static const int BZNODE_MIN_MNB_SECONDS             =   5 * 60; //BROADCAST_TIME
 static const int BZNODE_MIN_MNP_SECONDS             =  10 * 60; //PRE_ENABLE_TIME
 static const int BZNODE_EXPIRATION_SECONDS          =  65 * 60;
@@ -144,6 +146,8 @@ private:
     // critical section to protect the inner data structures
     mutable CCriticalSection cs;
 
+    void UpdateActiveState(bool fForce);
+
 public:
     enum state {
         BZNODE_PRE_ENABLED,
@@ -242,10 +246,15 @@ public:
 
     // CALCULATE A RANK AGAINST OF GIVEN BLOCK
     arith_uint256 CalculateScore(const uint256& blockHash);
+    /// Same as above with Hash(blockHash) precomputed, it is shared by every bznode
+    arith_uint256 CalculateScore(const uint256& blockHash, const arith_uint256& hashBlockHash);
 
     bool UpdateFromNewBroadcast(CBznodeBroadcast& mnb);
 
     void Check(bool fForce = false);
+    /// Earliest time after nNow (adjusted time) at which the age of the last ping
+    /// can change the state, capped by BZNODE_RECHECK_SECONDS
+    int64_t GetNextCheckTime(int64_t nNow);
 
     bool IsBroadcastedWithin(int nSeconds) { return GetAdjustedTime() - sigTime < nSeconds; }
 
@@ -297,7 +306,6 @@ public:
 
     int GetLastPaidTime() { return nTimeLastPaid; }
     int GetLastPaidBlock() { return nBlockLastPaid; }
-    void UpdateLastPaid(const CBlockIndex *pindex, int nMaxBlocksToScanBack);
 
     // KEEP TRACK OF EACH GOVERNANCE ITEM INCASE THIS NODE GOES OFFLINE, SO WE CAN RECALC THEIR STATUS
     void AddGovernanceVote(uint256 nGovernanceObjectHash);
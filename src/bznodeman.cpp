@@ -12,6 +12,10 @@
 #include "netfulfilledman.h"
 #include "util.h"
 
+#include <algorithm>
+
+#include <boost/thread.hpp>
+
 /** Bznode manager */
 CBznodeMan mnodeman;
 
@@ -98,6 +102,9 @@ void CBznodeIndex::RebuildIndex()
 
 CBznodeMan::CBznodeMan() : cs(),
   vBznodes(),
+  mapOutPointPos(),
+  mapPubKeyPos(),
+  mapPayeePos(),
   mAskedUsForBznodeList(),
   mWeAskedForBznodeList(),
   mWeAskedForBznodeListEntry(),
@@ -113,6 +120,9 @@ CBznodeMan::CBznodeMan() : cs(),
   fBznodesRemoved(false),
 //  vecDirtyGovernanceObjectHashes(),
   nLastWatchdogVoteTime(0),
+  mapRankCache(),
+  nRankCacheUses(0),
+  nBznodeStateVersion(0),
   mapSeenBznodeBroadcast(),
   mapSeenBznodePing(),
   nDsqCount(0)
@@ -126,6 +136,9 @@ bool CBznodeMan::Add(CBznode &mn)
     if (pmn == NULL) {
         LogPrint("bznode", "CBznodeMan::Add -- Adding new Bznode: addr=%s, %i now\n", mn.addr.ToString(), size() + 1);
         vBznodes.push_back(mn);
+        AddToLookupMaps(vBznodes.size() - 1);
+        ClearRankCache();
+        ScheduleCheck(mn.vin.prevout, 0);
         indexBznodes.AddBznodeVIN(mn.vin);
         fBznodesAdded = true;
         return true;
@@ -174,6 +187,92 @@ void CBznodeMan::Check()
     }
 }
 
+void CBznodeMan::CheckDue()
+{
+    {
+        LOCK(cs);
+        if (setCheckQueue.empty() || setCheckQueue.begin()->first > GetAdjustedTime()) return;
+    }
+
+    // CBznode::Check() skips the UTXO lookup when it can't get cs_main,
+    // take it first so that a due check is never lost
+    LOCK2(cs_main, cs);
+
+    int64_t nNow = GetAdjustedTime();
+    int nChecked = 0;
+    while (nChecked < MAX_CHECK_DUE_BATCH && !setCheckQueue.empty() && setCheckQueue.begin()->first <= nNow) {
+        COutPoint outpoint = setCheckQueue.begin()->second;
+        setCheckQueue.erase(setCheckQueue.begin());
+        mapNextCheck.erase(outpoint);
+
+        // removed since it was queued
+        CBznode* pmn = Find(CTxIn(outpoint));
+        if (pmn == NULL) continue;
+
+        pmn->Check(true);
+        nChecked++;
+        // once spent, stop doing the checks, CheckAndRemove() will drop it
+        if (!pmn->IsOutpointSpent()) {
+            ScheduleCheck(outpoint, pmn->GetNextCheckTime(nNow));
+        }
+    }
+
+    LogPrint("bznode", "CBznodeMan::CheckDue -- checked %d of %d bznodes, %d queued\n", nChecked, (int)vBznodes.size(), (int)setCheckQueue.size());
+}
+
+void CBznodeMan::ScheduleCheck(const COutPoint& outpoint, int64_t nTime)
+{
+    AssertLockHeld(cs);
+
+    boost::unordered_map<COutPoint, int64_t, BznodeOutPointHasher>::iterator it = mapNextCheck.find(outpoint);
+    if (it != mapNextCheck.end()) {
+        setCheckQueue.erase(std::make_pair(it->second, outpoint));
+        it->second = nTime;
+    } else {
+        mapNextCheck.insert(std::make_pair(outpoint, nTime));
+    }
+    setCheckQueue.insert(std::make_pair(nTime, outpoint));
+}
+
+void CBznodeMan::CheckSpentCollaterals(const CBlock& block)
+{
+    LOCK(cs);
+
+    BOOST_FOREACH(const CTransaction& tx, block.vtx) {
+        BOOST_FOREACH(const CTxIn& txin, tx.vin) {
+            if (mapOutPointPos.count(txin.prevout)) {
+                ScheduleCheck(txin.prevout, 0);
+            }
+        }
+    }
+}
+
+void CBznodeMan::ScheduleCheckAll()
+{
+    AssertLockHeld(cs);
+
+    setCheckQueue.clear();
+    mapNextCheck.clear();
+    BOOST_FOREACH(const CBznode& mn, vBznodes) {
+        ScheduleCheck(mn.vin.prevout, 0);
+    }
+}
+
+static bool IsBznodeSpent(CBznode& mn)
+{
+    return mn.IsOutpointSpent();
+}
+
+void CBznodeMan::EraseSpentBznodes()
+{
+    AssertLockHeld(cs);
+
+    // one pass and one rebuild of the lookup maps, however many bznodes go
+    vBznodes.erase(std::remove_if(vBznodes.begin(), vBznodes.end(), IsBznodeSpent), vBznodes.end());
+    RebuildLookupMaps();
+    ClearRankCache();
+}
+
 void CBznodeMan::CheckAndRemove()
 {
     if(!bznodeSync.IsBznodeListSynced()) return;
@@ -185,13 +284,13 @@ void CBznodeMan::CheckAndRemove()
         // in CheckMnbAndUpdateBznodeList()
         LOCK2(cs_main, cs);
 
-        Check();
-
+        // The states are kept up to date by CheckDue(), no need to check them here.
         // Remove spent bznodes, prepare structures and make requests to reasure the state of inactive ones
         std::vector<CBznode>::iterator it = vBznodes.begin();
         std::vector<std::pair<int, CBznode> > vecBznodeRanks;
         // ask for up to MNB_RECOVERY_MAX_ASK_ENTRIES bznode entries at a time
         int nAskForMnbRecovery = MNB_RECOVERY_MAX_ASK_ENTRIES;
+        bool fRemoved = false;
         while(it != vBznodes.end()) {
             CBznodeBroadcast mnb = CBznodeBroadcast(*it);
             uint256 hash = mnb.GetHash();
@@ -203,10 +302,10 @@ void CBznodeMan::CheckAndRemove()
                 mapSeenBznodeBroadcast.erase(hash);
                 mWeAskedForBznodeListEntry.erase((*it).vin.prevout);
 
-                // and finally remove it from the list
+                // and finally remove it from the list, see below
 //                it->FlagGovernanceItemsAsDirty();
-                it = vBznodes.erase(it);
-                fBznodesRemoved = true;
+                fRemoved = true;
+                ++it;
             } else {
                 bool fAsk = pCurrentBlockIndex &&
                             (nAskForMnbRecovery > 0) &&
@@ -243,6 +342,11 @@ void CBznodeMan::CheckAndRemove()
             }
         }
 
+        if (fRemoved) {
+            EraseSpentBznodes();
+            fBznodesRemoved = true;
+        }
+
         // proces replies for BZNODE_NEW_START_REQUIRED bznodes
         LogPrint("bznode", "CBznodeMan::CheckAndRemove -- mMnbRecoveryGoodReplies size=%d\n", (int)mMnbRecoveryGoodReplies.size());
         std::map<uint256, std::vector<CBznodeBroadcast> >::iterator itMnbReplies = mMnbRecoveryGoodReplies.begin();
@@ -362,10 +466,49 @@ void CBznodeMan::CheckAndRemove()
     }
 }
 
+void CBznodeMan::RemoveSpent()
+{
+    {
+        LOCK2(cs_main, cs);
+
+        bool fRemoved = false;
+        BOOST_FOREACH(CBznode& mn, vBznodes) {
+            mn.Check(true);
+            if (mn.IsOutpointSpent()) {
+                LogPrint("bznode", "CBznodeMan::RemoveSpent -- Removing Bznode: addr=%s\n", mn.addr.ToString());
+                mapSeenBznodeBroadcast.erase(CBznodeBroadcast(mn).GetHash());
+                mWeAskedForBznodeListEntry.erase(mn.vin.prevout);
+                fRemoved = true;
+            }
+        }
+
+        if (fRemoved) {
+            EraseSpentBznodes();
+            fBznodesRemoved = true;
+        }
+
+        LogPrintf("CBznodeMan::RemoveSpent -- %s\n", ToString());
+
+        if(fBznodesRemoved) {
+            CheckAndRebuildBznodeIndex();
+        }
+    }
+
+    if(fBznodesRemoved) {
+        NotifyBznodeUpdates();
+    }
+}
+
 void CBznodeMan::Clear()
 {
     LOCK(cs);
     vBznodes.clear();
+    mapOutPointPos.clear();
+    mapPubKeyPos.clear();
+    mapPayeePos.clear();
+    ClearRankCache();
+    setCheckQueue.clear();
+    mapNextCheck.clear();
     mAskedUsForBznodeList.clear();
     mWeAskedForBznodeList.clear();
     mWeAskedForBznodeListEntry.clear();
@@ -443,40 +586,57 @@ void CBznodeMan::DsegUpdate(CNode* pnode)
     LogPrint("bznode", "CBznodeMan::DsegUpdate -- asked %s for the list\n", pnode->addr.ToString());
 }
 
+void CBznodeMan::AddToLookupMaps(size_t nPos)
+{
+    AssertLockHeld(cs);
+
+    const CBznode& mn = vBznodes[nPos];
+    // insert() keeps an existing entry, which always has the lower position
+    mapOutPointPos.insert(std::make_pair(mn.vin.prevout, nPos));
+    mapPubKeyPos.insert(std::make_pair(mn.pubKeyBznode, nPos));
+    mapPayeePos.insert(std::make_pair(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()), nPos));
+}
+
+void CBznodeMan::RebuildLookupMaps()
+{
+    AssertLockHeld(cs);
+
+    mapOutPointPos.clear();
+    mapPubKeyPos.clear();
+    mapPayeePos.clear();
+    for(size_t i = 0; i < vBznodes.size(); i++) {
+        AddToLookupMaps(i);
+    }
+}
+
 CBznode* CBznodeMan::Find(const CScript &payee)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CBznode& mn, vBznodes)
-    {
-        if(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()) == payee)
-            return &mn;
-    }
-    return NULL;
+    boost::unordered_map<CScript, size_t, BznodeScriptHasher>::const_iterator it = mapPayeePos.find(payee);
+    if(it == mapPayeePos.end())
+        return NULL;
+    return &vBznodes[it->second];
 }
 
 CBznode* CBznodeMan::Find(const CTxIn &vin)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CBznode& mn, vBznodes)
-    {
-        if(mn.vin.prevout == vin.prevout)
-            return &mn;
-    }
-    return NULL;
+    boost::unordered_map<COutPoint, size_t, BznodeOutPointHasher>::const_iterator it = mapOutPointPos.find(vin.prevout);
+    if(it == mapOutPointPos.end())
+        return NULL;
+    return &vBznodes[it->second];
 }
 
 CBznode* CBznodeMan::Find(const CPubKey &pubKeyBznode)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CBznode& mn, vBznodes)
-    {
-        if(mn.pubKeyBznode == pubKeyBznode)
-            return &mn;
-    }
-    return NULL;
+    boost::unordered_map<CPubKey, size_t, BznodePubKeyHasher>::const_iterator it = mapPubKeyPos.find(pubKeyBznode);
+    if(it == mapPubKeyPos.end())
+        return NULL;
+    return &vBznodes[it->second];
 }
 
 bool CBznodeMan::Get(const CPubKey& pubKeyBznode, CBznode& bznode)
@@ -727,44 +887,100 @@ CBznode* CBznodeMan::FindRandomNotInVec(const std::vector<CTxIn> &vecToExclude,
     return NULL;
 }
 
-int CBznodeMan::GetBznodeRank(const CTxIn& vin, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
+const CBznodeMan::rank_table_t& CBznodeMan::GetRankTable(const uint256& blockHash, int nMinProtocol, rank_filter_t filter)
 {
-    std::vector<std::pair<int64_t, CBznode*> > vecBznodeScores;
+    AssertLockHeld(cs);
+
+    std::map<uint256, rank_cache_entry_t>::iterator it = mapRankCache.find(blockHash);
+    if(it == mapRankCache.end()) {
+        if((int)mapRankCache.size() >= MAX_RANK_CACHE_BLOCKS) {
+            // drop the least recently used block
+            std::map<uint256, rank_cache_entry_t>::iterator itOldest = mapRankCache.begin();
+            for(std::map<uint256, rank_cache_entry_t>::iterator it2 = mapRankCache.begin(); it2 != mapRankCache.end(); ++it2) {
+                if(it2->second.nLastUsed < itOldest->second.nLastUsed) itOldest = it2;
+            }
+            mapRankCache.erase(itOldest);
+        }
+        it = mapRankCache.insert(std::make_pair(blockHash, rank_cache_entry_t())).first;
+
+        // the first half of CalculateScore is the same for every bznode
+        CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << blockHash;
+        arith_uint256 hashBlockHash = UintToArith256(ss.GetHash());
+
+        std::vector<std::pair<int64_t, CBznode*> > vecBznodeScores;
+        vecBznodeScores.reserve(vBznodes.size());
+        BOOST_FOREACH(CBznode& mn, vBznodes) {
+            int64_t nScore = mn.CalculateScore(blockHash, hashBlockHash).GetCompact(false);
+            vecBznodeScores.push_back(std::make_pair(nScore, &mn));
+        }
+
+        // CompareScoreMN is a total order, so filtering the sorted list later gives
+        // exactly the order we would get by filtering first
+        sort(vecBznodeScores.rbegin(), vecBznodeScores.rend(), CompareScoreMN());
+
+        it->second.vecByScore.reserve(vecBznodeScores.size());
+        BOOST_FOREACH (PAIRTYPE(int64_t, CBznode*)& s, vecBznodeScores) {
+            it->second.vecByScore.push_back(s.second);
+        }
+    }
 
+    rank_cache_entry_t& entry = it->second;
+    entry.nLastUsed = ++nRankCacheUses;
+
+    rank_table_t& table = entry.mapTables[std::make_pair(nMinProtocol, (int)filter)];
+    int nStateVersion = nBznodeStateVersion;
+    if(table.nStateVersion != nStateVersion) {
+        table.vecRanked.clear();
+        table.mapRanks.clear();
+        BOOST_FOREACH(CBznode* pmn, entry.vecByScore) {
+            if(pmn->nProtocolVersion < nMinProtocol) continue;
+            if(filter == RANK_ENABLED && !pmn->IsEnabled()) continue;
+            if(filter == RANK_VALID_FOR_PAYMENT && !pmn->IsValidForPayment()) continue;
+            table.vecRanked.push_back(pmn);
+            table.mapRanks[pmn->vin.prevout] = table.vecRanked.size();
+        }
+        table.nStateVersion = nStateVersion;
+    }
+
+    return table;
+}
+
+int CBznodeMan::GetBznodeRank(const CTxIn& vin, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
+{
     //make sure we know about this block
     uint256 blockHash = uint256();
     if(!GetBlockHash(blockHash, nBlockHeight)) return -1;
 
     LOCK(cs);
 
-    // scan for winner
-    BOOST_FOREACH(CBznode& mn, vBznodes) {
-        if(mn.nProtocolVersion < nMinProtocol) continue;
-        if(fOnlyActive) {
-            if(!mn.IsEnabled()) continue;
-        }
-        else {
-            if(!mn.IsValidForPayment()) continue;
-        }
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
+    const rank_table_t& table = GetRankTable(blockHash, nMinProtocol, fOnlyActive ? RANK_ENABLED : RANK_VALID_FOR_PAYMENT);
+    std::map<COutPoint, int>::const_iterator it = table.mapRanks.find(vin.prevout);
+    if(it == table.mapRanks.end()) return -1;
 
-        vecBznodeScores.push_back(std::make_pair(nScore, &mn));
-    }
+    return it->second;
+}
+
+std::vector<COutPoint> CBznodeMan::GetTopRankedOutpoints(int nBlockHeight, int nCount, int nMinProtocol)
+{
+    std::vector<COutPoint> vecOutpoints;
 
-    sort(vecBznodeScores.rbegin(), vecBznodeScores.rend(), CompareScoreMN());
+    //make sure we know about this block
+    uint256 blockHash = uint256();
+    if(!GetBlockHash(blockHash, nBlockHeight)) return vecOutpoints;
 
-    int nRank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CBznode*)& scorePair, vecBznodeScores) {
-        nRank++;
-        if(scorePair.second->vin.prevout == vin.prevout) return nRank;
+    LOCK(cs);
+
+    const rank_table_t& table = GetRankTable(blockHash, nMinProtocol, RANK_ENABLED);
+    for(unsigned int i = 0; i < table.vecRanked.size() && (int)i < nCount; i++) {
+        vecOutpoints.push_back(table.vecRanked[i]->vin.prevout);
     }
 
-    return -1;
+    return vecOutpoints;
 }
 
 std::vector<std::pair<int, CBznode> > CBznodeMan::GetBznodeRanks(int nBlockHeight, int nMinProtocol)
 {
-    std::vector<std::pair<int64_t, CBznode*> > vecBznodeScores;
     std::vector<std::pair<int, CBznode> > vecBznodeRanks;
 
     //make sure we know about this block
@@ -773,22 +989,10 @@ std::vector<std::pair<int, CBznode> > CBznodeMan::GetBznodeRanks(int nBlockHeigh
 
     LOCK(cs);
 
-    // scan for winner
-    BOOST_FOREACH(CBznode& mn, vBznodes) {
-
-        if(mn.nProtocolVersion < nMinProtocol || !mn.IsEnabled()) continue;
-
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
-
-        vecBznodeScores.push_back(std::make_pair(nScore, &mn));
-    }
-
-    sort(vecBznodeScores.rbegin(), vecBznodeScores.rend(), CompareScoreMN());
-
-    int nRank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CBznode*)& s, vecBznodeScores) {
-        nRank++;
-        vecBznodeRanks.push_back(std::make_pair(nRank, *s.second));
+    const rank_table_t& table = GetRankTable(blockHash, nMinProtocol, RANK_ENABLED);
+    vecBznodeRanks.reserve(table.vecRanked.size());
+    for(unsigned int i = 0; i < table.vecRanked.size(); i++) {
+        vecBznodeRanks.push_back(std::make_pair(i + 1, *table.vecRanked[i]));
     }
 
     return vecBznodeRanks;
@@ -796,8 +1000,6 @@ std::vector<std::pair<int, CBznode> > CBznodeMan::GetBznodeRanks(int nBlockHeigh
 
 CBznode* CBznodeMan::GetBznodeByRank(int nRank, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
 {
-    std::vector<std::pair<int64_t, CBznode*> > vecBznodeScores;
-
     LOCK(cs);
 
     uint256 blockHash;
@@ -806,28 +1008,10 @@ CBznode* CBznodeMan::GetBznodeByRank(int nRank, int nBlockHeight, int nMinProtoc
         return NULL;
     }
 
-    // Fill scores
-    BOOST_FOREACH(CBznode& mn, vBznodes) {
-
-        if(mn.nProtocolVersion < nMinProtocol) continue;
-        if(fOnlyActive && !mn.IsEnabled()) continue;
-
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
+    const rank_table_t& table = GetRankTable(blockHash, nMinProtocol, fOnlyActive ? RANK_ENABLED : RANK_ALL);
+    if(nRank < 1 || nRank > (int)table.vecRanked.size()) return NULL;
 
-        vecBznodeScores.push_back(std::make_pair(nScore, &mn));
-    }
-
-    sort(vecBznodeScores.rbegin(), vecBznodeScores.rend(), CompareScoreMN());
-
-    int rank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CBznode*)& s, vecBznodeScores){
-        rank++;
-        if(rank == nRank) {
-            return s.second;
-        }
-    }
-
-    return NULL;
+    return table.vecRanked[nRank - 1];
 }
 
 void CBznodeMan::ProcessBznodeConnections()
@@ -888,12 +1072,16 @@ void CBznodeMan::ProcessMessage(CNode* pfrom, std::string& strCommand, CDataStre
 
         LogPrintf("MNANNOUNCE -- Bznode announce, bznode=%s\n", mnb.vin.prevout.ToStringShort());
 
+        if (bznodeSync.GetAssetID() == BZNODE_SYNC_LIST && QueueMnbForVerification(pfrom, mnb))
+            return;
+
         int nDos = 0;
 
         if (CheckMnbAndUpdateBznodeList(pfrom, mnb, nDos)) {
             // use announced Bznode as a peer
             addrman.Add(CAddress(mnb.addr, NODE_NETWORK), pfrom->addr, 2*60*60);
         } else if(nDos > 0) {
+            LOCK(cs_main);
             Misbehaving(pfrom->GetId(), nDos);
         }
 
@@ -1468,10 +1656,14 @@ void CBznodeMan::UpdateBznodeList(CBznodeBroadcast mnb)
             }
         } else {
             CBznodeBroadcast mnbOld = mapSeenBznodeBroadcast[CBznodeBroadcast(*pmn).GetHash()].second;
+            CPubKey pubKeyBznodeOld = pmn->pubKeyBznode;
             if (pmn->UpdateFromNewBroadcast(mnb)) {
                 bznodeSync.AddedBznodeList();
                 mapSeenBznodeBroadcast.erase(mnbOld.GetHash());
             }
+            if (pmn->pubKeyBznode != pubKeyBznodeOld) {
+                RebuildLookupMaps();
+            }
         }
     } catch (const std::exception &e) {
         PrintExceptionContinue(&e, "UpdateBznodeList");
@@ -1533,7 +1725,12 @@ bool CBznodeMan::CheckMnbAndUpdateBznodeList(CNode* pfrom, CBznodeBroadcast mnb,
         CBznode *pmn = Find(mnb.vin);
         if (pmn) {
             CBznodeBroadcast mnbOld = mapSeenBznodeBroadcast[CBznodeBroadcast(*pmn).GetHash()].second;
-            if (!mnb.Update(pmn, nDos)) {
+            CPubKey pubKeyBznodeOld = pmn->pubKeyBznode;
+            bool fUpdated = mnb.Update(pmn, nDos);
+            if (pmn->pubKeyBznode != pubKeyBznodeOld) {
+                RebuildLookupMaps();
+            }
+            if (!fUpdated) {
                 LogPrint("bznode", "CBznodeMan::CheckMnbAndUpdateBznodeList -- Update() failed, bznode=%s\n", mnb.vin.prevout.ToStringShort());
                 return false;
             }
@@ -1587,8 +1784,48 @@ void CBznodeMan::UpdateLastPaid()
     LogPrint("mnpayments", "CBznodeMan::UpdateLastPaid -- nHeight=%d, nMaxBlocksToScanBack=%d, IsFirstRun=%s\n",
                              pCurrentBlockIndex->nHeight, nMaxBlocksToScanBack, IsFirstRun ? "true" : "false");
 
+    coinbasePayeeIndex.Prune(pCurrentBlockIndex->nHeight, mnpayments.GetStorageLimit());
+
+    // Walk back the blocks once for all bznodes, newest first, the first payment
+    // found for a bznode is its last one. Several bznodes can share a payee.
+    std::multimap<CScript, CBznode*> mapPayeeBznodes;
+    int nLastPaidMin = std::numeric_limits<int>::max();
     BOOST_FOREACH(CBznode& mn, vBznodes) {
-        mn.UpdateLastPaid(pCurrentBlockIndex, nMaxBlocksToScanBack);
+        mapPayeeBznodes.insert(std::make_pair(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()), &mn));
+        nLastPaidMin = std::min(nLastPaidMin, mn.nBlockLastPaid);
+    }
+
+    {
+        LOCK(cs_mapBznodeBlocks);
+
+        std::set<CBznode*> setPaidFound;
+        const CBlockIndex* pindex = pCurrentBlockIndex;
+        for (int i = 0; pindex && pindex->nHeight > nLastPaidMin && i < nMaxBlocksToScanBack && setPaidFound.size() < vBznodes.size(); i++, pindex = pindex->pprev) {
+            std::map<int, CBznodeBlockPayees>::iterator itBlock = mnpayments.mapBznodeBlocks.find(pindex->nHeight);
+            if (itBlock == mnpayments.mapBznodeBlocks.end())
+                continue;
+
+            CCoinbasePayees coinbasePayees;
+            if (!coinbasePayeeIndex.GetCoinbasePayees(pindex, coinbasePayees))
+                continue;
+
+            CAmount nBznodePayment = GetBznodePayment(pindex->nHeight, coinbasePayees.nValueOut);
+            BOOST_FOREACH(const CTxOut& txout, coinbasePayees.vout) {
+                if (txout.nValue != nBznodePayment)
+                    continue;
+                std::pair<std::multimap<CScript, CBznode*>::iterator, std::multimap<CScript, CBznode*>::iterator> range = mapPayeeBznodes.equal_range(txout.scriptPubKey);
+                if (range.first == range.second || !itBlock->second.HasPayeeWithVotes(txout.scriptPubKey, 2))
+                    continue;
+                for (std::multimap<CScript, CBznode*>::iterator it = range.first; it != range.second; ++it) {
+                    CBznode* pmn = it->second;
+                    if (pmn->nBlockLastPaid >= pindex->nHeight || !setPaidFound.insert(pmn).second)
+                        continue;
+                    pmn->nBlockLastPaid = pindex->nHeight;
+                    pmn->nTimeLastPaid = pindex->nTime;
+                    LogPrint("bznode", "CBznodeMan::UpdateLastPaid -- searching for block with payment to %s -- found new %d\n", pmn->vin.prevout.ToStringShort(), pmn->nBlockLastPaid);
+                }
+            }
+        }
     }
 
     // every time is like the first time if winners list is not synced
@@ -1742,3 +1979,102 @@ void CBznodeMan::NotifyBznodeUpdates()
     fBznodesAdded = false;
     fBznodesRemoved = false;
 }
+
+/** A broadcast received during the list sync and the peer that sent it */
+struct CPendingMnb
+{
+    NodeId nodeId;
+    CAddress addrFrom;
+    CBznodeBroadcast mnb;
+};
+
+static boost::mutex mutexMnbQueue;
+static boost::condition_variable condMnbQueue;
+static std::deque<CPendingMnb> queueMnbPending;
+static std::vector<CPendingMnb> vecMnbVerified;
+// set while a verify thread adds a batch to the list, the others keep verifying
+static bool fMnbApplying = false;
+static int nMnbVerifyThreads = 0;
+
+bool QueueMnbForVerification(CNode* pfrom, const CBznodeBroadcast& mnb)
+{
+    if (nMnbVerifyThreads == 0)
+        return false;
+    // replies to recovery requests are checked against the asking connection
+    if (mnodeman.IsMnbRecoveryRequested(mnb.GetHash()))
+        return false;
+
+    CPendingMnb pending;
+    pending.nodeId = pfrom->GetId();
+    pending.addrFrom = pfrom->addr;
+    pending.mnb = mnb;
+    {
+        boost::unique_lock<boost::mutex> lock(mutexMnbQueue);
+        if (queueMnbPending.size() >= MAX_MNB_VERIFY_QUEUE)
+            return false;
+        queueMnbPending.push_back(pending);
+    }
+    condMnbQueue.notify_one();
+    return true;
+}
+
+static void ApplyVerifiedMnbs(std::vector<CPendingMnb>& vecBatch)
+{
+    {
+        // the UTXO and collateral checks need cs_main, take it once for the whole batch
+        LOCK(cs_main);
+        BOOST_FOREACH(CPendingMnb& pending, vecBatch) {
+            int nDos = 0;
+            if (mnodeman.CheckMnbAndUpdateBznodeList(NULL, pending.mnb, nDos)) {
+                addrman.Add(CAddress(pending.mnb.addr, NODE_NETWORK), pending.addrFrom, 2*60*60);
+            } else if (nDos > 0) {
+                Misbehaving(pending.nodeId, nDos);
+            }
+        }
+    }
+    LogPrint("bznode", "ApplyVerifiedMnbs -- added %d broadcasts\n", vecBatch.size());
+    mnodeman.NotifyBznodeUpdates();
+}
+
+static void ThreadMnbVerify()
+{
+    while (true) {
+        CPendingMnb pending;
+        {
+            boost::unique_lock<boost::mutex> lock(mutexMnbQueue);
+            while (queueMnbPending.empty())
+                condMnbQueue.wait(lock);
+            pending = queueMnbPending.front();
+            queueMnbPending.pop_front();
+        }
+
+        // valid signatures end up in the message signature cache, so checking
+        // them again in CheckMnbAndUpdateBznodeList() costs a lookup
+        int nDos = 0;
+        if (pending.mnb.CheckSignature(nDos) && pending.mnb.lastPing != CBznodePing())
+            pending.mnb.lastPing.CheckSignature(pending.mnb.pubKeyBznode, nDos);
+
+        boost::unique_lock<boost::mutex> lock(mutexMnbQueue);
+        vecMnbVerified.push_back(pending);
+        if (fMnbApplying)
+            continue;
+        fMnbApplying = true;
+        while (!vecMnbVerified.empty() && (vecMnbVerified.size() >= MNB_VERIFY_BATCH_SIZE || queueMnbPending.empty())) {
+            std::vector<CPendingMnb> vecBatch;
+            vecBatch.swap(vecMnbVerified);
+            lock.unlock();
+            ApplyVerifiedMnbs(vecBatch);
+            lock.lock();
+        }
+        fMnbApplying = false;
+    }
+}
+
+void StartMnbVerifyThreads(boost::thread_group& threadGroup)
+{
+    if (fLiteMode)
+        return;
+    nMnbVerifyThreads = std::max(1, std::min(GetNumCores(), MAX_MNB_VERIFY_THREADS));
+    for (int i = 0; i < nMnbVerifyThreads; i++)
+        threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "mnbverify", &ThreadMnbVerify));
+}
@@ -8,8 +8,18 @@
 #include "bznode.h"
 #include "sync.h"
 
+#include <atomic>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
 using namespace std;
 
+namespace boost {
+    class thread_group;
+} // namespace boost
+
+class CBlock;
 class CBznodeMan;
 
 extern CBznodeMan mnodeman;
@@ -78,6 +88,21 @@ private:
 
 };
 
+struct BznodeOutPointHasher
+{
+    size_t operator()(const COutPoint& outpoint) const { return outpoint.hash.GetCheapHash() ^ outpoint.n; }
+};
+
+struct BznodePubKeyHasher
+{
+    size_t operator()(const CPubKey& pubKey) const { return boost::hash_range(pubKey.begin(), pubKey.end()); }
+};
+
+struct BznodeScriptHasher
+{
+    size_t operator()(const CScript& script) const { return boost::hash_range(script.begin(), script.end()); }
+};
+
 class CBznodeMan
 {
 public:
@@ -110,6 +135,39 @@ private:
     static const int MNB_RECOVERY_WAIT_SECONDS      = 60;
     static const int MNB_RECOVERY_RETRY_SECONDS     = 3 * 60 * 60;
 
+    static const int MAX_RANK_CACHE_BLOCKS      = 16;
+
+    /// Bznodes checked per CheckDue() run, the rest stay queued for the next one
+    static const int MAX_CHECK_DUE_BATCH        = 100;
+
+    /// Which bznodes take part in a ranking
+    enum rank_filter_t {
+        RANK_ENABLED,
+        RANK_VALID_FOR_PAYMENT,
+        RANK_ALL
+    };
+
+    /// Bznodes ranked for one block, best first: rank N is vecRanked[N-1]
+    struct rank_table_t {
+        int nStateVersion;
+        std::vector<CBznode*> vecRanked;
+        std::map<COutPoint, int> mapRanks;
+
+        rank_table_t() : nStateVersion(-1) {}
+    };
+
+    /// All bznodes ordered by score for one block plus the rank tables filtered from it,
+    /// keyed by (nMinProtocol, rank_filter_t). Scores only depend on the block hash and the
+    /// collateral so the order stays valid until the list changes, the tables are rebuilt
+    /// from it whenever a bznode changes state.
+    struct rank_cache_entry_t {
+        int64_t nLastUsed;
+        std::vector<CBznode*> vecByScore;
+        std::map<std::pair<int, int>, rank_table_t> mapTables;
+
+        rank_cache_entry_t() : nLastUsed(0) {}
+    };
+
 
     // critical section to protect the inner data structures
     mutable CCriticalSection cs;
@@ -119,6 +177,14 @@ private:
 
     // map to hold all MNs
     std::vector<CBznode> vBznodes;
+    // positions in vBznodes by collateral outpoint, pubKeyBznode and payee script, when
+    // several bznodes share a key the first one in vBznodes is kept (like a linear scan would)
+    boost::unordered_map<COutPoint, size_t, BznodeOutPointHasher> mapOutPointPos;
+    boost::unordered_map<CPubKey, size_t, BznodePubKeyHasher> mapPubKeyPos;
+    boost::unordered_map<CScript, size_t, BznodeScriptHasher> mapPayeePos;
+    // bznodes by the time they are due for a check (adjusted time), see CheckDue()
+    std::set<std::pair<int64_t, COutPoint> > setCheckQueue;
+    boost::unordered_map<COutPoint, int64_t, BznodeOutPointHasher> mapNextCheck;
     // who's asked for the Bznode list and the last time
     std::map<CNetAddr, int64_t> mAskedUsForBznodeList;
     // who we asked for the Bznode list and the last time
@@ -152,6 +218,29 @@ private:
 
     int64_t nLastWatchdogVoteTime;
 
+    /// Rank tables by block hash. Holds pointers into vBznodes, so it must be
+    /// cleared whenever an entry is added to or removed from the vector.
+    std::map<uint256, rank_cache_entry_t> mapRankCache;
+    int64_t nRankCacheUses;
+
+    /// Bumped whenever the list changes or a bznode changes state or protocol version
+    std::atomic<int> nBznodeStateVersion;
+
+    const rank_table_t& GetRankTable(const uint256& blockHash, int nMinProtocol, rank_filter_t filter);
+    void ClearRankCache() { mapRankCache.clear(); nBznodeStateVersion++; }
+
+    /// Add vBznodes[nPos] to the lookup maps
+    void AddToLookupMaps(size_t nPos);
+    /// Rebuild the lookup maps, needed when vBznodes shifts or a pubKeyBznode changes
+    void RebuildLookupMaps();
+    /// Remove the bznodes whose collateral is spent from vBznodes
+    void EraseSpentBznodes();
+
+    /// (Re)queue the check of a bznode at nTime, replacing its queued check if any
+    void ScheduleCheck(const COutPoint& outpoint, int64_t nTime);
+    /// Queue an immediate check of every bznode
+    void ScheduleCheckAll();
+
     friend class CBznodeSync;
 
 public:
@@ -191,6 +280,11 @@ public:
         READWRITE(mapSeenBznodeBroadcast);
         READWRITE(mapSeenBznodePing);
         READWRITE(indexBznodes);
+        if(ser_action.ForRead()) {
+            ClearRankCache();
+            RebuildLookupMaps();
+            ScheduleCheckAll();
+        }
         if(ser_action.ForRead() && (strVersion != SERIALIZATION_VERSION_STRING)) {
             Clear();
         }
@@ -207,10 +301,19 @@ public:
 
     /// Check all Bznodes
     void Check();
+    /// Check the Bznodes whose queued check is due, i.e. those that may have
+    /// changed state since they were last checked
+    void CheckDue();
 
-    /// Check all Bznodes and remove inactive
+    /// Queue an immediate check of the Bznodes whose collateral the block spends
+    void CheckSpentCollaterals(const CBlock& block);
+
+    /// Remove the Bznodes found spent by their checks, recover inactive ones
     void CheckAndRemove();
 
+    /// Remove Bznodes whose collateral is spent, e.g. after loading mncache.dat
+    void RemoveSpent();
+
     /// Clear Bznode vector
     void Clear();
 
@@ -298,6 +401,12 @@ public:
 
     std::vector<std::pair<int, CBznode> > GetBznodeRanks(int nBlockHeight = -1, int nMinProtocol=0);
     int GetBznodeRank(const CTxIn &vin, int nBlockHeight, int nMinProtocol=0, bool fOnlyActive=true);
+    /// Invalidate cached rank tables, called by CBznode when its state changes
+    void NotifyBznodeStateChanged() { nBznodeStateVersion++; }
+    /// Changes whenever the ranks may have changed, to check snapshots taken with GetTopRankedOutpoints()
+    int GetStateVersion() const { return nBznodeStateVersion; }
+    /// Outpoints of the nCount best ranked enabled bznodes at nBlockHeight, best first
+    std::vector<COutPoint> GetTopRankedOutpoints(int nBlockHeight, int nCount, int nMinProtocol=0);
     CBznode* GetBznodeByRank(int nRank, int nBlockHeight, int nMinProtocol=0, bool fOnlyActive=true);
 
     void ProcessBznodeConnections();
@@ -321,7 +430,7 @@ public:
     void UpdateBznodeList(CBznodeBroadcast mnb);
     /// Perform complete check and only then update list and maps
     bool CheckMnbAndUpdateBznodeList(CNode* pfrom, CBznodeBroadcast mnb, int& nDos);
-    bool IsMnbRecoveryRequested(const uint256& hash) { return mMnbRecoveryRequests.count(hash); }
+    bool IsMnbRecoveryRequested(const uint256& hash) { LOCK(cs); return mMnbRecoveryRequests.count(hash); }
 
     void UpdateLastPaid();
 
@@ -365,4 +474,19 @@ public:
 
 };
 
+/// Max number of threads verifying the broadcasts received during the list sync
+static const int MAX_MNB_VERIFY_THREADS = 8;
+/// Number of verified broadcasts added to the list under one cs_main lock
+static const unsigned int MNB_VERIFY_BATCH_SIZE = 64;
+/// Broadcasts waiting for verification, further ones are processed on the message thread
+static const unsigned int MAX_MNB_VERIFY_QUEUE = 20000;
+
+/**
+ * Queues a broadcast received during the list sync. Its signatures are verified
+ * on a verify thread and it is then added to the list with the other broadcasts
+ * of its batch. Returns false if it has to be processed right away.
+ */
+bool QueueMnbForVerification(CNode* pfrom, const CBznodeBroadcast& mnb);
+void StartMnbVerifyThreads(boost::thread_group& threadGroup);
+
 #endif
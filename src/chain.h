@@ -148,6 +148,44 @@ enum BlockStatus: uint32_t {
     BLOCK_FAILED_MASK        =   96,
 
     BLOCK_OPT_WITNESS       =   128, //!< block data in blk*.data was received with a witness-enforcing client
+
+    BLOCK_HAVE_POWHASH      =   256, //!< (memory only) hashPoW holds the verified proof-of-work hash of the header,
+                                     //!< stored under its own key in the block tree db
+
+    BLOCK_HAVE_ZCDATA_COUNTS =  512, //!< entry has zerocoin mint and spend counts, the data itself is stored apart
+};
+
+/**
+ * Zerocoin mints and spends of a block. Stored in the block tree db under the block hash, apart from the
+ * block index entry which only keeps their counts, and read on demand.
+ */
+class CZerocoinBlockData
+{
+public:
+    //! Public coin values of mints in this block, ordered by serialized value of public coin
+    //! Maps <denomination,id> to vector of public coins
+    map<pair<int,int>, vector<CBigNum>> mintedPubCoins;
+
+    //! Accumulator updates. Contains only changes made by mints in this block
+    //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
+    map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
+
+    //! Values of coin serials spent in this block
+    set<CBigNum> spentSerials;
+
+    bool IsNull() const
+    {
+        return mintedPubCoins.empty() && accumulatorChanges.empty() && spentSerials.empty();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(mintedPubCoins);
+        READWRITE(accumulatorChanges);
+        READWRITE(spentSerials);
+    }
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -204,19 +242,18 @@ public:
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     uint32_t nSequenceId;
 
-    //! Public coin values of mints in this block, ordered by serialized value of public coin
-    //! Maps <denomination,id> to vector of public coins
-    map<pair<int,int>, vector<CBigNum>> mintedPubCoins;
+    //! Lyra2Z hash of the header, checked against nBits. Only set if nStatus & BLOCK_HAVE_POWHASH
+    uint256 hashPoW;
 
-    //! Accumulator updates. Contains only changes made by mints in this block
-    //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
-    map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
+    //! Number of zerocoin mints in this block for every <denomination, id>. The mints, the accumulator values
+    //! and the spent serials are in CZerocoinBlockData
+    map<pair<int,int>, int> zerocoinMintCounts;
 
-    //! Same as accumulatorChanges but for alternative modulus
-    map<pair<int,int>, pair<CBigNum,int>> alternativeAccumulatorChanges;
+    //! Number of zerocoin serials spent in this block
+    int nZerocoinSpends;
 
-    //! Values of coin serials spent in this block
-	set<CBigNum> spentSerials;
+    //! (memory only) Same as CZerocoinBlockData::accumulatorChanges but for alternative modulus
+    map<pair<int,int>, pair<CBigNum,int>> alternativeAccumulatorChanges;
 
     void SetNull()
     {
@@ -238,10 +275,11 @@ public:
         nTime          = 0;
         nBits          = 0;
         nNonce         = 0;
+        hashPoW        = uint256();
 
-        mintedPubCoins.clear();
-        accumulatorChanges.clear();
-        spentSerials.clear();
+        zerocoinMintCounts.clear();
+        nZerocoinSpends = 0;
+        alternativeAccumulatorChanges.clear();
     }
 
     CBlockIndex()
@@ -249,6 +287,11 @@ public:
         SetNull();
     }
 
+    bool HasZerocoinData() const
+    {
+        return !zerocoinMintCounts.empty() || nZerocoinSpends > 0;
+    }
+
     CBlockIndex(const CBlockHeader& block)
     {
         SetNull();
@@ -298,6 +341,8 @@ public:
 
     uint256 GetBlockPoWHash() const
     {
+        if (nStatus & BLOCK_HAVE_POWHASH)
+            return hashPoW;
         return GetBlockHeader().GetPoWHash(nHeight);
     }
 
@@ -372,6 +417,9 @@ public:
     uint256 hashPrev;
     int nDiskBlockVersion;
 
+    //! Zerocoin data found inline in entries written before BLOCK_HAVE_ZCDATA_COUNTS, always empty when writing
+    CZerocoinBlockData zerocoinData;
+
     CDiskBlockIndex() {
         hashPrev = uint256();
         // value doesn't really matter but we won't leave it uninitialized
@@ -381,6 +429,9 @@ public:
     explicit CDiskBlockIndex(const CBlockIndex* pindex) : CBlockIndex(*pindex) {
         hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
         nDiskBlockVersion = 0;
+        // an older client would keep the bit when rewriting the entry, hashPoW is written apart
+        nStatus &= ~BLOCK_HAVE_POWHASH;
+        nStatus |= BLOCK_HAVE_ZCDATA_COUNTS;
     }
 
     ADD_SERIALIZE_METHODS;
@@ -408,11 +459,13 @@ public:
         READWRITE(nBits);
         READWRITE(nNonce);
 
-        if (!(nType & SER_GETHASH) && nVersion >= ZC_ADVANCED_INDEX_VERSION) {
-            READWRITE(mintedPubCoins);
-		    READWRITE(accumulatorChanges);
-            READWRITE(spentSerials);
-	    }
+        if (!(nType & SER_GETHASH) && nVersion >= ZC_ADVANCED_INDEX_VERSION)
+            READWRITE(zerocoinData);
+
+        if (!(nType & SER_GETHASH) && (nStatus & BLOCK_HAVE_ZCDATA_COUNTS)) {
+            READWRITE(zerocoinMintCounts);
+            READWRITE(VARINT(nZerocoinSpends));
+        }
 
         nDiskBlockVersion = nVersion;
     }
@@ -284,6 +284,21 @@ public:
     }
 };
 
+class SaltedOutpointHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    SaltedOutpointHasher();
+
+    /** See SaltedTxidHasher, this must return size_t too */
+    size_t operator()(const COutPoint& outpoint) const {
+        return CSipHasher(k0, k1).Write(outpoint.hash.begin(), 32).Write(outpoint.n).Finalize();
+    }
+};
+
 struct CCoinsCacheEntry
 {
     CCoins coins; // The actual cached data.
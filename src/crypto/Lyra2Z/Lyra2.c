@@ -24,6 +24,59 @@
 #include "Lyra2.h"
 #include "Sponge.h"
 
+/**
+ * Allocates the memory matrix of a Lyra2 context so it can be reused by any number of
+ * LYRA2_hash calls with the same dimensions.
+ *
+ * @param ctx The context to be initialized
+ * @param nRows Number or rows of the memory matrix (R)
+ * @param nCols Number of columns of the memory matrix (C)
+ *
+ * @return 0 if the matrix is allocated correctly; -1 if there is not enough memory
+ */
+int LYRA2_init(lyra2_ctx *ctx, uint64_t nRows, uint64_t nCols) {
+    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
+    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
+    int64_t i;
+
+    ctx->nRows = nRows;
+    ctx->nCols = nCols;
+
+    //Tries to allocate enough space for the whole memory matrix
+    i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
+    ctx->wholeMatrix = malloc(i);
+    if (ctx->wholeMatrix == NULL) {
+      return -1;
+    }
+    memset(ctx->wholeMatrix, 0, i);
+
+    //Allocates pointers to each row of the matrix
+    ctx->memMatrix = malloc(nRows * sizeof (uint64_t*));
+    if (ctx->memMatrix == NULL) {
+      free(ctx->wholeMatrix);
+      ctx->wholeMatrix = NULL;
+      return -1;
+    }
+    //Places the pointers in the correct positions
+    uint64_t *ptrWord = ctx->wholeMatrix;
+    for (i = 0; i < nRows; i++) {
+      ctx->memMatrix[i] = ptrWord;
+      ptrWord += ROW_LEN_INT64;
+    }
+
+    return 0;
+}
+
+/**
+ * Releases the memory matrix of a context initialized by LYRA2_init.
+ */
+void LYRA2_free(lyra2_ctx *ctx) {
+    free(ctx->memMatrix);
+    free(ctx->wholeMatrix);
+    ctx->memMatrix = NULL;
+    ctx->wholeMatrix = NULL;
+}
+
 /**
  * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
  * whose combined length is smaller than the size of the memory matrix, (i.e., (nRows x nCols x b) bits,
@@ -44,6 +97,29 @@
  * @return 0 if the key is generated correctly; -1 if there is an error (usually due to lack of memory for allocation)
  */
 int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
+    lyra2_ctx ctx;
+    int ret;
+
+    if (LYRA2_init(&ctx, nRows, nCols) != 0) {
+      return -1;
+    }
+    ret = LYRA2_hash(&ctx, K, kLen, pwd, pwdlen, salt, saltlen, timeCost);
+    LYRA2_free(&ctx);
+
+    return ret;
+}
+
+/**
+ * Executes Lyra2 exactly like LYRA2, but on the preallocated memory matrix of ctx instead of
+ * allocating a fresh one. The matrix does not need to be cleared between calls: every row is
+ * fully overwritten during the Setup phase before it is ever read, and the sponge state is
+ * re-initialized on each call.
+ *
+ * @param ctx Context initialized by LYRA2_init, which also provides nRows and nCols
+ *
+ * @return 0 if the key is generated correctly
+ */
+int LYRA2_hash(lyra2_ctx *ctx, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost) {
 
     //============================= Basic variables ============================//
     int64_t row = 2; //index of row to be processed
@@ -54,33 +130,11 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     int64_t window = 2; //Visitation window (used to define which rows can be revisited during Setup)
     int64_t gap = 1; //Modifier to the step, assuming the values 1 or -1
     int64_t i; //auxiliary iteration counter
-    //==========================================================================/
-
-    //========== Initializing the Memory Matrix and pointers to it =============//
-    //Tries to allocate enough space for the whole memory matrix
-
-
-    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
-    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
-
-    i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
-    uint64_t *wholeMatrix = malloc(i);
-    if (wholeMatrix == NULL) {
-      return -1;
-    }
-    memset(wholeMatrix, 0, i);
-
-    //Allocates pointers to each row of the matrix
-    uint64_t **memMatrix = malloc(nRows * sizeof (uint64_t*));
-    if (memMatrix == NULL) {
-      return -1;
-    }
-    //Places the pointers in the correct positions
-    uint64_t *ptrWord = wholeMatrix;
-    for (i = 0; i < nRows; i++) {
-      memMatrix[i] = ptrWord;
-      ptrWord += ROW_LEN_INT64;
-    }
+    uint64_t nRows = ctx->nRows;
+    uint64_t nCols = ctx->nCols;
+    uint64_t *wholeMatrix = ctx->wholeMatrix;
+    uint64_t **memMatrix = ctx->memMatrix;
+    uint64_t *ptrWord;
     //==========================================================================/
 
     //============= Getting the password + salt + basil padded with 10*1 ===============//
@@ -123,10 +177,7 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
 
     //======================= Initializing the Sponge State ====================//
     //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
-    uint64_t *state = malloc(16 * sizeof (uint64_t));
-    if (state == NULL) {
-      return -1;
-    }
+    uint64_t state[16];
     initState(state);
     //==========================================================================/
 
@@ -200,14 +251,8 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     squeeze(state, K, kLen);
     //==========================================================================/
 
-    //========================= Freeing the memory =============================//
-    free(memMatrix);
-    free(wholeMatrix);
-
-    //Wiping out the sponge's internal state before freeing it
+    //Wiping out the sponge's internal state
     memset(state, 0, 16 * sizeof (uint64_t));
-    free(state);
-    //==========================================================================/
 
     return 0;
 }
@@ -41,6 +41,21 @@ typedef unsigned char byte;
 extern "C" {
 #endif
 
+    /**
+     * Memory matrix that can be allocated once and reused by consecutive LYRA2_hash calls,
+     * avoiding a malloc/free of the whole matrix on every hash.
+     */
+    typedef struct lyra2_ctx {
+        uint64_t *wholeMatrix;
+        uint64_t **memMatrix;
+        uint64_t nRows;
+        uint64_t nCols;
+    } lyra2_ctx;
+
+    int LYRA2_init(lyra2_ctx *ctx, uint64_t nRows, uint64_t nCols);
+    void LYRA2_free(lyra2_ctx *ctx);
+    int LYRA2_hash(lyra2_ctx *ctx, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost);
+
     int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols);
 
 #ifdef __cplusplus
@@ -50,3 +50,18 @@ void lyra2z_hash(const char* input, char* output)
 	memcpy(output, hashB, 32);
 }
 
+/* Same as lyra2z_hash, but reuses the 8x8 memory matrix of ctx (see LYRA2_init) */
+void lyra2z_hash_ctx(lyra2_ctx *ctx, const char* input, char* output)
+{
+    sph_blake256_context     ctx_blake;
+
+    uint32_t hashA[8], hashB[8];
+
+    sph_blake256_init(&ctx_blake);
+    sph_blake256 (&ctx_blake, input, 80);
+    sph_blake256_close (&ctx_blake, hashA);
+
+    LYRA2_hash(ctx, hashB, 32, hashA, 32, hashA, 32, 8);
+
+    memcpy(output, hashB, 32);
+}
@@ -1,11 +1,14 @@
 #ifndef LYRA2RE_H
 #define LYRA2RE_H
 
+#include "Lyra2.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void lyra2z_hash(const char* input, char* output);
+void lyra2z_hash_ctx(lyra2_ctx *ctx, const char* input, char* output);
 
 #ifdef __cplusplus
 }
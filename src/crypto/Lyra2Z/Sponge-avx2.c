@@ -0,0 +1,253 @@
+/**
+ * AVX2 implementation of the Blake2b-based sponge used by Lyra2.
+ * Must produce exactly the same output as the scalar functions in Sponge.c.
+ *
+ * This software is hereby placed in the public domain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ''AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_SIMD)
+#include <immintrin.h>
+
+#define AVX2_FN __attribute__ ((target("avx2")))
+
+/*
+ * The state is kept as 4 registers of four words each, one per row of the
+ * Blake2b matrix: s[0] = v[0..3], s[1] = v[4..7], s[2] = v[8..11], s[3] = v[12..15].
+ * A 12-word block of the memory matrix is 3 registers.
+ */
+#define LOAD_STATE_AVX2(s, state) \
+  do { \
+    int k_; \
+    for (k_ = 0; k_ < 4; k_++) \
+      s[k_] = _mm256_loadu_si256((const __m256i*) &(state)[4 * k_]); \
+  } while(0)
+
+#define STORE_STATE_AVX2(state, s) \
+  do { \
+    int k_; \
+    for (k_ = 0; k_ < 4; k_++) \
+      _mm256_storeu_si256((__m256i*) &(state)[4 * k_], s[k_]); \
+  } while(0)
+
+#define ROTR32_AVX2(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2,3,0,1))
+#define ROTR24_AVX2(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8( \
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, \
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10))
+#define ROTR16_AVX2(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8( \
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, \
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9))
+#define ROTR63_AVX2(x) _mm256_or_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+/*Blake2b's G function, applied to four columns (or diagonals) at once*/
+#define G_AVX2(a,b,c,d) \
+  do { \
+    a = _mm256_add_epi64(a, b); \
+    d = ROTR32_AVX2(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi64(c, d); \
+    b = ROTR24_AVX2(_mm256_xor_si256(b, c)); \
+    a = _mm256_add_epi64(a, b); \
+    d = ROTR16_AVX2(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi64(c, d); \
+    b = ROTR63_AVX2(_mm256_xor_si256(b, c)); \
+  } while(0)
+
+/*One Round of the Blake2b's compression function*/
+AVX2_FN static inline void roundLyra_avx2(__m256i *s) {
+    G_AVX2(s[0], s[1], s[2], s[3]);
+
+    //Diagonalizes: (v0,v5,v10,v15) (v1,v6,v11,v12) (v2,v7,v8,v13) (v3,v4,v9,v14)
+    s[1] = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(0,3,2,1));
+    s[2] = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(1,0,3,2));
+    s[3] = _mm256_permute4x64_epi64(s[3], _MM_SHUFFLE(2,1,0,3));
+
+    G_AVX2(s[0], s[1], s[2], s[3]);
+
+    //Undiagonalizes
+    s[1] = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(2,1,0,3));
+    s[2] = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(1,0,3,2));
+    s[3] = _mm256_permute4x64_epi64(s[3], _MM_SHUFFLE(0,3,2,1));
+}
+
+AVX2_FN static inline void blake2bLyra_avx2(__m256i *s) {
+    int i;
+    for (i = 0; i < 12; i++)
+        roundLyra_avx2(s);
+}
+
+/*rotW: rotates the 12-word block s[0..2] by one word, so that r[j] = s[j-1 mod 12]*/
+AVX2_FN static inline void rotW_avx2(const __m256i *s, __m256i *r) {
+    __m256i p0 = _mm256_permute4x64_epi64(s[0], _MM_SHUFFLE(2,1,0,3));
+    __m256i p1 = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(2,1,0,3));
+    __m256i p2 = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(2,1,0,3));
+    r[0] = _mm256_blend_epi32(p0, p2, 0x03);
+    r[1] = _mm256_blend_epi32(p1, p0, 0x03);
+    r[2] = _mm256_blend_epi32(p2, p1, 0x03);
+}
+
+AVX2_FN void squeeze_avx2(uint64_t *state, unsigned char *out, unsigned int len) {
+    int fullBlocks = len / BLOCK_LEN_BYTES;
+    unsigned char *ptr = out;
+    __m256i s[4];
+    int i;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < fullBlocks; i++) {
+        int k;
+        for (k = 0; k < 3; k++)
+            _mm256_storeu_si256((__m256i*) (ptr + 32 * k), s[k]);
+        blake2bLyra_avx2(s);
+        ptr += BLOCK_LEN_BYTES;
+    }
+    STORE_STATE_AVX2(state, s);
+
+    //Squeezes remaining bytes
+    memcpy(ptr, state, (len % BLOCK_LEN_BYTES));
+}
+
+AVX2_FN void absorbBlock_avx2(uint64_t *state, const uint64_t *in) {
+    __m256i s[4];
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (k = 0; k < 3; k++)
+        s[k] = _mm256_xor_si256(s[k], _mm256_loadu_si256((const __m256i*) &in[4 * k]));
+    blake2bLyra_avx2(s);
+    STORE_STATE_AVX2(state, s);
+}
+
+AVX2_FN void absorbBlockBlake2Safe_avx2(uint64_t *state, const uint64_t *in) {
+    __m256i s[4];
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (k = 0; k < 2; k++)
+        s[k] = _mm256_xor_si256(s[k], _mm256_loadu_si256((const __m256i*) &in[4 * k]));
+    blake2bLyra_avx2(s);
+    STORE_STATE_AVX2(state, s);
+}
+
+AVX2_FN void reducedSqueezeRow0_avx2(uint64_t *state, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to M[0][C-1]
+    __m256i s[4];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 3; k++)
+            _mm256_storeu_si256((__m256i*) &ptrWord[4 * k], s[k]);
+        ptrWord -= BLOCK_LEN_INT64;
+        roundLyra_avx2(s);
+    }
+    STORE_STATE_AVX2(state, s);
+}
+
+AVX2_FN void reducedDuplexRow1_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m256i s[4], in[3];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 3; k++) {
+            in[k] = _mm256_loadu_si256((const __m256i*) &ptrWordIn[4 * k]);
+            s[k] = _mm256_xor_si256(s[k], in[k]);
+        }
+        roundLyra_avx2(s);
+        for (k = 0; k < 3; k++)
+            _mm256_storeu_si256((__m256i*) &ptrWordOut[4 * k], _mm256_xor_si256(in[k], s[k]));
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_AVX2(state, s);
+}
+
+AVX2_FN void reducedDuplexRowSetup_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
+    uint64_t* ptrWordInOut = rowInOut;				//In Lyra2: pointer to row*
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m256i s[4], in[3], inOut[3], rot[3];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 3; k++) {
+            in[k] = _mm256_loadu_si256((const __m256i*) &ptrWordIn[4 * k]);
+            inOut[k] = _mm256_loadu_si256((const __m256i*) &ptrWordInOut[4 * k]);
+            s[k] = _mm256_xor_si256(s[k], _mm256_add_epi64(in[k], inOut[k]));
+        }
+        roundLyra_avx2(s);
+
+        //M[row][col] = M[prev][col] XOR rand
+        for (k = 0; k < 3; k++)
+            _mm256_storeu_si256((__m256i*) &ptrWordOut[4 * k], _mm256_xor_si256(in[k], s[k]));
+
+        //M[row*][col] = M[row*][col] XOR rotW(rand)
+        rotW_avx2(s, rot);
+        for (k = 0; k < 3; k++)
+            _mm256_storeu_si256((__m256i*) &ptrWordInOut[4 * k], _mm256_xor_si256(inOut[k], rot[k]));
+
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_AVX2(state, s);
+}
+
+AVX2_FN void reducedDuplexRow_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordInOut = rowInOut; //In Lyra2: pointer to row*
+    uint64_t* ptrWordIn = rowIn; //In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut; //In Lyra2: pointer to row
+    __m256i s[4], rot[3];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 3; k++) {
+            __m256i in = _mm256_loadu_si256((const __m256i*) &ptrWordIn[4 * k]);
+            __m256i inOut = _mm256_loadu_si256((const __m256i*) &ptrWordInOut[4 * k]);
+            s[k] = _mm256_xor_si256(s[k], _mm256_add_epi64(in, inOut));
+        }
+        roundLyra_avx2(s);
+
+        //M[rowOut][col] = M[rowOut][col] XOR rand
+        for (k = 0; k < 3; k++) {
+            __m256i out = _mm256_loadu_si256((const __m256i*) &ptrWordOut[4 * k]);
+            _mm256_storeu_si256((__m256i*) &ptrWordOut[4 * k], _mm256_xor_si256(out, s[k]));
+        }
+
+        //M[rowInOut][col] = M[rowInOut][col] XOR rotW(rand)
+        //rowInOut is only read back here, as it may be the same row as rowOut
+        rotW_avx2(s, rot);
+        for (k = 0; k < 3; k++) {
+            __m256i inOut = _mm256_loadu_si256((const __m256i*) &ptrWordInOut[4 * k]);
+            _mm256_storeu_si256((__m256i*) &ptrWordInOut[4 * k], _mm256_xor_si256(inOut, rot[k]));
+        }
+
+        ptrWordOut += BLOCK_LEN_INT64;
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+    }
+    STORE_STATE_AVX2(state, s);
+}
+
+#endif /* LYRA2_SIMD */
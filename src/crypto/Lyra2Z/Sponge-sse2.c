@@ -0,0 +1,252 @@
+/**
+ * SSE2 implementation of the Blake2b-based sponge used by Lyra2.
+ * Must produce exactly the same output as the scalar functions in Sponge.c.
+ *
+ * This software is hereby placed in the public domain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ''AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_SIMD)
+#include <emmintrin.h>
+
+#define SSE2_FN __attribute__ ((target("sse2")))
+
+/*
+ * The state is kept as 8 registers of two words each:
+ * s[0..1] = v[0..3], s[2..3] = v[4..7], s[4..5] = v[8..11], s[6..7] = v[12..15]
+ */
+#define LOAD_STATE_SSE2(s, state) \
+  do { \
+    int k_; \
+    for (k_ = 0; k_ < 8; k_++) \
+      s[k_] = _mm_loadu_si128((const __m128i*) &(state)[2 * k_]); \
+  } while(0)
+
+#define STORE_STATE_SSE2(state, s) \
+  do { \
+    int k_; \
+    for (k_ = 0; k_ < 8; k_++) \
+      _mm_storeu_si128((__m128i*) &(state)[2 * k_], s[k_]); \
+  } while(0)
+
+#define ROTR32_SSE2(x) _mm_shuffle_epi32((x), _MM_SHUFFLE(2,3,0,1))
+#define ROTR24_SSE2(x) _mm_or_si128(_mm_srli_epi64((x), 24), _mm_slli_epi64((x), 40))
+#define ROTR16_SSE2(x) _mm_or_si128(_mm_srli_epi64((x), 16), _mm_slli_epi64((x), 48))
+#define ROTR63_SSE2(x) _mm_or_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+/*Blake2b's G function, applied to two columns (or diagonals) at once*/
+#define G_SSE2(a,b,c,d) \
+  do { \
+    a = _mm_add_epi64(a, b); \
+    d = ROTR32_SSE2(_mm_xor_si128(d, a)); \
+    c = _mm_add_epi64(c, d); \
+    b = ROTR24_SSE2(_mm_xor_si128(b, c)); \
+    a = _mm_add_epi64(a, b); \
+    d = ROTR16_SSE2(_mm_xor_si128(d, a)); \
+    c = _mm_add_epi64(c, d); \
+    b = ROTR63_SSE2(_mm_xor_si128(b, c)); \
+  } while(0)
+
+/*One Round of the Blake2b's compression function*/
+SSE2_FN static inline void roundLyra_sse2(__m128i *s) {
+    __m128i t0, t1;
+
+    G_SSE2(s[0], s[2], s[4], s[6]);
+    G_SSE2(s[1], s[3], s[5], s[7]);
+
+    //Diagonalizes: (v0,v5,v10,v15) (v1,v6,v11,v12) (v2,v7,v8,v13) (v3,v4,v9,v14)
+    t0 = s[4]; s[4] = s[5]; s[5] = t0;
+    t0 = s[2]; t1 = s[6];
+    s[2] = _mm_unpackhi_epi64(s[2], _mm_unpacklo_epi64(s[3], s[3]));
+    s[3] = _mm_unpackhi_epi64(s[3], _mm_unpacklo_epi64(t0, t0));
+    s[6] = _mm_unpackhi_epi64(s[7], _mm_unpacklo_epi64(s[6], s[6]));
+    s[7] = _mm_unpackhi_epi64(t1, _mm_unpacklo_epi64(s[7], s[7]));
+
+    G_SSE2(s[0], s[2], s[4], s[6]);
+    G_SSE2(s[1], s[3], s[5], s[7]);
+
+    //Undiagonalizes
+    t0 = s[4]; s[4] = s[5]; s[5] = t0;
+    t0 = s[2]; t1 = s[6];
+    s[2] = _mm_unpackhi_epi64(s[3], _mm_unpacklo_epi64(s[2], s[2]));
+    s[3] = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(s[3], s[3]));
+    s[6] = _mm_unpackhi_epi64(s[6], _mm_unpacklo_epi64(s[7], s[7]));
+    s[7] = _mm_unpackhi_epi64(s[7], _mm_unpacklo_epi64(t1, t1));
+}
+
+SSE2_FN static inline void blake2bLyra_sse2(__m128i *s) {
+    int i;
+    for (i = 0; i < 12; i++)
+        roundLyra_sse2(s);
+}
+
+/*Returns the pair (x[2k-1], x[2k]) of the 12-word block x, i.e. rotW by one word*/
+#define ROTW_SSE2(prev, cur) \
+    _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(prev), _mm_castsi128_pd(cur), 1))
+
+SSE2_FN void squeeze_sse2(uint64_t *state, unsigned char *out, unsigned int len) {
+    int fullBlocks = len / BLOCK_LEN_BYTES;
+    unsigned char *ptr = out;
+    __m128i s[8];
+    int i;
+
+    LOAD_STATE_SSE2(s, state);
+    for (i = 0; i < fullBlocks; i++) {
+        int k;
+        for (k = 0; k < 6; k++)
+            _mm_storeu_si128((__m128i*) (ptr + 16 * k), s[k]);
+        blake2bLyra_sse2(s);
+        ptr += BLOCK_LEN_BYTES;
+    }
+    STORE_STATE_SSE2(state, s);
+
+    //Squeezes remaining bytes
+    memcpy(ptr, state, (len % BLOCK_LEN_BYTES));
+}
+
+SSE2_FN void absorbBlock_sse2(uint64_t *state, const uint64_t *in) {
+    __m128i s[8];
+    int k;
+
+    LOAD_STATE_SSE2(s, state);
+    for (k = 0; k < 6; k++)
+        s[k] = _mm_xor_si128(s[k], _mm_loadu_si128((const __m128i*) &in[2 * k]));
+    blake2bLyra_sse2(s);
+    STORE_STATE_SSE2(state, s);
+}
+
+SSE2_FN void absorbBlockBlake2Safe_sse2(uint64_t *state, const uint64_t *in) {
+    __m128i s[8];
+    int k;
+
+    LOAD_STATE_SSE2(s, state);
+    for (k = 0; k < 4; k++)
+        s[k] = _mm_xor_si128(s[k], _mm_loadu_si128((const __m128i*) &in[2 * k]));
+    blake2bLyra_sse2(s);
+    STORE_STATE_SSE2(state, s);
+}
+
+SSE2_FN void reducedSqueezeRow0_sse2(uint64_t *state, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to M[0][C-1]
+    __m128i s[8];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSE2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 6; k++)
+            _mm_storeu_si128((__m128i*) &ptrWord[2 * k], s[k]);
+        ptrWord -= BLOCK_LEN_INT64;
+        roundLyra_sse2(s);
+    }
+    STORE_STATE_SSE2(state, s);
+}
+
+SSE2_FN void reducedDuplexRow1_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m128i s[8], in[6];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSE2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 6; k++) {
+            in[k] = _mm_loadu_si128((const __m128i*) &ptrWordIn[2 * k]);
+            s[k] = _mm_xor_si128(s[k], in[k]);
+        }
+        roundLyra_sse2(s);
+        for (k = 0; k < 6; k++)
+            _mm_storeu_si128((__m128i*) &ptrWordOut[2 * k], _mm_xor_si128(in[k], s[k]));
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_SSE2(state, s);
+}
+
+SSE2_FN void reducedDuplexRowSetup_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
+    uint64_t* ptrWordInOut = rowInOut;				//In Lyra2: pointer to row*
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m128i s[8], in[6], inOut[6];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSE2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 6; k++) {
+            in[k] = _mm_loadu_si128((const __m128i*) &ptrWordIn[2 * k]);
+            inOut[k] = _mm_loadu_si128((const __m128i*) &ptrWordInOut[2 * k]);
+            s[k] = _mm_xor_si128(s[k], _mm_add_epi64(in[k], inOut[k]));
+        }
+        roundLyra_sse2(s);
+
+        //M[row][col] = M[prev][col] XOR rand
+        for (k = 0; k < 6; k++)
+            _mm_storeu_si128((__m128i*) &ptrWordOut[2 * k], _mm_xor_si128(in[k], s[k]));
+
+        //M[row*][col] = M[row*][col] XOR rotW(rand)
+        _mm_storeu_si128((__m128i*) &ptrWordInOut[0], _mm_xor_si128(inOut[0], ROTW_SSE2(s[5], s[0])));
+        for (k = 1; k < 6; k++)
+            _mm_storeu_si128((__m128i*) &ptrWordInOut[2 * k], _mm_xor_si128(inOut[k], ROTW_SSE2(s[k - 1], s[k])));
+
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_SSE2(state, s);
+}
+
+SSE2_FN void reducedDuplexRow_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordInOut = rowInOut; //In Lyra2: pointer to row*
+    uint64_t* ptrWordIn = rowIn; //In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut; //In Lyra2: pointer to row
+    __m128i s[8];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSE2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (k = 0; k < 6; k++) {
+            __m128i in = _mm_loadu_si128((const __m128i*) &ptrWordIn[2 * k]);
+            __m128i inOut = _mm_loadu_si128((const __m128i*) &ptrWordInOut[2 * k]);
+            s[k] = _mm_xor_si128(s[k], _mm_add_epi64(in, inOut));
+        }
+        roundLyra_sse2(s);
+
+        //M[rowOut][col] = M[rowOut][col] XOR rand
+        for (k = 0; k < 6; k++) {
+            __m128i out = _mm_loadu_si128((const __m128i*) &ptrWordOut[2 * k]);
+            _mm_storeu_si128((__m128i*) &ptrWordOut[2 * k], _mm_xor_si128(out, s[k]));
+        }
+
+        //M[rowInOut][col] = M[rowInOut][col] XOR rotW(rand)
+        //rowInOut is only read back here, as it may be the same row as rowOut
+        for (k = 0; k < 6; k++) {
+            __m128i inOut = _mm_loadu_si128((const __m128i*) &ptrWordInOut[2 * k]);
+            __m128i rot = k == 0 ? ROTW_SSE2(s[5], s[0]) : ROTW_SSE2(s[k - 1], s[k]);
+            _mm_storeu_si128((__m128i*) &ptrWordInOut[2 * k], _mm_xor_si128(inOut, rot));
+        }
+
+        ptrWordOut += BLOCK_LEN_INT64;
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+    }
+    STORE_STATE_SSE2(state, s);
+}
+
+#endif /* LYRA2_SIMD */
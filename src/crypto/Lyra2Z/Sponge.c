@@ -24,6 +24,59 @@
 #include "Sponge.h"
 #include "Lyra2.h"
 
+/* Implementation used by the row operations, chosen once before main() runs */
+static int spongeImpl = SPONGE_IMPL_SCALAR;
+
+#if defined(LYRA2_SIMD)
+int spongeIsImplSupported(int impl) {
+    __builtin_cpu_init();
+    switch (impl) {
+    case SPONGE_IMPL_SCALAR: return 1;
+    case SPONGE_IMPL_SSE2: return __builtin_cpu_supports("sse2");
+    case SPONGE_IMPL_AVX2: return __builtin_cpu_supports("avx2");
+    }
+    return 0;
+}
+
+__attribute__ ((constructor)) static void spongeDetectImpl(void) {
+    if (spongeIsImplSupported(SPONGE_IMPL_AVX2))
+        spongeImpl = SPONGE_IMPL_AVX2;
+#if !defined(__x86_64__)
+    /* On x86-64 the compiler already keeps the scalar state in registers and
+     * the SSE2 version is no faster, so it is only picked for 32-bit builds. */
+    else if (spongeIsImplSupported(SPONGE_IMPL_SSE2))
+        spongeImpl = SPONGE_IMPL_SSE2;
+#endif
+}
+
+#define SPONGE_DISPATCH(fn, args) \
+  do { \
+    if (spongeImpl == SPONGE_IMPL_AVX2) { fn##_avx2 args; return; } \
+    if (spongeImpl == SPONGE_IMPL_SSE2) { fn##_sse2 args; return; } \
+  } while(0)
+#else
+int spongeIsImplSupported(int impl) {
+    return impl == SPONGE_IMPL_SCALAR;
+}
+
+#define SPONGE_DISPATCH(fn, args)
+#endif
+
+int spongeGetImpl(void) {
+    return spongeImpl;
+}
+
+/**
+ * Forces the implementation used by the sponge's row operations; intended for
+ * tests and benchmarks. Not thread safe: must not be called while hashing.
+ */
+int spongeSetImpl(int impl) {
+    if (!spongeIsImplSupported(impl))
+        return 0;
+    spongeImpl = impl;
+    return 1;
+}
+
 
 
 /**
@@ -88,6 +141,7 @@ inline static void reducedBlake2bLyra(uint64_t *v) {
  * @param len        The number of bytes to be squeezed into the "out" array
  */
 inline void squeeze(uint64_t *state, byte *out, unsigned int len) {
+    SPONGE_DISPATCH(squeeze, (state, out, len));
     int fullBlocks = len / BLOCK_LEN_BYTES;
     byte *ptr = out;
     int i;
@@ -110,6 +164,7 @@ inline void squeeze(uint64_t *state, byte *out, unsigned int len) {
  * @param in    The block to be absorbed (BLOCK_LEN_INT64 words)
  */
 inline void absorbBlock(uint64_t *state, const uint64_t *in) {
+    SPONGE_DISPATCH(absorbBlock, (state, in));
     //XORs the first BLOCK_LEN_INT64 words of "in" with the current state
     state[0] ^= in[0];
     state[1] ^= in[1];
@@ -136,6 +191,7 @@ inline void absorbBlock(uint64_t *state, const uint64_t *in) {
  * @param in    The block to be absorbed (BLOCK_LEN_BLAKE2_SAFE_INT64 words)
  */
 inline void absorbBlockBlake2Safe(uint64_t *state, const uint64_t *in) {
+    SPONGE_DISPATCH(absorbBlockBlake2Safe, (state, in));
     //XORs the first BLOCK_LEN_BLAKE2_SAFE_INT64 words of "in" with the current state
 
     state[0] ^= in[0];
@@ -162,6 +218,7 @@ inline void absorbBlockBlake2Safe(uint64_t *state, const uint64_t *in) {
  * @param rowOut    Row to receive the data squeezed
  */
 inline void reducedSqueezeRow0(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    SPONGE_DISPATCH(reducedSqueezeRow0, (state, rowOut, nCols));
     uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to M[0][C-1]
     int i;
     //M[row][C-1-col] = H.reduced_squeeze()
@@ -197,6 +254,7 @@ inline void reducedSqueezeRow0(uint64_t* state, uint64_t* rowOut, uint64_t nCols
  * @param rowOut	Row to receive the sponge's output
  */
 inline void reducedDuplexRow1(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    SPONGE_DISPATCH(reducedDuplexRow1, (state, rowIn, rowOut, nCols));
     uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
     uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
     int i;
@@ -257,6 +315,7 @@ inline void reducedDuplexRow1(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut
  *
  */
 inline void reducedDuplexRowSetup(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    SPONGE_DISPATCH(reducedDuplexRowSetup, (state, rowIn, rowInOut, rowOut, nCols));
     uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
     uint64_t* ptrWordInOut = rowInOut;				//In Lyra2: pointer to row*
     uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
@@ -331,6 +390,7 @@ inline void reducedDuplexRowSetup(uint64_t *state, uint64_t *rowIn, uint64_t *ro
  *
  */
 inline void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    SPONGE_DISPATCH(reducedDuplexRow, (state, rowIn, rowInOut, rowOut, nCols));
     uint64_t* ptrWordInOut = rowInOut; //In Lyra2: pointer to row*
     uint64_t* ptrWordIn = rowIn; //In Lyra2: pointer to prev
     uint64_t* ptrWordOut = rowOut; //In Lyra2: pointer to row
@@ -73,6 +73,32 @@ static inline uint64_t rotr64( const uint64_t w, const unsigned c ){
     G(r,7,v[ 3],v[ 4],v[ 9],v[14]);
 
 
+//---- Implementation selection
+//The row operations below have SSE2 and AVX2 versions (Sponge-sse2.c, Sponge-avx2.c) that are
+//bit-identical to the scalar reference. The best one supported by the CPU is picked at startup.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(BLOCK_LEN_BITS)
+#define LYRA2_SIMD
+#endif
+
+enum {
+    SPONGE_IMPL_SCALAR = 0,
+    SPONGE_IMPL_SSE2 = 1,
+    SPONGE_IMPL_AVX2 = 2
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int spongeGetImpl(void);
+//Returns 0 if the implementation is not supported on this CPU or build
+int spongeSetImpl(int impl);
+int spongeIsImplSupported(int impl);
+
+#ifdef __cplusplus
+}
+#endif
+
 //---- Housekeeping
 void initState(uint64_t state[/*16*/]);
 
@@ -92,6 +118,24 @@ void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint
 //---- Misc
 void printArray(unsigned char *array, unsigned int size, char *name);
 
+#if defined(LYRA2_SIMD)
+void squeeze_sse2(uint64_t *state, unsigned char *out, unsigned int len);
+void reducedSqueezeRow0_sse2(uint64_t* state, uint64_t* row, uint64_t nCols);
+void absorbBlock_sse2(uint64_t *state, const uint64_t *in);
+void absorbBlockBlake2Safe_sse2(uint64_t *state, const uint64_t *in);
+void reducedDuplexRow1_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRowSetup_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRow_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+
+void squeeze_avx2(uint64_t *state, unsigned char *out, unsigned int len);
+void reducedSqueezeRow0_avx2(uint64_t* state, uint64_t* row, uint64_t nCols);
+void absorbBlock_avx2(uint64_t *state, const uint64_t *in);
+void absorbBlockBlake2Safe_avx2(uint64_t *state, const uint64_t *in);
+void reducedDuplexRow1_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRowSetup_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRow_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 
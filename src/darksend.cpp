@@ -5,10 +5,13 @@
 #include "activebznode.h"
 #include "coincontrol.h"
 #include "consensus/validation.h"
+#include "crypto/sha256.h"
 #include "darksend.h"
 //#include "governance.h"
 #include "init.h"
 #include "instantx.h"
+#include "random.h"
+#include "scheduler.h"
 #include "bznode-payments.h"
 #include "bznode-sync.h"
 #include "bznodeman.h"
@@ -2335,13 +2338,61 @@ bool CDarkSendSigner::SignMessage(std::string strMessage, std::vector<unsigned c
     return key.SignCompact(ss.GetHash(), vchSigRet);
 }
 
+CMessageSigCache::CMessageSigCache() : nHits(0), nMisses(0) {
+}
+
+void CMessageSigCache::ComputeEntry(uint256 &entry, const uint256 &hash, const std::vector<unsigned char> &vchSig, const CPubKey &pubkey) {
+    std::call_once(nonceInitFlag, [this]() { GetRandBytes(nonce.begin(), 32); });
+    CSHA256 hasher;
+    hasher.Write(nonce.begin(), 32).Write(hash.begin(), 32).Write(pubkey.begin(), pubkey.size());
+    if (!vchSig.empty())
+        hasher.Write(&vchSig[0], vchSig.size());
+    hasher.Finalize(entry.begin());
+}
+
+bool CMessageSigCache::Get(const uint256 &entry) {
+    bool fFound;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs);
+        fFound = setValid.count(entry) != 0;
+    }
+    if (fFound)
+        nHits++;
+    else
+        nMisses++;
+    return fFound;
+}
+
+void CMessageSigCache::Set(const uint256 &entry) {
+    boost::unique_lock<boost::shared_mutex> lock(cs);
+    while (setValid.size() >= MAX_MESSAGE_SIG_CACHE_SIZE) {
+        set_type::size_type s = GetRand(setValid.bucket_count());
+        set_type::local_iterator it = setValid.begin(s);
+        if (it != setValid.end(s)) {
+            setValid.erase(*it);
+        }
+    }
+    setValid.insert(entry);
+}
+
+size_t CMessageSigCache::Size() {
+    boost::shared_lock<boost::shared_mutex> lock(cs);
+    return setValid.size();
+}
+
 bool CDarkSendSigner::VerifyMessage(CPubKey pubkey, const std::vector<unsigned char> &vchSig, std::string strMessage, std::string &strErrorRet) {
     CHashWriter ss(SER_GETHASH, 0);
     ss << strMessageMagic;
     ss << strMessage;
+    uint256 hash = ss.GetHash();
+
+    uint256 entry;
+    sigCache.ComputeEntry(entry, hash, vchSig, pubkey);
+    if (sigCache.Get(entry))
+        return true;
 
     CPubKey pubkeyFromSig;
-    if (!pubkeyFromSig.RecoverCompact(ss.GetHash(), vchSig)) {
+    if (!pubkeyFromSig.RecoverCompact(hash, vchSig)) {
         strErrorRet = "Error recovering public key.";
         return false;
     }
@@ -2353,6 +2404,7 @@ bool CDarkSendSigner::VerifyMessage(CPubKey pubkey, const std::vector<unsigned c
         return false;
     }
 
+    sigCache.Set(entry);
     return true;
 }
 
@@ -2488,59 +2540,87 @@ void CDarksendPool::UpdatedBlockTip(const CBlockIndex *pindex) {
     }
 }
 
-//TODO: Rename/move to core
-void ThreadCheckDarkSendPool() {
-    if (fLiteMode) return; // disable all Dash specific functionality
+static CCriticalSection cs_maintenanceStats;
+static std::map<std::string, CMaintenanceStats> mapMaintenanceStats;
 
-    static bool fOneThread;
-    if (fOneThread) return;
-    fOneThread = true;
+static void RunMaintenanceTask(const std::string& strName, const boost::function<void()>& task, bool fRequireSynced)
+{
+    if (ShutdownRequested()) return;
+    if (fRequireSynced && !bznodeSync.IsBlockchainSynced()) return;
 
-    // Make this thread recognisable as the PrivateSend thread
-    RenameThread("dash-privatesend");
+    int64_t nTimeStart = GetTimeMicros();
+    task();
+    int64_t nTime = GetTimeMicros() - nTimeStart;
 
-    unsigned int nTick = 0;
-    unsigned int nDoAutoNextRun = nTick + PRIVATESEND_AUTO_TIMEOUT_MIN;
+    LOCK(cs_maintenanceStats);
+    CMaintenanceStats& stats = mapMaintenanceStats[strName];
+    stats.nCount++;
+    stats.nTimeMicros += nTime;
+    stats.nMaxTimeMicros = std::max(stats.nMaxTimeMicros, nTime);
+}
 
-    while (true) {
-        MilliSleep(1000);
+static void StartMaintenanceTask(CScheduler* scheduler, const CScheduler::Function& f, int64_t nIntervalSeconds)
+{
+    f();
+    scheduler->scheduleEvery(f, nIntervalSeconds);
+}
 
-        // try to sync from all available nodes, one step at a time
-        bznodeSync.ProcessTick();
+/** Run task every nIntervalSeconds, the first time after nFirstSeconds */
+static void ScheduleMaintenanceTask(CScheduler& scheduler, const std::string& strName, const boost::function<void()>& task,
+                                    int64_t nFirstSeconds, int64_t nIntervalSeconds, bool fRequireSynced = true)
+{
+    CScheduler::Function f = boost::bind(&RunMaintenanceTask, strName, task, fRequireSynced);
+    scheduler.scheduleFromNow(boost::bind(&StartMaintenanceTask, &scheduler, f, nIntervalSeconds), nFirstSeconds);
+}
 
-        if (bznodeSync.IsBlockchainSynced() && !ShutdownRequested()) {
+static void CheckDarkSendPoolQueue()
+{
+    darkSendPool.CheckTimeout();
+    darkSendPool.CheckForCompleteQueue();
+}
 
-            nTick++;
+static void DoAutomaticDenominatingTask()
+{
+    darkSendPool.DoAutomaticDenominating();
+}
 
-            // make sure to check all bznodes first
-            mnodeman.Check();
+// runs at a random interval, so it reschedules itself instead of using scheduleEvery()
+static void ScheduleAutomaticDenominating(CScheduler* scheduler)
+{
+    RunMaintenanceTask("privatesenddenominate", &DoAutomaticDenominatingTask, true);
+    scheduler->scheduleFromNow(boost::bind(&ScheduleAutomaticDenominating, scheduler),
+                               PRIVATESEND_AUTO_TIMEOUT_MIN + GetRandInt(PRIVATESEND_AUTO_TIMEOUT_MAX - PRIVATESEND_AUTO_TIMEOUT_MIN));
+}
 
-            // check if we should activate or ping every few minutes,
-            // slightly postpone first run to give net thread a chance to connect to some peers
-            if (nTick % BZNODE_MIN_MNP_SECONDS == 15)
-                activeBznode.ManageState();
+void ScheduleDarkSendMaintenance(CScheduler& scheduler)
+{
+    if (fLiteMode) return; // disable all Dash specific functionality
 
-            if (nTick % 60 == 0) {
-                mnodeman.ProcessBznodeConnections();
-                mnodeman.CheckAndRemove();
-                mnpayments.CheckAndRemove();
-                instantsend.CheckAndRemove();
-            }
-            if (fBZNode && (nTick % (60 * 5) == 0)) {
-                mnodeman.DoFullVerificationStep();
-            }
+    // try to sync from all available nodes, one step at a time
+    ScheduleMaintenanceTask(scheduler, "bznodesync", boost::bind(&CBznodeSync::ProcessTick, &bznodeSync), 1, 1, false);
 
-//            if(nTick % (60 * 5) == 0) {
-//                governance.DoMaintenance();
-//            }
+    // only the bznodes that may have changed state, the others wait for their next deadline
+    ScheduleMaintenanceTask(scheduler, "bznodecheck", boost::bind(&CBznodeMan::CheckDue, &mnodeman), 1, 1);
 
-            darkSendPool.CheckTimeout();
-            darkSendPool.CheckForCompleteQueue();
+    // check if we should activate or ping every few minutes,
+    // slightly postpone first run to give net thread a chance to connect to some peers
+    ScheduleMaintenanceTask(scheduler, "bznodestate", boost::bind(&CActiveBznode::ManageState, &activeBznode), 15, BZNODE_MIN_MNP_SECONDS);
 
-            if (nDoAutoNextRun == nTick) {
-                darkSendPool.DoAutomaticDenominating();
-                nDoAutoNextRun = nTick + PRIVATESEND_AUTO_TIMEOUT_MIN + GetRandInt(PRIVATESEND_AUTO_TIMEOUT_MAX - PRIVATESEND_AUTO_TIMEOUT_MIN);
-            }
-        }
+    ScheduleMaintenanceTask(scheduler, "bznodeconnections", boost::bind(&CBznodeMan::ProcessBznodeConnections, &mnodeman), 60, 60);
+    ScheduleMaintenanceTask(scheduler, "bznodecleanup", boost::bind(&CBznodeMan::CheckAndRemove, &mnodeman), 60, 60);
+    ScheduleMaintenanceTask(scheduler, "paymentscleanup", boost::bind(&CBznodePayments::CheckAndRemove, &mnpayments), 60, 60);
+    ScheduleMaintenanceTask(scheduler, "instantsendcleanup", boost::bind(&CInstantSend::CheckAndRemove, &instantsend), 60, 60);
+
+    if (fBZNode) {
+        ScheduleMaintenanceTask(scheduler, "bznodeverify", boost::bind(&CBznodeMan::DoFullVerificationStep, &mnodeman), 60 * 5, 60 * 5);
     }
+
+    ScheduleMaintenanceTask(scheduler, "privatesendqueue", &CheckDarkSendPoolQueue, 1, 1);
+    scheduler.scheduleFromNow(boost::bind(&ScheduleAutomaticDenominating, &scheduler), PRIVATESEND_AUTO_TIMEOUT_MIN);
+}
+
+std::map<std::string, CMaintenanceStats> GetMaintenanceStats()
+{
+    LOCK(cs_maintenanceStats);
+    return mapMaintenanceStats;
 }
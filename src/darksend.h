@@ -8,9 +8,18 @@
 #include "bznode.h"
 #include "wallet/wallet.h"
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/unordered_set.hpp>
+
 class CDarksendPool;
 class CDarkSendSigner;
 class CDarksendBroadcastTx;
+class CScheduler;
 
 // timeouts
 static const int PRIVATESEND_AUTO_TIMEOUT_MIN       = 5;
@@ -234,10 +243,55 @@ public:
     bool CheckSignature(const CPubKey& pubKeyBznode);
 };
 
+//! max number of valid message signatures kept by CMessageSigCache
+static const unsigned int MAX_MESSAGE_SIG_CACHE_SIZE = 100000;
+
+/**
+ * Valid message signature cache. Pings, broadcasts and votes are relayed by
+ * every peer, without it the same compact signature is recovered once per copy.
+ * Entries are SHA256(nonce || message hash || public key || signature), only
+ * successful verifications are stored.
+ */
+class CMessageSigCache
+{
+private:
+    class CEntryHasher
+    {
+    public:
+        size_t operator()(const uint256& key) const { return key.GetCheapHash(); }
+    };
+    typedef boost::unordered_set<uint256, CEntryHasher> set_type;
+
+    // drawn on first use, not during static initialization where the RNG may not be set up yet
+    uint256 nonce;
+    std::once_flag nonceInitFlag;
+    set_type setValid;
+    boost::shared_mutex cs;
+
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+public:
+    CMessageSigCache();
+
+    void ComputeEntry(uint256& entry, const uint256& hash, const std::vector<unsigned char>& vchSig, const CPubKey& pubkey);
+    /// Returns true if entry is known valid, counts a hit or a miss
+    bool Get(const uint256& entry);
+    /// Stores a valid entry, evicts a random one when full
+    void Set(const uint256& entry);
+
+    size_t Size();
+    uint64_t GetHits() const { return nHits; }
+    uint64_t GetMisses() const { return nMisses; }
+};
+
 /** Helper object for signing and checking signatures
  */
 class CDarkSendSigner
 {
+private:
+    CMessageSigCache sigCache;
+
 public:
     /// Is the input associated with this public key? (and there is 1000 BZX - checking if valid bznode)
     bool IsVinAssociatedWithPubkey(const CTxIn& vin, const CPubKey& pubkey);
@@ -247,6 +301,8 @@ public:
     bool SignMessage(std::string strMessage, std::vector<unsigned char>& vchSigRet, CKey key);
     /// Verify the message, returns true if succcessful
     bool VerifyMessage(CPubKey pubkey, const std::vector<unsigned char>& vchSig, std::string strMessage, std::string& strErrorRet);
+
+    CMessageSigCache& GetSigCache() { return sigCache; }
 };
 
 
@@ -478,6 +534,18 @@ public:
     void UpdatedBlockTip(const CBlockIndex *pindex);
 };
 
-void ThreadCheckDarkSendPool();
+/** Number and cost of the runs of one maintenance task, see ScheduleDarkSendMaintenance() */
+struct CMaintenanceStats
+{
+    uint64_t nCount;
+    int64_t nTimeMicros;
+    int64_t nMaxTimeMicros;
+
+    CMaintenanceStats() : nCount(0), nTimeMicros(0), nMaxTimeMicros(0) {}
+};
+
+/** Schedule the periodic bznode, payments, InstantSend and PrivateSend tasks */
+void ScheduleDarkSendMaintenance(CScheduler& scheduler);
+std::map<std::string, CMaintenanceStats> GetMaintenanceStats();
 
-#endif
\ No newline at end of file
+#endif
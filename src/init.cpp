@@ -88,6 +88,8 @@
 
 
 bool fFeeEstimatesInitialized = false;
+static bool fBznodeCacheLoaded = false;
+static bool fNetFulfilledCacheLoaded = false;
 static const bool DEFAULT_PROXYRANDOMIZE = true;
 static const bool DEFAULT_REST_ENABLE = false;
 static const bool DEFAULT_DISABLE_SAFEMODE = false;
@@ -245,6 +247,21 @@ void Shutdown() {
     StopTorControl();
     UnregisterNodeSignals(GetNodeSignals());
 
+    if (fBznodeCacheLoaded) {
+        // STORE DATA CACHES INTO SERIALIZED DAT FILES
+        CFlatDB<CBznodeMan> flatdb1("mncache.dat", "magicBznodeCache");
+        flatdb1.Dump(mnodeman);
+        CFlatDB<CBznodePayments> flatdb2("mnpayments.dat", "magicBznodePaymentsCache");
+        flatdb2.Dump(mnpayments);
+        fBznodeCacheLoaded = false;
+    }
+
+    if (fNetFulfilledCacheLoaded) {
+        CFlatDB<CNetFulfilledRequestManager> flatdb4("netfulfilled.dat", "magicFulfilledCache");
+        flatdb4.Dump(netfulfilledman);
+        fNetFulfilledCacheLoaded = false;
+    }
+
     if (fFeeEstimatesInitialized) {
         boost::filesystem::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
         CAutoFile est_fileout(fopen(est_path.string().c_str(), "wb"), SER_DISK, CLIENT_VERSION);
@@ -382,6 +399,12 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-par=<n>", strprintf(
             _("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
             -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-parheaders=<n>", strprintf(
+            _("Set the number of header proof-of-work verification threads (%u to %d, 0 = half of -par, <0 = leave that many cores free, default: %d)"),
+            -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_HEADERCHECK_THREADS));
+    strUsage += HelpMessageOpt("-parspends=<n>", strprintf(
+            _("Set the number of zerocoin spend verification threads (%u to %d, 0 = half of -par, <0 = leave that many cores free, default: %d)"),
+            -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SPENDCHECK_THREADS));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
@@ -439,6 +462,9 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-maxtimeadjustment", strprintf(
             _("Maximum allowed median peer time offset adjustment. Local perspective of time may be influenced by peers forward or backward by this amount. (default: %u seconds)"),
             DEFAULT_MAX_TIME_ADJUSTMENT));
+    strUsage += HelpMessageOpt("-msghandlerthreads=<n>",
+                               strprintf(_("Number of threads that process bznode payment votes next to the message handler thread, 0 = process them on that thread (0 to %d, default: %d)"),
+                                         MAX_MSGHANDLER_THREADS, DEFAULT_MSGHANDLER_THREADS));
     strUsage += HelpMessageOpt("-onion=<ip:port>", strprintf(
             _("Use separate SOCKS5 proxy to reach peers via Tor hidden services (default: %s)"), "-proxy"));
     strUsage += HelpMessageOpt("-onlynet=<net>", _("Only connect to nodes in network <net> (ipv4, ipv6 or onion)"));
@@ -569,6 +595,9 @@ std::string HelpMessage(HelpMessageMode mode) {
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>",
                                    strprintf("Limit size of signature cache to <n> MiB (default: %u)",
                                              DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxzcspendcachesize=<n>",
+                                   strprintf("Limit size of the cache of verified zerocoin spends to <n> MiB (default: %u)",
+                                             DEFAULT_MAX_ZC_SPEND_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf(
                 "Maximum tip age in seconds to consider node in initial block download (default: %u)",
                 DEFAULT_MAX_TIP_AGE));
@@ -1034,6 +1063,19 @@ void InitLogging() {
     LogPrintf("bitcoinzero version %s\n", FormatFullVersion());
 }
 
+/** Reads a -par style thread count, where 0 means half of the script verification threads */
+static int GetCheckThreadsArg(const std::string& strArg, int nDefault)
+{
+    int nThreads = GetArg(strArg, nDefault);
+    if (nThreads == 0)
+        nThreads = (nScriptCheckThreads + 1) / 2;
+    else if (nThreads < 0)
+        nThreads += GetNumCores();
+    if (nThreads <= 1)
+        return 0;
+    return std::min(nThreads, MAX_SCRIPTCHECK_THREADS);
+}
+
 /** Initialize bitcoin.
  *  @pre Parameters should be parsed and config file should be read.
  */
@@ -1110,15 +1152,23 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
 #endif
     }
 
+    // The socket handler uses epoll when built with it and select() otherwise, never
+    // falling back to select() at runtime, so the FD_SETSIZE cap below holds
+    if (!InitSocketEvents())
+        return InitError(_("Unable to create the epoll instance for the network sockets."));
+
     // Make sure enough file descriptors are available
-    int nBind = std::max(
-            (mapMultiArgs.count("-bind") ? mapMultiArgs.at("-bind").size() : 0) +
-            (mapMultiArgs.count("-whitebind") ? mapMultiArgs.at("-whitebind").size() : 0), size_t(1));
     int nUserMaxConnections = GetArg("-maxconnections", DEFAULT_MAX_PEER_CONNECTIONS);
     nMaxConnections = std::max(nUserMaxConnections, 0);
 
     // Trim requested connection counts, to fit into system limitations
+#ifndef HAVE_SYS_EPOLL_H
+    // select() can't wait for sockets past FD_SETSIZE
+    int nBind = std::max(
+            (mapMultiArgs.count("-bind") ? mapMultiArgs.at("-bind").size() : 0) +
+            (mapMultiArgs.count("-whitebind") ? mapMultiArgs.at("-whitebind").size() : 0), size_t(1));
     nMaxConnections = std::max(std::min(nMaxConnections, (int) (FD_SETSIZE - nBind - MIN_CORE_FILEDESCRIPTORS)), 0);
+#endif
     int nFD = RaiseFileDescriptorLimit(nMaxConnections + MIN_CORE_FILEDESCRIPTORS);
     if (nFD < MIN_CORE_FILEDESCRIPTORS)
         return InitError(_("Not enough file descriptors available."));
@@ -1180,6 +1230,10 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    // the header and spend queues get their own threads, half as many as the scripts unless set
+    nHeaderCheckThreads = GetCheckThreadsArg("-parheaders", DEFAULT_HEADERCHECK_THREADS);
+    nSpendCheckThreads = GetCheckThreadsArg("-parspends", DEFAULT_SPENDCHECK_THREADS);
+
     fServer = GetBoolArg("-server", false);
 
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
@@ -1340,11 +1394,20 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     LogPrintf("Using at most %i connections (%i file descriptors available)\n", nMaxConnections, nFD);
     std::ostringstream strErrors;
 
-    LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
+    LogPrintf("Using %u threads for script, %u for header and %u for zerocoin spend verification\n",
+              nScriptCheckThreads, nHeaderCheckThreads, nSpendCheckThreads);
     if (nScriptCheckThreads) {
         for (int i = 0; i < nScriptCheckThreads - 1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
     }
+    if (nHeaderCheckThreads) {
+        for (int i = 0; i < nHeaderCheckThreads - 1; i++)
+            threadGroup.create_thread(&ThreadHeaderCheck);
+    }
+    if (nSpendCheckThreads) {
+        for (int i = 0; i < nSpendCheckThreads - 1; i++)
+            threadGroup.create_thread(&ThreadZerocoinSpendCheck);
+    }
 
     // Start the lightweight task scheduler thread
     CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue, &scheduler);
@@ -1616,7 +1679,10 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
                 }
                 LogPrintf("LoadBlockIndex...\n");
                 if (!LoadBlockIndex()) {
-                    strLoadError = _("Error loading block database");
+                    if (pblocktree->WrittenByOlderClient())
+                        strLoadError = _("The block database was changed by an older version of the client and has to be rebuilt with -reindex");
+                    else
+                        strLoadError = _("Error loading block database");
                     break;
                 }
 
@@ -1904,8 +1970,35 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
 
     // LOAD SERIALIZED DAT FILES INTO DATA CACHES FOR INTERNAL USE
 
+    if (!fLiteMode) {
+        uiInterface.InitMessage(_("Loading bznode cache..."));
+        CFlatDB<CBznodeMan> flatdb1("mncache.dat", "magicBznodeCache");
+        if (!flatdb1.Load(mnodeman)) {
+            return InitError(_("Failed to load bznode cache from") + "\n" + (GetDataDir() / "mncache.dat").string());
+        }
+
+        if (mnodeman.size()) {
+            uiInterface.InitMessage(_("Loading bznode payment cache..."));
+            CFlatDB<CBznodePayments> flatdb2("mnpayments.dat", "magicBznodePaymentsCache");
+            if (!flatdb2.Load(mnpayments)) {
+                return InitError(_("Failed to load bznode payments cache from") + "\n" + (GetDataDir() / "mnpayments.dat").string());
+            }
+        } else {
+            uiInterface.InitMessage(_("Bznode cache is empty, skipping payments cache..."));
+        }
+
+        fBznodeCacheLoaded = true;
+    }
+
+    uiInterface.InitMessage(_("Loading fulfilled requests cache..."));
     CFlatDB<CNetFulfilledRequestManager> flatdb4("netfulfilled.dat", "magicFulfilledCache");
-    flatdb4.Load(netfulfilledman);
+    if (flatdb4.Load(netfulfilledman)) {
+        fNetFulfilledCacheLoaded = true;
+    } else {
+        // only a cache of recent requests, start with an empty one
+        LogPrintf("Failed to load fulfilled requests cache from %s, starting with an empty one\n", (GetDataDir() / "netfulfilled.dat").string());
+        netfulfilledman.Clear();
+    }
 
     // ********************************************************* Step 11c: update block tip in Dash modules
 
@@ -1918,9 +2011,16 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     bznodeSync.UpdatedBlockTip(chainActive.Tip());
     // governance.UpdatedBlockTip(chainActive.Tip());
 
-    // ********************************************************* Step 11d: start dash-privatesend thread
+    // the caches loaded above can be arbitrarily old, drop what went stale while we were offline
+    if (fBznodeCacheLoaded) {
+        mnodeman.RemoveSpent();
+        mnpayments.CheckAndRemove();
+    }
+
+    // ********************************************************* Step 11d: schedule bznode and PrivateSend maintenance
 
-    threadGroup.create_thread(boost::bind(&ThreadCheckDarkSendPool));
+    ScheduleDarkSendMaintenance(scheduler);
+    StartMnbVerifyThreads(threadGroup);
 
 
 
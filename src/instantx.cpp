@@ -79,7 +79,7 @@ bool CInstantSend::ProcessTxLockRequest(const CTxLockRequest& txLockRequest)
     // Check to see if we conflict with existing completed lock,
     // fail if so, there can't be 2 completed locks for the same outpoint
     BOOST_FOREACH(const CTxIn& txin, txLockRequest.vin) {
-        std::map<COutPoint, uint256>::iterator it = mapLockedOutpoints.find(txin.prevout);
+        locked_outpoints_t::iterator it = mapLockedOutpoints.find(txin.prevout);
         if(it != mapLockedOutpoints.end()) {
             // Conflicting with complete lock, ignore this one
             // (this could be the one we have but we don't want to try to lock it twice anyway)
@@ -92,7 +92,7 @@ bool CInstantSend::ProcessTxLockRequest(const CTxLockRequest& txLockRequest)
     // Check to see if there are votes for conflicting request,
     // if so - do not fail, just warn user
     BOOST_FOREACH(const CTxIn& txin, txLockRequest.vin) {
-        std::map<COutPoint, std::set<uint256> >::iterator it = mapVotedOutpoints.find(txin.prevout);
+        outpoint_hashes_t::iterator it = mapVotedOutpoints.find(txin.prevout);
         if(it != mapVotedOutpoints.end()) {
             BOOST_FOREACH(const uint256& hash, it->second) {
                 if(hash != txLockRequest.GetHash()) {
@@ -110,7 +110,7 @@ bool CInstantSend::ProcessTxLockRequest(const CTxLockRequest& txLockRequest)
     }
     LogPrintf("CInstantSend::ProcessTxLockRequest -- accepted, txid=%s\n", txHash.ToString());
 
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     CTxLockCandidate& txLockCandidate = itLockCandidate->second;
     Vote(txLockCandidate);
     ProcessOrphanTxLockVotes();
@@ -132,7 +132,7 @@ bool CInstantSend::CreateTxLockCandidate(const CTxLockRequest& txLockRequest)
 
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     if(itLockCandidate == mapTxLockCandidates.end()) {
         LogPrintf("CInstantSend::CreateTxLockCandidate -- new, txid=%s\n", txHash.ToString());
 
@@ -169,31 +169,25 @@ void CInstantSend::Vote(CTxLockCandidate& txLockCandidate)
 
         int nLockInputHeight = nPrevoutHeight + 4;
 
-        int n = mnodeman.GetBznodeRank(activeBznode.vin, nLockInputHeight, MIN_INSTANTSEND_PROTO_VERSION);
-
-        if(n == -1) {
-            LogPrint("instantsend", "CInstantSend::Vote -- Unknown Bznode %s\n", activeBznode.vin.prevout.ToStringShort());
-            ++itOutpointLock;
-            continue;
-        }
+        int n = GetLockQuorumRank(activeBznode.vin.prevout, nLockInputHeight);
 
         int nSignaturesTotal = COutPointLock::SIGNATURES_TOTAL;
-        if(n > nSignaturesTotal) {
-            LogPrint("instantsend", "CInstantSend::Vote -- Bznode not in the top %d (%d)\n", nSignaturesTotal, n);
+        if(n == -1) {
+            LogPrint("instantsend", "CInstantSend::Vote -- Bznode %s not in the top %d\n", activeBznode.vin.prevout.ToStringShort(), nSignaturesTotal);
             ++itOutpointLock;
             continue;
         }
 
         LogPrint("instantsend", "CInstantSend::Vote -- In the top %d (%d)\n", nSignaturesTotal, n);
 
-        std::map<COutPoint, std::set<uint256> >::iterator itVoted = mapVotedOutpoints.find(itOutpointLock->first);
+        outpoint_hashes_t::iterator itVoted = mapVotedOutpoints.find(itOutpointLock->first);
 
         // Check to see if we already voted for this outpoint,
         // refuse to vote twice or to include the same outpoint in another tx
         bool fAlreadyVoted = false;
         if(itVoted != mapVotedOutpoints.end()) {
             BOOST_FOREACH(const uint256& hash, itVoted->second) {
-                std::map<uint256, CTxLockCandidate>::iterator it2 = mapTxLockCandidates.find(hash);
+                lock_candidates_t::iterator it2 = mapTxLockCandidates.find(hash);
                 if(it2->second.HasBznodeVoted(itOutpointLock->first, activeBznode.vin.prevout)) {
                     // we already voted for this outpoint to be included either in the same tx or in a competing one,
                     // skip it anyway
@@ -264,14 +258,14 @@ bool CInstantSend::ProcessTxLockVote(CNode* pfrom, CTxLockVote& vote)
     // Bznodes will sometimes propagate votes before the transaction is known to the client,
     // will actually process only after the lock request itself has arrived
 
-    std::map<uint256, CTxLockCandidate>::iterator it = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator it = mapTxLockCandidates.find(txHash);
     if(it == mapTxLockCandidates.end()) {
         if(!mapTxLockVotesOrphan.count(vote.GetHash())) {
-            mapTxLockVotesOrphan[vote.GetHash()] = vote;
+            AddOrphanVote(vote);
             LogPrint("instantsend", "CInstantSend::ProcessTxLockVote -- Orphan vote: txid=%s  bznode=%s new\n",
                     txHash.ToString(), vote.GetBznodeOutpoint().ToStringShort());
             bool fReprocess = true;
-            std::map<uint256, CTxLockRequest>::iterator itLockRequest = mapLockRequestAccepted.find(txHash);
+            lock_requests_t::iterator itLockRequest = mapLockRequestAccepted.find(txHash);
             if(itLockRequest == mapLockRequestAccepted.end()) {
                 itLockRequest = mapLockRequestRejected.find(txHash);
                 if(itLockRequest == mapLockRequestRejected.end()) {
@@ -314,13 +308,13 @@ bool CInstantSend::ProcessTxLockVote(CNode* pfrom, CTxLockVote& vote)
 
     LogPrint("instantsend", "CInstantSend::ProcessTxLockVote -- Transaction Lock Vote, txid=%s\n", txHash.ToString());
 
-    std::map<COutPoint, std::set<uint256> >::iterator it1 = mapVotedOutpoints.find(vote.GetOutpoint());
+    outpoint_hashes_t::iterator it1 = mapVotedOutpoints.find(vote.GetOutpoint());
     if(it1 != mapVotedOutpoints.end()) {
         BOOST_FOREACH(const uint256& hash, it1->second) {
             if(hash != txHash) {
                 // same outpoint was already voted to be locked by another tx lock request,
                 // find out if the same mn voted on this outpoint before
-                std::map<uint256, CTxLockCandidate>::iterator it2 = mapTxLockCandidates.find(hash);
+                lock_candidates_t::iterator it2 = mapTxLockCandidates.find(hash);
                 if(it2->second.HasBznodeVoted(vote.GetOutpoint(), vote.GetBznodeOutpoint())) {
                     // yes, it did, refuse to accept a vote to include the same outpoint in another tx
                     // from the same bznode.
@@ -363,16 +357,35 @@ bool CInstantSend::ProcessTxLockVote(CNode* pfrom, CTxLockVote& vote)
 void CInstantSend::ProcessOrphanTxLockVotes()
 {
     LOCK2(cs_main, cs_instantsend);
-    std::map<uint256, CTxLockVote>::iterator it = mapTxLockVotesOrphan.begin();
+    lock_votes_t::iterator it = mapTxLockVotesOrphan.begin();
     while(it != mapTxLockVotesOrphan.end()) {
         if(ProcessTxLockVote(NULL, it->second)) {
-            mapTxLockVotesOrphan.erase(it++);
+            it = EraseOrphanVote(it);
         } else {
             ++it;
         }
     }
 }
 
+void CInstantSend::AddOrphanVote(const CTxLockVote& vote)
+{
+    uint256 nVoteHash = vote.GetHash();
+    mapTxLockVotesOrphan[nVoteHash] = vote;
+    mapTxLockVotesOrphanByOutpoint[vote.GetOutpoint()].insert(nVoteHash);
+}
+
+CInstantSend::lock_votes_t::iterator CInstantSend::EraseOrphanVote(lock_votes_t::iterator it)
+{
+    outpoint_hashes_t::iterator itIndex = mapTxLockVotesOrphanByOutpoint.find(it->second.GetOutpoint());
+    if(itIndex != mapTxLockVotesOrphanByOutpoint.end()) {
+        itIndex->second.erase(it->first);
+        if(itIndex->second.empty()) {
+            mapTxLockVotesOrphanByOutpoint.erase(itIndex);
+        }
+    }
+    return mapTxLockVotesOrphan.erase(it);
+}
+
 bool CInstantSend::IsEnoughOrphanVotesForTx(const CTxLockRequest& txLockRequest)
 {
     // There could be a situation when we already have quite a lot of votes
@@ -388,18 +401,20 @@ bool CInstantSend::IsEnoughOrphanVotesForTx(const CTxLockRequest& txLockRequest)
 
 bool CInstantSend::IsEnoughOrphanVotesForTxAndOutPoint(const uint256& txHash, const COutPoint& outpoint)
 {
-    // Scan orphan votes to check if this outpoint has enough orphan votes to be locked in some tx.
+    // Check the orphan votes for this outpoint to see if it has enough of them to be locked in some tx.
     LOCK2(cs_main, cs_instantsend);
+    outpoint_hashes_t::iterator itIndex = mapTxLockVotesOrphanByOutpoint.find(outpoint);
+    if(itIndex == mapTxLockVotesOrphanByOutpoint.end()) return false;
+
     int nCountVotes = 0;
-    std::map<uint256, CTxLockVote>::iterator it = mapTxLockVotesOrphan.begin();
-    while(it != mapTxLockVotesOrphan.end()) {
-        if(it->second.GetTxHash() == txHash && it->second.GetOutpoint() == outpoint) {
+    BOOST_FOREACH(const uint256& nVoteHash, itIndex->second) {
+        lock_votes_t::iterator it = mapTxLockVotesOrphan.find(nVoteHash);
+        if(it != mapTxLockVotesOrphan.end() && it->second.GetTxHash() == txHash) {
             nCountVotes++;
             if(nCountVotes >= COutPointLock::SIGNATURES_REQUIRED) {
                 return true;
             }
         }
-        ++it;
     }
     return false;
 }
@@ -466,12 +481,39 @@ void CInstantSend::LockTransactionInputs(const CTxLockCandidate& txLockCandidate
 bool CInstantSend::GetLockedOutPointTxHash(const COutPoint& outpoint, uint256& hashRet)
 {
     LOCK(cs_instantsend);
-    std::map<COutPoint, uint256>::iterator it = mapLockedOutpoints.find(outpoint);
+    locked_outpoints_t::iterator it = mapLockedOutpoints.find(outpoint);
     if(it == mapLockedOutpoints.end()) return false;
     hashRet = it->second;
     return true;
 }
 
+int CInstantSend::GetLockQuorumRank(const COutPoint& outpointBznode, int nLockInputHeight)
+{
+    LOCK2(cs_main, cs_instantsend);
+
+    uint256 blockHash;
+    if(!GetBlockHash(blockHash, nLockInputHeight)) return -1;
+
+    int nStateVersion = mnodeman.GetStateVersion();
+    boost::unordered_map<int, lock_quorum_t>::iterator it = mapLockQuorums.find(nLockInputHeight);
+    if(it == mapLockQuorums.end() || it->second.blockHash != blockHash || it->second.nStateVersion != nStateVersion) {
+        if(it == mapLockQuorums.end()) {
+            // quorums are cheap to compute again, just start over
+            if(mapLockQuorums.size() >= MAX_LOCK_QUORUMS) mapLockQuorums.clear();
+            it = mapLockQuorums.insert(std::make_pair(nLockInputHeight, lock_quorum_t())).first;
+        }
+        it->second.blockHash = blockHash;
+        it->second.nStateVersion = nStateVersion;
+        it->second.vecBznodes = mnodeman.GetTopRankedOutpoints(nLockInputHeight, COutPointLock::SIGNATURES_TOTAL, MIN_INSTANTSEND_PROTO_VERSION);
+    }
+
+    const std::vector<COutPoint>& vecBznodes = it->second.vecBznodes;
+    for(unsigned int i = 0; i < vecBznodes.size(); i++) {
+        if(vecBznodes[i] == outpointBznode) return i + 1;
+    }
+    return -1;
+}
+
 bool CInstantSend::ResolveConflicts(const CTxLockCandidate& txLockCandidate, int nMaxBlocks)
 {
     if(nMaxBlocks < 1) return false;
@@ -567,7 +609,7 @@ int64_t CInstantSend::GetAverageBznodeOrphanVoteTime()
     // NOTE: should never actually call this function when mapBznodeOrphanVotes is empty
     if(mapBznodeOrphanVotes.empty()) return 0;
 
-    std::map<COutPoint, int64_t>::iterator it = mapBznodeOrphanVotes.begin();
+    bznode_orphan_votes_t::iterator it = mapBznodeOrphanVotes.begin();
     int64_t total = 0;
 
     while(it != mapBznodeOrphanVotes.end()) {
@@ -584,7 +626,7 @@ void CInstantSend::CheckAndRemove()
 
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.begin();
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.begin();
 
     // remove expired candidates
     while(itLockCandidate != mapTxLockCandidates.end()) {
@@ -607,7 +649,7 @@ void CInstantSend::CheckAndRemove()
     }
 
     // remove expired votes
-    std::map<uint256, CTxLockVote>::iterator itVote = mapTxLockVotes.begin();
+    lock_votes_t::iterator itVote = mapTxLockVotes.begin();
     while(itVote != mapTxLockVotes.end()) {
         if(itVote->second.IsExpired(pCurrentBlockIndex->nHeight)) {
             LogPrint("instantsend", "CInstantSend::CheckAndRemove -- Removing expired vote: txid=%s  bznode=%s\n",
@@ -619,20 +661,20 @@ void CInstantSend::CheckAndRemove()
     }
 
     // remove expired orphan votes
-    std::map<uint256, CTxLockVote>::iterator itOrphanVote = mapTxLockVotesOrphan.begin();
+    lock_votes_t::iterator itOrphanVote = mapTxLockVotesOrphan.begin();
     while(itOrphanVote != mapTxLockVotesOrphan.end()) {
         if(GetTime() - itOrphanVote->second.GetTimeCreated() > ORPHAN_VOTE_SECONDS) {
             LogPrint("instantsend", "CInstantSend::CheckAndRemove -- Removing expired orphan vote: txid=%s  bznode=%s\n",
                     itOrphanVote->second.GetTxHash().ToString(), itOrphanVote->second.GetBznodeOutpoint().ToStringShort());
             mapTxLockVotes.erase(itOrphanVote->first);
-            mapTxLockVotesOrphan.erase(itOrphanVote++);
+            itOrphanVote = EraseOrphanVote(itOrphanVote);
         } else {
             ++itOrphanVote;
         }
     }
 
     // remove expired bznode orphan votes (DOS protection)
-    std::map<COutPoint, int64_t>::iterator itBznodeOrphan = mapBznodeOrphanVotes.begin();
+    bznode_orphan_votes_t::iterator itBznodeOrphan = mapBznodeOrphanVotes.begin();
     while(itBznodeOrphan != mapBznodeOrphanVotes.end()) {
         if(itBznodeOrphan->second < GetTime()) {
             LogPrint("instantsend", "CInstantSend::CheckAndRemove -- Removing expired orphan bznode vote: bznode=%s\n",
@@ -674,7 +716,7 @@ bool CInstantSend::GetTxLockRequest(const uint256& txHash, CTxLockRequest& txLoc
 {
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockCandidate>::iterator it = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator it = mapTxLockCandidates.find(txHash);
     if(it == mapTxLockCandidates.end()) return false;
     txLockRequestRet = it->second.txLockRequest;
 
@@ -685,7 +727,7 @@ bool CInstantSend::GetTxLockVote(const uint256& hash, CTxLockVote& txLockVoteRet
 {
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockVote>::iterator it = mapTxLockVotes.find(hash);
+    lock_votes_t::iterator it = mapTxLockVotes.find(hash);
     if(it == mapTxLockVotes.end()) return false;
     txLockVoteRet = it->second;
 
@@ -700,7 +742,7 @@ bool CInstantSend::IsInstantSendReadyToLock(const uint256& txHash)
     LOCK(cs_instantsend);
     // There must be a successfully verified lock request
     // and all outputs must be locked (i.e. have enough signatures)
-    std::map<uint256, CTxLockCandidate>::iterator it = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator it = mapTxLockCandidates.find(txHash);
     return it != mapTxLockCandidates.end() && it->second.IsAllOutPointsReady();
 }
 
@@ -712,7 +754,7 @@ bool CInstantSend::IsLockedInstantSendTransaction(const uint256& txHash)
     LOCK(cs_instantsend);
 
     // there must be a lock candidate
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     if(itLockCandidate == mapTxLockCandidates.end()) return false;
 
     // which should have outpoints
@@ -737,7 +779,7 @@ int CInstantSend::GetTransactionLockSignatures(const uint256& txHash)
 
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     if(itLockCandidate != mapTxLockCandidates.end()) {
         return itLockCandidate->second.CountVotes();
     }
@@ -751,7 +793,7 @@ bool CInstantSend::IsTxLockRequestTimedOut(const uint256& txHash)
 
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     if (itLockCandidate != mapTxLockCandidates.end()) {
         return !itLockCandidate->second.IsAllOutPointsReady() &&
                 itLockCandidate->second.txLockRequest.IsTimedOut();
@@ -764,7 +806,7 @@ void CInstantSend::Relay(const uint256& txHash)
 {
     LOCK(cs_instantsend);
 
-    std::map<uint256, CTxLockCandidate>::const_iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::const_iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     if (itLockCandidate != mapTxLockCandidates.end()) {
         itLockCandidate->second.Relay();
     }
@@ -793,7 +835,7 @@ void CInstantSend::SyncTransaction(const CTransaction& tx, const CBlock* pblock)
     LogPrint("instantsend", "CInstantSend::SyncTransaction -- txid=%s nHeightNew=%d\n", txHash.ToString(), nHeightNew);
 
     // Check lock candidates
-    std::map<uint256, CTxLockCandidate>::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
+    lock_candidates_t::iterator itLockCandidate = mapTxLockCandidates.find(txHash);
     if(itLockCandidate != mapTxLockCandidates.end()) {
         LogPrint("instantsend", "CInstantSend::SyncTransaction -- txid=%s nHeightNew=%d lock candidate updated\n",
                 txHash.ToString(), nHeightNew);
@@ -804,7 +846,7 @@ void CInstantSend::SyncTransaction(const CTransaction& tx, const CBlock* pblock)
             // Check corresponding lock votes
             std::vector<CTxLockVote> vVotes = itOutpointLock->second.GetVotes();
             std::vector<CTxLockVote>::iterator itVote = vVotes.begin();
-            std::map<uint256, CTxLockVote>::iterator it;
+            lock_votes_t::iterator it;
             while(itVote != vVotes.end()) {
                 uint256 nVoteHash = itVote->GetHash();
                 LogPrint("instantsend", "CInstantSend::SyncTransaction -- txid=%s nHeightNew=%d vote %s updated\n",
@@ -820,7 +862,7 @@ void CInstantSend::SyncTransaction(const CTransaction& tx, const CBlock* pblock)
     }
 
     // check orphan votes
-    std::map<uint256, CTxLockVote>::iterator itOrphanVote = mapTxLockVotesOrphan.begin();
+    lock_votes_t::iterator itOrphanVote = mapTxLockVotesOrphan.begin();
     while(itOrphanVote != mapTxLockVotesOrphan.end()) {
         if(itOrphanVote->second.GetTxHash() == txHash) {
             LogPrint("instantsend", "CInstantSend::SyncTransaction -- txid=%s nHeightNew=%d vote %s updated\n",
@@ -977,22 +1019,17 @@ bool CTxLockVote::IsValid(CNode* pnode) const
 
     int nLockInputHeight = nPrevoutHeight + 4;
 
-    int n = mnodeman.GetBznodeRank(CTxIn(outpointBznode), nLockInputHeight, MIN_INSTANTSEND_PROTO_VERSION);
+    int n = instantsend.GetLockQuorumRank(outpointBznode, nLockInputHeight);
 
+    int nSignaturesTotal = COutPointLock::SIGNATURES_TOTAL;
     if(n == -1) {
-        //can be caused by past versions trying to vote with an invalid protocol
-        LogPrint("instantsend", "CTxLockVote::IsValid -- Outdated bznode %s\n", outpointBznode.ToStringShort());
+        // can also be caused by past versions trying to vote with an invalid protocol
+        LogPrint("instantsend", "CTxLockVote::IsValid -- Bznode %s is not in the top %d, vote hash=%s\n",
+                outpointBznode.ToStringShort(), nSignaturesTotal, GetHash().ToString());
         return false;
     }
     LogPrint("instantsend", "CTxLockVote::IsValid -- Bznode %s, rank=%d\n", outpointBznode.ToStringShort(), n);
 
-    int nSignaturesTotal = COutPointLock::SIGNATURES_TOTAL;
-    if(n > nSignaturesTotal) {
-        LogPrint("instantsend", "CTxLockVote::IsValid -- Bznode %s is not in the top %d (%d), vote hash=%s\n",
-                outpointBznode.ToStringShort(), nSignaturesTotal, n, GetHash().ToString());
-        return false;
-    }
-
     if(!CheckSignature()) {
         LogPrintf("CTxLockVote::IsValid -- Signature invalid\n");
         return false;
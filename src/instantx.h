@@ -4,9 +4,12 @@
 #ifndef INSTANTX_H
 #define INSTANTX_H
 
+#include "coins.h"
 #include "net.h"
 #include "primitives/transaction.h"
 
+#include <boost/unordered_map.hpp>
+
 class CTxLockVote;
 class COutPointLock;
 class CTxLockRequest;
@@ -37,23 +40,43 @@ class CInstantSend
 {
 private:
     static const int ORPHAN_VOTE_SECONDS            = 60;
+    static const unsigned int MAX_LOCK_QUORUMS      = 100;
+
+    typedef boost::unordered_map<uint256, CTxLockRequest, SaltedTxidHasher> lock_requests_t;
+    typedef boost::unordered_map<uint256, CTxLockVote, SaltedTxidHasher> lock_votes_t;
+    typedef boost::unordered_map<uint256, CTxLockCandidate, SaltedTxidHasher> lock_candidates_t;
+    typedef boost::unordered_map<COutPoint, std::set<uint256>, SaltedOutpointHasher> outpoint_hashes_t;
+    typedef boost::unordered_map<COutPoint, uint256, SaltedOutpointHasher> locked_outpoints_t;
+    typedef boost::unordered_map<COutPoint, int64_t, SaltedOutpointHasher> bznode_orphan_votes_t;
+
+    /** The bznodes allowed to vote on the inputs confirmed at one height */
+    struct lock_quorum_t {
+        uint256 blockHash;
+        int nStateVersion;
+        // top COutPointLock::SIGNATURES_TOTAL bznode outpoints, best first
+        std::vector<COutPoint> vecBznodes;
+    };
 
     // Keep track of current block index
     const CBlockIndex *pCurrentBlockIndex;
 
     // maps for AlreadyHave
-    std::map<uint256, CTxLockRequest> mapLockRequestAccepted; // tx hash - tx
-    std::map<uint256, CTxLockRequest> mapLockRequestRejected; // tx hash - tx
-    std::map<uint256, CTxLockVote> mapTxLockVotes; // vote hash - vote
-    std::map<uint256, CTxLockVote> mapTxLockVotesOrphan; // vote hash - vote
+    lock_requests_t mapLockRequestAccepted; // tx hash - tx
+    lock_requests_t mapLockRequestRejected; // tx hash - tx
+    lock_votes_t mapTxLockVotes; // vote hash - vote
+    lock_votes_t mapTxLockVotesOrphan; // vote hash - vote
+    outpoint_hashes_t mapTxLockVotesOrphanByOutpoint; // utxo - orphan vote hash set
 
-    std::map<uint256, CTxLockCandidate> mapTxLockCandidates; // tx hash - lock candidate
+    lock_candidates_t mapTxLockCandidates; // tx hash - lock candidate
 
-    std::map<COutPoint, std::set<uint256> > mapVotedOutpoints; // utxo - tx hash set
-    std::map<COutPoint, uint256> mapLockedOutpoints; // utxo - tx hash
+    outpoint_hashes_t mapVotedOutpoints; // utxo - tx hash set
+    locked_outpoints_t mapLockedOutpoints; // utxo - tx hash
 
     //track bznodes who voted with no txreq (for DOS protection)
-    std::map<COutPoint, int64_t> mapBznodeOrphanVotes; // mn outpoint - time
+    bznode_orphan_votes_t mapBznodeOrphanVotes; // mn outpoint - time
+
+    // lock input height - quorum, checked against the block hash and the bznode list on use
+    boost::unordered_map<int, lock_quorum_t> mapLockQuorums;
 
     bool CreateTxLockCandidate(const CTxLockRequest& txLockRequest);
     void Vote(CTxLockCandidate& txLockCandidate);
@@ -61,6 +84,8 @@ private:
     //process consensus vote message
     bool ProcessTxLockVote(CNode* pfrom, CTxLockVote& vote);
     void ProcessOrphanTxLockVotes();
+    void AddOrphanVote(const CTxLockVote& vote);
+    lock_votes_t::iterator EraseOrphanVote(lock_votes_t::iterator it);
     bool IsEnoughOrphanVotesForTx(const CTxLockRequest& txLockRequest);
     bool IsEnoughOrphanVotesForTxAndOutPoint(const uint256& txHash, const COutPoint& outpoint);
     int64_t GetAverageBznodeOrphanVoteTime();
@@ -91,6 +116,13 @@ public:
 
     bool GetLockedOutPointTxHash(const COutPoint& outpoint, uint256& hashRet);
 
+    /**
+     * Rank of a bznode among the ones allowed to vote on inputs locked at nLockInputHeight,
+     * -1 if it isn't one of them. The quorum of a height is computed once and reused
+     * until the block at that height or the bznode list changes.
+     */
+    int GetLockQuorumRank(const COutPoint& outpointBznode, int nLockInputHeight);
+
     // verify if transaction is currently locked
     bool IsLockedInstantSendTransaction(const uint256& txHash);
     // get the actual uber og accepted lock signatures
@@ -144,38 +144,69 @@ namespace libzerocoin {
 
         Bignum c = Bignum(hasher.GetHash()); //this hash should be of length k_prime bits
 
-        Bignum st_1_prime = (valueOfCommitmentToCoin.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sg.pow_mod(s_alpha, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_phi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_2_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) * ((valueOfCommitmentToCoin *
-                                                                                              sg.inverse(
-                                                                                                      params->accumulatorPoKCommitmentGroup.modulus)).pow_mod(
-                s_gamma, params->accumulatorPoKCommitmentGroup.modulus)) *
-                             sh.pow_mod(s_psi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_3_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             (sg * valueOfCommitmentToCoin).pow_mod(s_sigma,
-                                                                    params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_xi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-
-        Bignum t_1_prime =
-                (C_r.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_zeta, params->accumulatorModulus) *
-                 g_n.pow_mod(s_epsilon, params->accumulatorModulus)) % params->accumulatorModulus;
-        Bignum t_2_prime =
-                (C_e.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_eta, params->accumulatorModulus) *
-                 g_n.pow_mod(s_alpha, params->accumulatorModulus)) % params->accumulatorModulus;
-
-        Bignum t_3_prime = ((a.getValue()).pow_mod(c, params->accumulatorModulus) *
-                            C_u.pow_mod(s_alpha, params->accumulatorModulus) *
-                            ((h_n.inverse(params->accumulatorModulus)).pow_mod(s_beta, params->accumulatorModulus))) %
-                           params->accumulatorModulus;
-
-        Bignum t_4_prime = (C_r.pow_mod(s_alpha, params->accumulatorModulus) *
-                            ((h_n.inverse(params->accumulatorModulus)).pow_mod(s_delta, params->accumulatorModulus)) *
-                            ((g_n.inverse(params->accumulatorModulus)).pow_mod(s_beta, params->accumulatorModulus))) %
-                           params->accumulatorModulus;
+        // All products below are evaluated as multi-exponentiations in the cached
+        // Montgomery groups, with precomputed tables for g_n, h_n, sg and sh.
+        // (h^-1)^x is written as h^-x.
+        typedef MontgomeryGroup::FixedTerm FixedTerm;
+        typedef MontgomeryGroup::Term Term;
+        const AccumulatorProofGroups& groups = params->getProofGroups();
+        const MontgomeryGroup& pok = groups.pok;
+        const MontgomeryGroup& qrn = groups.qrn;
+
+        Bignum vInvSg = valueOfCommitmentToCoin.mul_mod(pok.getInverse(AccumulatorProofGroups::G), pok.getModulus());
+        Bignum vSg = valueOfCommitmentToCoin.mul_mod(sg, pok.getModulus());
+        Bignum minus_s_beta = s_beta * -1;
+        Bignum minus_s_delta = s_delta * -1;
+
+        std::vector<FixedTerm> fixedTerms;
+        std::vector<Term> terms;
+
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::G, s_alpha));
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, s_phi));
+        terms.push_back(Term(valueOfCommitmentToCoin, c));
+        Bignum st_1_prime = pok.multiExp(fixedTerms, terms);
+
+        fixedTerms.clear();
+        terms.clear();
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::G, c));
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, s_psi));
+        terms.push_back(Term(vInvSg, s_gamma));
+        Bignum st_2_prime = pok.multiExp(fixedTerms, terms);
+
+        fixedTerms.clear();
+        terms.clear();
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::G, c));
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, s_xi));
+        terms.push_back(Term(vSg, s_sigma));
+        Bignum st_3_prime = pok.multiExp(fixedTerms, terms);
+
+        fixedTerms.clear();
+        terms.clear();
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, s_zeta));
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::G, s_epsilon));
+        terms.push_back(Term(C_r, c));
+        Bignum t_1_prime = qrn.multiExp(fixedTerms, terms);
+
+        fixedTerms.clear();
+        terms.clear();
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, s_eta));
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::G, s_alpha));
+        terms.push_back(Term(C_e, c));
+        Bignum t_2_prime = qrn.multiExp(fixedTerms, terms);
+
+        fixedTerms.clear();
+        terms.clear();
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, minus_s_beta));
+        terms.push_back(Term(a.getValue(), c));
+        terms.push_back(Term(C_u, s_alpha));
+        Bignum t_3_prime = qrn.multiExp(fixedTerms, terms);
+
+        fixedTerms.clear();
+        terms.clear();
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::H, minus_s_delta));
+        fixedTerms.push_back(FixedTerm(AccumulatorProofGroups::G, minus_s_beta));
+        terms.push_back(Term(C_r, s_alpha));
+        Bignum t_4_prime = qrn.multiExp(fixedTerms, terms);
 
         bool result = false;
 
@@ -0,0 +1,145 @@
+/**
+* @file       MontgomeryGroup.cpp
+*
+* @brief      Cached Montgomery arithmetic and fixed-base exponentiation
+*             for the Zerocoin proof groups.
+*
+* @copyright  Copyright 2018 The Bitcoinzero Core developers
+* @license    This project is released under the MIT license.
+**/
+#include "Zerocoin.h"
+
+namespace libzerocoin {
+
+MontgomeryGroup::MontgomeryGroup(const CBigNum& modulusIn) : modulus(modulusIn) {
+	CAutoBN_CTX ctx;
+	mont = BN_MONT_CTX_new();
+	if (mont == NULL)
+		throw bignum_error("MontgomeryGroup : BN_MONT_CTX_new failed");
+	if (!BN_MONT_CTX_set(mont, &modulus, ctx)) {
+		BN_MONT_CTX_free(mont);
+		throw bignum_error("MontgomeryGroup : BN_MONT_CTX_set failed");
+	}
+	CBigNum one = 1;
+	if (!BN_to_montgomery(&montOne, &one, mont, ctx)) {
+		BN_MONT_CTX_free(mont);
+		throw bignum_error("MontgomeryGroup : BN_to_montgomery failed");
+	}
+}
+
+MontgomeryGroup::~MontgomeryGroup() {
+	BN_MONT_CTX_free(mont);
+}
+
+void MontgomeryGroup::mulMont(CBigNum& r, const CBigNum& a, const CBigNum& b, BN_CTX* ctx) const {
+	if (!BN_mod_mul_montgomery(&r, &a, &b, mont, ctx))
+		throw bignum_error("MontgomeryGroup::mulMont : BN_mod_mul_montgomery failed");
+}
+
+void MontgomeryGroup::buildPowers(const CBigNum& base, unsigned int nDigits, std::vector<CBigNum>& powers, BN_CTX* ctx) const {
+	powers.resize(nDigits);
+	CBigNum reduced = base % modulus;
+	if (!BN_to_montgomery(&powers[0], &reduced, mont, ctx))
+		throw bignum_error("MontgomeryGroup::buildPowers : BN_to_montgomery failed");
+	for (unsigned int i = 1; i < nDigits; i++) {
+		powers[i] = powers[i - 1];
+		for (int j = 0; j < WINDOW_BITS; j++)
+			mulMont(powers[i], powers[i], powers[i], ctx);
+	}
+}
+
+int MontgomeryGroup::addFixedBase(const CBigNum& base, unsigned int nMaxExponentBits) {
+	CAutoBN_CTX ctx;
+	unsigned int nDigits = (nMaxExponentBits + WINDOW_BITS - 1) / WINDOW_BITS;
+	if (nDigits == 0)
+		nDigits = 1;
+
+	FixedBase fixedBase;
+	fixedBase.base = base;
+	fixedBase.inverse = base.inverse(modulus);
+	buildPowers(fixedBase.base, nDigits, fixedBase.powers, ctx);
+	buildPowers(fixedBase.inverse, nDigits, fixedBase.inversePowers, ctx);
+	fixedBases.push_back(fixedBase);
+	return fixedBases.size() - 1;
+}
+
+void MontgomeryGroup::mulPowGeneric(CBigNum& acc, const CBigNum& base, const CBigNum& exponent, BN_CTX* ctx) const {
+	CBigNum r;
+	if (exponent < 0) {
+		// g^-x = (g^-1)^x
+		CBigNum inv = base.inverse(modulus);
+		CBigNum posE = exponent * -1;
+		if (!BN_mod_exp_mont(&r, &inv, &posE, &modulus, ctx, mont))
+			throw bignum_error("MontgomeryGroup::mulPowGeneric : BN_mod_exp_mont failed on negative exponent");
+	} else if (!BN_mod_exp_mont(&r, &base, &exponent, &modulus, ctx, mont)) {
+		throw bignum_error("MontgomeryGroup::mulPowGeneric : BN_mod_exp_mont failed");
+	}
+	if (!BN_to_montgomery(&r, &r, mont, ctx))
+		throw bignum_error("MontgomeryGroup::mulPowGeneric : BN_to_montgomery failed");
+	mulMont(acc, acc, r, ctx);
+}
+
+CBigNum MontgomeryGroup::multiExp(const std::vector<FixedTerm>& fixedTerms, const std::vector<Term>& terms) const {
+	CAutoBN_CTX ctx;
+	CBigNum acc = montOne;
+
+	// Yao's method over all fixed-base terms together: split every exponent
+	// into WINDOW_BITS digits d_i and collect the table entries by digit value,
+	// then prod_d (prod_{d_i >= d} powers[i]) = prod_i powers[i]^d_i.
+	std::vector<std::vector<const CBigNum*> > buckets(1 << WINDOW_BITS);
+	for (std::vector<FixedTerm>::const_iterator it = fixedTerms.begin(); it != fixedTerms.end(); ++it) {
+		const FixedBase& fixedBase = fixedBases[it->nBase];
+		const CBigNum& exponent = *it->exponent;
+		// the digits are taken from the magnitude, the sign selects the table
+		const std::vector<CBigNum>& powers = exponent < 0 ? fixedBase.inversePowers : fixedBase.powers;
+		unsigned int nBits = BN_num_bits(&exponent);
+		if (nBits > powers.size() * WINDOW_BITS) {
+			mulPowGeneric(acc, fixedBase.base, exponent, ctx);
+			continue;
+		}
+		for (unsigned int i = 0; i * WINDOW_BITS < nBits; i++) {
+			int nDigit = 0;
+			for (int j = WINDOW_BITS - 1; j >= 0; j--)
+				nDigit = (nDigit << 1) | BN_is_bit_set(&exponent, i * WINDOW_BITS + j);
+			if (nDigit != 0)
+				buckets[nDigit].push_back(std::addressof(powers[i]));
+		}
+	}
+
+	CBigNum a, b;
+	bool fHaveA = false, fHaveB = false;
+	for (int nDigit = (1 << WINDOW_BITS) - 1; nDigit > 0; nDigit--) {
+		for (std::vector<const CBigNum*>::const_iterator it = buckets[nDigit].begin(); it != buckets[nDigit].end(); ++it) {
+			if (fHaveB)
+				mulMont(b, b, **it, ctx);
+			else
+				b = **it;
+			fHaveB = true;
+		}
+		if (!fHaveB)
+			continue;
+		if (fHaveA)
+			mulMont(a, a, b, ctx);
+		else
+			a = b;
+		fHaveA = true;
+	}
+	if (fHaveA)
+		mulMont(acc, acc, a, ctx);
+
+	for (std::vector<Term>::const_iterator it = terms.begin(); it != terms.end(); ++it)
+		mulPowGeneric(acc, *it->base, *it->exponent, ctx);
+
+	CBigNum result;
+	if (!BN_from_montgomery(&result, &acc, mont, ctx))
+		throw bignum_error("MontgomeryGroup::multiExp : BN_from_montgomery failed");
+	return result;
+}
+
+CBigNum MontgomeryGroup::pow(int nBase, const CBigNum& exponent) const {
+	std::vector<FixedTerm> fixedTerms;
+	fixedTerms.push_back(FixedTerm(nBase, exponent));
+	return multiExp(fixedTerms);
+}
+
+} /* namespace libzerocoin */
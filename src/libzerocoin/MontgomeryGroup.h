@@ -0,0 +1,105 @@
+/**
+* @file       MontgomeryGroup.h
+*
+* @brief      Cached Montgomery arithmetic and fixed-base exponentiation
+*             for the Zerocoin proof groups.
+*
+* @copyright  Copyright 2018 The Bitcoinzero Core developers
+* @license    This project is released under the MIT license.
+**/
+#ifndef MONTGOMERYGROUP_H_
+#define MONTGOMERYGROUP_H_
+
+#include "Zerocoin.h"
+
+#include <memory>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace libzerocoin {
+
+/** Modular arithmetic for one fixed odd modulus.
+ *
+ * Keeps the Montgomery context for the modulus so that it is not rebuilt by
+ * every exponentiation, and tables of powers base^(2^(w*i)) for the bases
+ * that are raised to many different exponents (the group generators). A
+ * product of several powers is evaluated as one multi-exponentiation: the
+ * fixed-base terms with Yao's method, which costs about one multiplication
+ * per w exponent bits and no squarings, and the remaining terms with the
+ * cached Montgomery context.
+ *
+ * Tables are read-only once built so a group can be shared between threads.
+ */
+class MontgomeryGroup : private boost::noncopyable {
+public:
+	/** A term base^exponent with base one of the fixed bases
+	 *  (std::addressof because CBigNum overloads operator&) */
+	struct FixedTerm {
+		int nBase;
+		const CBigNum* exponent;
+		FixedTerm(int nBaseIn, const CBigNum& exponentIn) : nBase(nBaseIn), exponent(std::addressof(exponentIn)) {}
+	};
+
+	/** A term base^exponent with an arbitrary base */
+	struct Term {
+		const CBigNum* base;
+		const CBigNum* exponent;
+		Term(const CBigNum& baseIn, const CBigNum& exponentIn) : base(std::addressof(baseIn)), exponent(std::addressof(exponentIn)) {}
+	};
+
+	/** @param modulus an odd modulus */
+	explicit MontgomeryGroup(const CBigNum& modulus);
+	~MontgomeryGroup();
+
+	/** Precomputes powers of base and of its inverse.
+	 *
+	 * @param base an element invertible modulo the modulus
+	 * @param nMaxExponentBits exponents up to this size use the tables,
+	 *        larger ones still work but take the generic path
+	 * @return the index to use in FixedTerm
+	 */
+	int addFixedBase(const CBigNum& base, unsigned int nMaxExponentBits);
+
+	/** @return base^-1 mod modulus for a fixed base */
+	const CBigNum& getInverse(int nBase) const { return fixedBases[nBase].inverse; }
+
+	const CBigNum& getModulus() const { return modulus; }
+
+	/** Computes the product of all terms modulo the modulus. Negative
+	 * exponents are allowed and raise the inverse of the base.
+	 *
+	 * @throws bignum_error if a base with a negative exponent is not invertible
+	 */
+	CBigNum multiExp(const std::vector<FixedTerm>& fixedTerms, const std::vector<Term>& terms = std::vector<Term>()) const;
+
+	/** @return base^exponent mod modulus */
+	CBigNum pow(int nBase, const CBigNum& exponent) const;
+
+private:
+	/** Exponent digit size for the fixed-base tables */
+	static const int WINDOW_BITS = 5;
+
+	struct FixedBase {
+		CBigNum base;
+		CBigNum inverse;
+		// powers[i] = base^(2^(WINDOW_BITS*i)) in Montgomery form, same for the inverse
+		std::vector<CBigNum> powers;
+		std::vector<CBigNum> inversePowers;
+	};
+
+	CBigNum modulus;
+	BN_MONT_CTX* mont;
+	// 1 in Montgomery form
+	CBigNum montOne;
+	std::vector<FixedBase> fixedBases;
+
+	void buildPowers(const CBigNum& base, unsigned int nDigits, std::vector<CBigNum>& powers, BN_CTX* ctx) const;
+	void mulMont(CBigNum& r, const CBigNum& a, const CBigNum& b, BN_CTX* ctx) const;
+	/** Multiplies acc (Montgomery form) by base^exponent computed without the tables */
+	void mulPowGeneric(CBigNum& acc, const CBigNum& base, const CBigNum& exponent, BN_CTX* ctx) const;
+};
+
+} /* namespace libzerocoin */
+
+#endif /* MONTGOMERYGROUP_H_ */
@@ -11,6 +11,9 @@
 **/
 #include "Zerocoin.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
 namespace libzerocoin {
 
 Params::Params(CBigNum N, CBigNum Nseed, uint32_t securityLevel) {
@@ -27,10 +30,39 @@ Params::Params(CBigNum N, CBigNum Nseed, uint32_t securityLevel) {
 	this->initialized = true;
 }
 
+Params::Params() {
+	this->initialized = false;
+}
+
 AccumulatorAndProofParams::AccumulatorAndProofParams() {
 	this->initialized = false;
 }
 
+static boost::mutex cs_proofGroups;
+
+const AccumulatorProofGroups& AccumulatorAndProofParams::getProofGroups() const {
+	boost::lock_guard<boost::mutex> lock(cs_proofGroups);
+	if (!proofGroups)
+		proofGroups.reset(new AccumulatorProofGroups(*this));
+	return *proofGroups;
+}
+
+AccumulatorProofGroups::AccumulatorProofGroups(const AccumulatorAndProofParams& params)
+	: qrn(params.accumulatorModulus), pok(params.accumulatorPoKCommitmentGroup.modulus) {
+	// Upper bounds on the exponents of honest proofs, see the s_* values in
+	// AccumulatorProofOfKnowledge. Larger exponents still verify, just slower.
+	unsigned int nChallengeBits = 256;
+	unsigned int nCoinBits = std::max(params.maxCoinValue.bitSize(), params.accumulatorPoKCommitmentGroup.modulus.bitSize());
+	unsigned int nQRNExponentBits = params.accumulatorModulus.bitSize() + nCoinBits + nChallengeBits +
+			params.k_prime + params.k_dprime + 2;
+	unsigned int nPoKExponentBits = 2 * nCoinBits + nChallengeBits + params.k_prime + params.k_dprime + 2;
+
+	qrn.addFixedBase(params.accumulatorQRNCommitmentGroup.g, nQRNExponentBits);
+	qrn.addFixedBase(params.accumulatorQRNCommitmentGroup.h, nQRNExponentBits);
+	pok.addFixedBase(params.accumulatorPoKCommitmentGroup.g, nPoKExponentBits);
+	pok.addFixedBase(params.accumulatorPoKCommitmentGroup.h, nPoKExponentBits);
+}
+
 IntegerGroupParams::IntegerGroupParams() {
 	this->initialized = false;
 }
@@ -13,8 +13,29 @@
 #define PARAMS_H_
 #include "Zerocoin.h"
 
+#include <boost/shared_ptr.hpp>
+
 namespace libzerocoin {
 
+class AccumulatorAndProofParams;
+
+/**
+ * The groups of the accumulator proof of knowledge with their
+ * generators g and h registered as fixed bases.
+ */
+class AccumulatorProofGroups {
+public:
+	explicit AccumulatorProofGroups(const AccumulatorAndProofParams& params);
+
+	enum { G = 0, H = 1 };
+
+	/** Quadratic residues mod the accumulator modulus */
+	MontgomeryGroup qrn;
+
+	/** accumulatorPoKCommitmentGroup */
+	MontgomeryGroup pok;
+};
+
 class IntegerGroupParams {
 public:
 	/** @brief Integer group class, default constructor
@@ -138,10 +159,20 @@ public:
 	 * The statistical zero-knowledgeness of the accumulator proof.
 	 */
 	uint32_t k_dprime;
+
+	/**
+	 * Montgomery contexts and generator tables for the two groups
+	 * of the accumulator proof. Built on first use and not serialized.
+	 */
+	const AccumulatorProofGroups& getProofGroups() const;
+
 	ADD_SERIALIZE_METHODS;
 
 	template <typename Stream, typename Operation>
 	inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+		if (ser_action.ForRead()) {
+			proofGroups.reset();
+		}
 		READWRITE(initialized);
 		READWRITE(accumulatorModulus);
 		READWRITE(accumulatorBase);
@@ -152,6 +183,9 @@ public:
 		READWRITE(k_prime);
 		READWRITE(k_dprime);
 	};
+
+private:
+	mutable boost::shared_ptr<AccumulatorProofGroups> proofGroups;
 };
 
 class Params {
@@ -175,6 +209,11 @@ public:
 	**/
     Params(CBigNum accumulatorModulus, CBigNum Nseed, uint32_t securityLevel = ZEROCOIN_DEFAULT_SECURITYLEVEL);
 
+	/** @brief Allocates an empty (uninitialized) set of parameters
+	 * to be deserialized into, e.g. from precomputed values.
+	 **/
+	Params();
+
 	bool initialized;
 
 	AccumulatorAndProofParams accumulatorParams;
@@ -63,6 +63,7 @@ namespace libzerocoin {
 #include "../serialize.h"
 #include "bitcoin_bignum/bignum.h"
 #include "../hash.h"
+#include "MontgomeryGroup.h"
 #include "Params.h"
 #include "Coin.h"
 #include "Commitment.h"
@@ -0,0 +1,80 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "../Zerocoin.h"
+
+#include <algorithm>
+
+#include <boost/thread/tss.hpp>
+
+// thread_specific_ptr frees the contexts automatically when the thread ends.
+static boost::thread_specific_ptr<CBigNumThreadContext> threadContext;
+
+CBigNumThreadContext& CBigNumThreadContext::Get()
+{
+    CBigNumThreadContext* context = threadContext.get();
+    if (context == NULL) {
+        context = new CBigNumThreadContext();
+        threadContext.reset(context);
+    }
+    return *context;
+}
+
+CBigNumThreadContext::~CBigNumThreadContext()
+{
+    for (size_t i = 0; i < vFreeCtx.size(); i++)
+        BN_CTX_free(vFreeCtx[i]);
+    for (size_t i = 0; i < vMontCtx.size(); i++) {
+        BN_free(vMontCtx[i].first);
+        BN_MONT_CTX_free(vMontCtx[i].second);
+    }
+}
+
+BN_CTX* CBigNumThreadContext::AcquireCtx()
+{
+    if (vFreeCtx.empty()) {
+        BN_CTX* ctx = BN_CTX_new();
+        if (ctx == NULL)
+            throw bignum_error("CBigNumThreadContext::AcquireCtx : BN_CTX_new() returned NULL");
+        return ctx;
+    }
+    BN_CTX* ctx = vFreeCtx.back();
+    vFreeCtx.pop_back();
+    return ctx;
+}
+
+void CBigNumThreadContext::ReleaseCtx(BN_CTX* ctx)
+{
+    if (vFreeCtx.size() < MAX_FREE_CTX)
+        vFreeCtx.push_back(ctx);
+    else
+        BN_CTX_free(ctx);
+}
+
+BN_MONT_CTX* CBigNumThreadContext::GetMontCtx(const BIGNUM* modulus, BN_CTX* ctx)
+{
+    for (size_t i = 0; i < vMontCtx.size(); i++) {
+        if (BN_cmp(vMontCtx[i].first, modulus) == 0) {
+            // keep the most recently used moduli in front
+            std::rotate(vMontCtx.begin(), vMontCtx.begin() + i, vMontCtx.begin() + i + 1);
+            return vMontCtx[0].second;
+        }
+    }
+
+    BIGNUM* modulusCopy = BN_dup(modulus);
+    BN_MONT_CTX* mont = BN_MONT_CTX_new();
+    if (modulusCopy == NULL || mont == NULL || !BN_MONT_CTX_set(mont, modulus, ctx)) {
+        BN_free(modulusCopy);
+        BN_MONT_CTX_free(mont);
+        throw bignum_error("CBigNumThreadContext::GetMontCtx : BN_MONT_CTX_set failed");
+    }
+
+    if (vMontCtx.size() == MAX_MONT_CTX) {
+        BN_free(vMontCtx.back().first);
+        BN_MONT_CTX_free(vMontCtx.back().second);
+        vMontCtx.pop_back();
+    }
+    vMontCtx.insert(vMontCtx.begin(), std::make_pair(modulusCopy, mont));
+    return mont;
+}
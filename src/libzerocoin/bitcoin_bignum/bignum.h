@@ -6,6 +6,7 @@
 #define BITCOIN_BIGNUM_H
 
 #include <stdexcept>
+#include <utility>
 #include <vector>
 #include <openssl/bn.h>
 
@@ -20,7 +21,39 @@ public:
     explicit bignum_error(const std::string& str) : std::runtime_error(str) {}
 };
 
-/** RAII encapsulated BN_CTX (OpenSSL bignum context) */
+/**
+ * BN_CTX and BN_MONT_CTX objects of the calling thread. Contexts are handed
+ * out again after use instead of being allocated for every operation, and the
+ * Montgomery contexts of the last moduli are kept for modular exponentiation.
+ */
+class CBigNumThreadContext
+{
+public:
+    /** Returns the pool of the calling thread, created on first use */
+    static CBigNumThreadContext& Get();
+
+    ~CBigNumThreadContext();
+
+    /** Takes a context from the pool, or allocates one if it is empty */
+    BN_CTX* AcquireCtx();
+    /** Returns a context taken with AcquireCtx() to the pool */
+    void ReleaseCtx(BN_CTX* ctx);
+
+    /** Returns the Montgomery context of an odd modulus, owned by the pool */
+    BN_MONT_CTX* GetMontCtx(const BIGNUM* modulus, BN_CTX* ctx);
+
+private:
+    /** Number of BN_CTX kept for reuse, more are freed on release */
+    static const size_t MAX_FREE_CTX = 16;
+    /** Number of moduli whose Montgomery context is kept */
+    static const size_t MAX_MONT_CTX = 8;
+
+    std::vector<BN_CTX*> vFreeCtx;
+    /** Most recently used first */
+    std::vector<std::pair<BIGNUM*, BN_MONT_CTX*> > vMontCtx;
+};
+
+/** RAII encapsulated BN_CTX (OpenSSL bignum context) from the thread's pool */
 class CAutoBN_CTX
 {
 protected:
@@ -30,15 +63,13 @@ protected:
 public:
     CAutoBN_CTX()
     {
-        pctx = BN_CTX_new();
-        if (pctx == NULL)
-            throw bignum_error("CAutoBN_CTX : BN_CTX_new() returned NULL");
+        pctx = CBigNumThreadContext::Get().AcquireCtx();
     }
 
     ~CAutoBN_CTX()
     {
         if (pctx != NULL)
-            BN_CTX_free(pctx);
+            CBigNumThreadContext::Get().ReleaseCtx(pctx);
     }
 
     operator BN_CTX*() { return pctx; }
@@ -74,6 +105,19 @@ public:
         }
     }
 
+    /** The moved-from number is left as zero */
+    CBigNum(CBigNum&& b) noexcept : bn(b.bn)
+    {
+        b.init();
+    }
+
+    /** The moved-from number gets the previous value of this one */
+    CBigNum& operator=(CBigNum&& b) noexcept
+    {
+        std::swap(bn, b.bn);
+        return *this;
+    }
+
     CBigNum& operator=(const CBigNum& b)
     {
         if (!BN_copy(bn, &b))
@@ -541,14 +585,16 @@ public:
     CBigNum pow_mod(const CBigNum& e, const CBigNum& m) const {
         CAutoBN_CTX pctx;
         CBigNum ret;
+        // odd moduli use the Montgomery context cached for the thread
+        BN_MONT_CTX* mont = BN_is_odd(&m) ? CBigNumThreadContext::Get().GetMontCtx(&m, pctx) : NULL;
         if( e < 0){
             // g^-x = (g^-1)^x
             CBigNum inv = this->inverse(m);
             CBigNum posE = e * -1;
-            if (!BN_mod_exp(&ret, &inv, &posE, &m, pctx))
+            if (!(mont ? BN_mod_exp_mont(&ret, &inv, &posE, &m, pctx, mont) : BN_mod_exp(&ret, &inv, &posE, &m, pctx)))
                 throw bignum_error("CBigNum::pow_mod: BN_mod_exp failed on negative exponent");
         }else
-        if (!BN_mod_exp(&ret, bn, &e, &m, pctx))
+        if (!(mont ? BN_mod_exp_mont(&ret, bn, &e, &m, pctx, mont) : BN_mod_exp(&ret, bn, &e, &m, pctx)))
             throw bignum_error("CBigNum::pow_mod : BN_mod_exp failed");
 
         return ret;
@@ -686,7 +732,7 @@ public:
         return *this;
     }
 
-    const CBigNum operator++(int)
+    CBigNum operator++(int)
     {
         // postfix operator
         const CBigNum ret = *this;
@@ -704,7 +750,7 @@ public:
         return *this;
     }
 
-    const CBigNum operator--(int)
+    CBigNum operator--(int)
     {
         // postfix operator
         const CBigNum ret = *this;
@@ -719,17 +765,17 @@ public:
     }
 
 
-    friend inline const CBigNum operator-(const CBigNum& a, const CBigNum& b);
-    friend inline const CBigNum operator/(const CBigNum& a, const CBigNum& b);
-    friend inline const CBigNum operator%(const CBigNum& a, const CBigNum& b);
-    friend inline const CBigNum operator*(const CBigNum& a, const CBigNum& b);
+    friend inline CBigNum operator-(const CBigNum& a, const CBigNum& b);
+    friend inline CBigNum operator/(const CBigNum& a, const CBigNum& b);
+    friend inline CBigNum operator%(const CBigNum& a, const CBigNum& b);
+    friend inline CBigNum operator*(const CBigNum& a, const CBigNum& b);
     friend inline bool operator<(const CBigNum& a, const CBigNum& b);
 
 };
 
 
 
-inline const CBigNum operator+(const CBigNum& a, const CBigNum& b)
+inline CBigNum operator+(const CBigNum& a, const CBigNum& b)
 {
     CBigNum r;
     if (!BN_add(&r, &a, &b))
@@ -737,7 +783,7 @@ inline const CBigNum operator+(const CBigNum& a, const CBigNum& b)
     return r;
 }
 
-inline const CBigNum operator-(const CBigNum& a, const CBigNum& b)
+inline CBigNum operator-(const CBigNum& a, const CBigNum& b)
 {
     CBigNum r;
     if (!BN_sub(&r, &a, &b))
@@ -745,14 +791,14 @@ inline const CBigNum operator-(const CBigNum& a, const CBigNum& b)
     return r;
 }
 
-inline const CBigNum operator-(const CBigNum& a)
+inline CBigNum operator-(const CBigNum& a)
 {
     CBigNum r(a);
     BN_set_negative(&r, !BN_is_negative(&r));
     return r;
 }
 
-inline const CBigNum operator*(const CBigNum& a, const CBigNum& b)
+inline CBigNum operator*(const CBigNum& a, const CBigNum& b)
 {
     CAutoBN_CTX pctx;
     CBigNum r;
@@ -761,7 +807,7 @@ inline const CBigNum operator*(const CBigNum& a, const CBigNum& b)
     return r;
 }
 
-inline const CBigNum operator/(const CBigNum& a, const CBigNum& b)
+inline CBigNum operator/(const CBigNum& a, const CBigNum& b)
 {
     CAutoBN_CTX pctx;
     CBigNum r;
@@ -770,7 +816,7 @@ inline const CBigNum operator/(const CBigNum& a, const CBigNum& b)
     return r;
 }
 
-inline const CBigNum operator%(const CBigNum& a, const CBigNum& b)
+inline CBigNum operator%(const CBigNum& a, const CBigNum& b)
 {
     CAutoBN_CTX pctx;
     CBigNum r;
@@ -779,7 +825,7 @@ inline const CBigNum operator%(const CBigNum& a, const CBigNum& b)
     return r;
 }
 
-inline const CBigNum operator<<(const CBigNum& a, unsigned int shift)
+inline CBigNum operator<<(const CBigNum& a, unsigned int shift)
 {
     CBigNum r;
     if (!BN_lshift(&r, &a, shift))
@@ -787,7 +833,7 @@ inline const CBigNum operator<<(const CBigNum& a, unsigned int shift)
     return r;
 }
 
-inline const CBigNum operator>>(const CBigNum& a, unsigned int shift)
+inline CBigNum operator>>(const CBigNum& a, unsigned int shift)
 {
     CBigNum r = a;
     r >>= shift;
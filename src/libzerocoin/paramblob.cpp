@@ -0,0 +1,127 @@
+/**
+ * @file       paramblob.cpp
+ *
+ * @brief      Precomputed parameter export utility for Zerocoin.
+ *
+ * Derives the Zerocoin parameters for the trusted moduli in
+ * zerocoin_params.h and writes them, serialized, as the compiled-in
+ * blobs of zerocoin_params_blob.h. Run it again whenever a modulus,
+ * the security level or the parameter derivation changes:
+ *
+ *   paramblob -o zerocoin_params_blob.h
+ *
+ * It is not part of the regular build, compile it against the sources
+ * of libzerocoin, libbitcoin_crypto and the hash, uint256 and string
+ * helpers of libbitcoin_util.
+ *
+ * @copyright  Copyright 2018 The Bitcoinzero Core developers
+ * @license    This project is released under the MIT license.
+ **/
+
+using namespace std;
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <exception>
+#include "Zerocoin.h"
+#include "../clientversion.h"
+#include "../hash.h"
+#include "../streams.h"
+#include "../utilstrencodings.h"
+#include "../zerocoin_params.h"
+
+// "Zerocoin.h" includes ../util.h, which redefines printf
+#undef printf
+
+#define HEX_LINE_LENGTH         128
+
+using namespace libzerocoin;
+
+void usage()
+{
+	printf("Usage:\n");
+	printf(" -o <output file>\n");
+
+	exit (8);
+}
+
+static void
+WriteBlob(ostream& out, const string& name, const CBigNum& modulus, const CBigNum& seed)
+{
+	cout << "Deriving " << name << "..." << endl;
+	Params params(modulus, seed);
+
+	CDataStream ss(SER_DISK, CLIENT_VERSION);
+	ss << params;
+	vector<unsigned char> blob(ss.begin(), ss.end());
+
+	// Make sure the blob reads back into the same parameters
+	Params check;
+	CDataStream(blob, SER_DISK, CLIENT_VERSION) >> check;
+	CDataStream ssCheck(SER_DISK, CLIENT_VERSION);
+	ssCheck << check;
+	if (vector<unsigned char>(ssCheck.begin(), ssCheck.end()) != blob)
+		throw runtime_error(name + " does not survive a serialization round trip");
+
+	string hex = HexStr(blob);
+	out << "static const char " << name << "[] =" << endl;
+	for (size_t i = 0; i < hex.size(); i += HEX_LINE_LENGTH)
+		out << "    \"" << hex.substr(i, HEX_LINE_LENGTH) << "\"" << (i + HEX_LINE_LENGTH < hex.size() ? "" : ";") << endl;
+	out << "static const char " << name << "_HASH[] = \"" << Hash(blob.begin(), blob.end()).GetHex() << "\";" << endl << endl;
+}
+
+int main(int argc, char **argv)
+{
+	ofstream outfile;
+	char* outfileName = NULL;
+
+	while ((argc > 1) && (argv[1][0] == '-'))
+	{
+		switch (argv[1][1])
+		{
+		case 'o':
+			outfileName = argv[2];
+			++argv;
+			--argc;
+			break;
+
+		case 'h':
+			usage();
+			break;
+
+		default:
+			printf("Wrong Argument: %s\n", argv[1]);
+			usage();
+			break;
+		}
+
+		++argv;
+		--argc;
+	}
+
+	if (outfileName == NULL)
+		usage();
+
+	try {
+		CBigNum modulus(ZEROCOIN_MODULUS), modulusV2(ZEROCOIN_MODULUS_V2);
+
+		outfile.exceptions(ofstream::failbit | ofstream::badbit);
+		outfile.open(outfileName);
+		outfile << "// Generated by libzerocoin/paramblob, do not edit." << endl;
+		outfile << "// Serialized libzerocoin::Params for the moduli in zerocoin_params.h and" << endl;
+		outfile << "// the double SHA256 of every blob." << endl << endl;
+		outfile << "#ifndef ZEROCOIN_PARAMS_BLOB_H" << endl;
+		outfile << "#define ZEROCOIN_PARAMS_BLOB_H" << endl << endl;
+		WriteBlob(outfile, "ZEROCOIN_PARAMS_BLOB", modulus, modulus);
+		WriteBlob(outfile, "ZEROCOIN_PARAMS_V2_BLOB", modulusV2, modulus);
+		outfile << "#endif // ZEROCOIN_PARAMS_BLOB_H" << endl;
+		outfile.close();
+	} catch (std::exception &e) {
+		cout << "Unable to write the parameters: " << e.what() << endl;
+		return 1;
+	}
+
+	cout << "Result has been written to file '" << outfileName << "'." << endl;
+	return 0;
+}
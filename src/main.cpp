@@ -19,6 +19,7 @@
 #include "init.h"
 #include "base58.h"
 #include "merkleblock.h"
+#include "messagedispatch.h"
 #include "net.h"
 #include "policy/fees.h"
 #include "policy/policy.h"
@@ -49,6 +50,7 @@
 #include "bznode-payments.h"
 #include "bznode-sync.h"
 #include "bznodeman.h"
+#include "spork.h"
 #include "coins.h"
 
 #include <atomic>
@@ -57,6 +59,7 @@
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/math/distributions/poisson.hpp>
@@ -81,6 +84,8 @@ int64_t nTimeBestReceived = 0;
 CWaitableCriticalSection csBestBlock;
 CConditionVariable cvBlockChange;
 int nScriptCheckThreads = 0;
+int nHeaderCheckThreads = 0;
+int nSpendCheckThreads = 0;
 bool fImporting = false;
 bool fReindex = false;
 bool fTxIndex = false;
@@ -703,7 +708,42 @@ bool GetBlockHash(uint256 &hashRet, int nBlockHeight) {
     return true;
 }
 
+/**
+ * Routes the messages of the bznode, PrivateSend, InstantSend, spork and sync extensions.
+ * Bznode payment votes are processed by the message workers, their handler only takes
+ * cs_main for short lookups. Broadcasts and pings hold cs_main while they are checked.
+ */
+static void RegisterExtensionMessageHandlers() {
+    CMessageDispatcher::Handler darksendHandler = boost::bind(&CDarksendPool::ProcessMessage, &darkSendPool, _1, _2, _3);
+    messageDispatcher.RegisterHandler(NetMsgType::DSACCEPT, darksendHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSQUEUE, darksendHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSVIN, darksendHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSSTATUSUPDATE, darksendHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSSIGNFINALTX, darksendHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSFINALTX, darksendHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSCOMPLETE, darksendHandler);
+
+    CMessageDispatcher::Handler bznodeHandler = boost::bind(&CBznodeMan::ProcessMessage, &mnodeman, _1, _2, _3);
+    messageDispatcher.RegisterHandler(NetMsgType::MNANNOUNCE, bznodeHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::MNPING, bznodeHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::DSEG, bznodeHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::MNVERIFY, bznodeHandler);
+
+    CMessageDispatcher::Handler paymentsHandler = boost::bind(&CBznodePayments::ProcessMessage, &mnpayments, _1, _2, _3);
+    messageDispatcher.RegisterHandler(NetMsgType::BZNODEPAYMENTSYNC, paymentsHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::BZNODEPAYMENTVOTE, paymentsHandler, true);
+
+    messageDispatcher.RegisterHandler(NetMsgType::TXLOCKVOTE, boost::bind(&CInstantSend::ProcessMessage, &instantsend, _1, _2, _3));
+
+    CMessageDispatcher::Handler sporkHandler = boost::bind(&CSporkManager::ProcessSpork, &sporkManager, _1, _2, _3);
+    messageDispatcher.RegisterHandler(NetMsgType::SPORK, sporkHandler);
+    messageDispatcher.RegisterHandler(NetMsgType::GETSPORKS, sporkHandler);
+
+    messageDispatcher.RegisterHandler(NetMsgType::SYNCSTATUSCOUNT, boost::bind(&CBznodeSync::ProcessMessage, &bznodeSync, _1, _2, _3));
+}
+
 void RegisterNodeSignals(CNodeSignals &nodeSignals) {
+    RegisterExtensionMessageHandlers();
     nodeSignals.GetHeight.connect(&GetHeight);
     nodeSignals.ProcessMessages.connect(&ProcessMessages);
     nodeSignals.SendMessages.connect(&SendMessages);
@@ -717,6 +757,7 @@ void UnregisterNodeSignals(CNodeSignals &nodeSignals) {
     nodeSignals.SendMessages.disconnect(&SendMessages);
     nodeSignals.InitializeNode.disconnect(&InitializeNode);
     nodeSignals.FinalizeNode.disconnect(&FinalizeNode);
+    messageDispatcher.UnregisterAllHandlers();
 }
 
 CBlockIndex *FindForkInGlobalIndex(const CChain &chain, const CBlockLocator &locator) {
@@ -1844,7 +1885,7 @@ bool WriteBlockToDisk(const CBlock &block, CDiskBlockPos &pos, const CMessageHea
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+static bool ReadBlockDataFromDisk(CBlock &block, const CDiskBlockPos &pos) {
     block.SetNull();
 
     // Open history file to read
@@ -1859,6 +1900,22 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, con
     catch (const std::exception &e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
+    return true;
+}
+
+/** Remember the verified PoW hash of a block index entry so that later reads of the block skip Lyra2Z. */
+static void SetBlockIndexPoWHash(CBlockIndex *pindex, const uint256 &hashPoW) {
+    AssertLockHeld(cs_main);
+    if (pindex->nStatus & BLOCK_HAVE_POWHASH)
+        return;
+    pindex->hashPoW = hashPoW;
+    pindex->nStatus |= BLOCK_HAVE_POWHASH;
+    setDirtyBlockIndex.insert(pindex);
+}
+
+bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+    if (!ReadBlockDataFromDisk(block, pos))
+        return false;
     // Check the header
     if (!CheckProofOfWork(block.GetPoWHash(nHeight), block.nBits, consensusParams))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
@@ -1866,12 +1923,29 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, con
 }
 
 bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams) {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams))
+    if (!ReadBlockDataFromDisk(block, pindex->GetBlockPos()))
         return false;
     if (block.GetHash() != pindex->GetBlockHash()) {
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
                      pindex->ToString(), pindex->GetBlockPos().ToString());
     }
+    // The header matches an index entry whose proof of work was already verified,
+    // so the memory-hard hash only has to be computed once per block.
+    if (pindex->nStatus & BLOCK_HAVE_POWHASH)
+        return true;
+
+    uint256 hashPoW = block.GetPoWHash(pindex->nHeight);
+    if (!CheckProofOfWork(hashPoW, block.nBits, consensusParams))
+        return error("ReadBlockFromDisk: Errors in block header at %s", pindex->GetBlockPos().ToString());
+
+    // Entries created before the cache existed are filled in lazily. Callers do not
+    // always hold cs_main, in which case the hash is simply computed again next time.
+    TRY_LOCK(cs_main, lockMain);
+    if (lockMain) {
+        BlockMap::iterator mi = mapBlockIndex.find(pindex->GetBlockHash());
+        if (mi != mapBlockIndex.end())
+            SetBlockIndexPoWHash(mi->second, hashPoW);
+    }
     return true;
 }
 
@@ -2452,6 +2526,8 @@ bool DisconnectBlock(const CBlock &block, CValidationState &state, const CBlockI
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
 
+    coinbasePayeeIndex.BlockDisconnected(pindex);
+
     if (fAddressIndex) {
         if (!pblocktree->EraseAddressIndex(addressIndex)) {
             AbortNode(state, "Failed to delete address index");
@@ -2502,6 +2578,54 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CHeaderPoWCheck> headercheckqueue(16);
+/** Serializes users of headercheckqueue, which only supports one master at a time */
+static CCriticalSection cs_headercheckqueue;
+
+void ThreadHeaderCheck() {
+    RenameThread("bitcoin-headerch");
+    headercheckqueue.Thread();
+}
+
+static CCheckQueue<CZerocoinSpendCheck> zerocoinspendcheckqueue(4);
+/** Serializes users of zerocoinspendcheckqueue */
+static CCriticalSection cs_zerocoinspendcheckqueue;
+
+void ThreadZerocoinSpendCheck() {
+    RenameThread("bitcoin-zcspendch");
+    zerocoinspendcheckqueue.Thread();
+}
+
+bool CHeaderPoWCheck::operator()() {
+    *phashPoW = pheader->GetPoWHash(nHeight);
+    return CheckProofOfWork(*phashPoW, pheader->nBits, *pconsensusParams);
+}
+
+bool CheckBlockHeadersPoW(const std::vector<CBlockHeader> &headers, int nFirstHeight, const std::vector<bool> &vCheck,
+                          const Consensus::Params &consensusParams, std::vector<uint256> &vPoWHashes) {
+    assert(vCheck.size() == headers.size());
+    vPoWHashes.assign(headers.size(), uint256());
+    std::vector<CHeaderPoWCheck> vChecks;
+    vChecks.reserve(headers.size());
+    for (unsigned int i = 0; i < headers.size(); i++) {
+        if (vCheck[i])
+            vChecks.push_back(CHeaderPoWCheck(headers[i], nFirstHeight + i, consensusParams, &vPoWHashes[i]));
+    }
+
+    if (!nHeaderCheckThreads) {
+        BOOST_FOREACH(CHeaderPoWCheck &check, vChecks) {
+            if (!check())
+                return false;
+        }
+        return true;
+    }
+
+    LOCK(cs_headercheckqueue);
+    CCheckQueueControl<CHeaderPoWCheck> control(&headercheckqueue);
+    control.Add(vChecks);
+    return control.Wait();
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2566,6 +2690,8 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
     LogPrintf("ConnectBlock nHeight=%s, hash=%s\n", pindex->nHeight, block.GetHash().ToString());
     if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck, !fJustCheck, pindex->nHeight, false)) {
         LogPrintf("--> failed\n");
+        if (state.IsError())
+            return AbortNode(state, state.GetRejectReason());
         return error("%s: Consensus::CheckBlock: %s", __func__, FormatStateMessage(state));
     }
 
@@ -2861,11 +2987,15 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
              nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs - 1), nTimeVerify * 0.000001);
 
     if (!ConnectBlockZC(state, chainparams, pindex, &block, fJustCheck))
-        return false;
+        return state.IsError() ? AbortNode(state, state.GetRejectReason()) : false;
 
     if (fJustCheck)
         return true;
 
+    // zerocoin mint and spend counts of the index entry are set by ConnectBlockZC, they go to disk with the
+    // zerocoin data. Also written if they were cleared, a reconnected block can end up with none.
+    setDirtyBlockIndex.insert(pindex);
+
     // Write undo information to disk
     if (pindex->GetUndoPos().IsNull() || !pindex->IsValid(BLOCK_VALID_SCRIPTS)) {
         if (pindex->GetUndoPos().IsNull()) {
@@ -2913,6 +3043,8 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
     nTimeIndex += nTime5 - nTime4;
     LogPrint("bench", "    - Index writing: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimeIndex * 0.000001);
 
+    coinbasePayeeIndex.BlockConnected(pindex, block.vtx[0]);
+
     // Watch for changes to the previous coinbase transaction.
     static uint256 hashPrevBestCoinBase;
     GetMainSignals().UpdatedTransaction(hashPrevBestCoinBase);
@@ -3035,9 +3167,13 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
                     vBlocks.push_back(*it);
                     setDirtyBlockIndex.erase(it++);
                 }
-                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
+                // the zerocoin data of the blocks goes in the same batch as their index entries
+                std::vector<std::pair<uint256, const CZerocoinBlockData *>> vZerocoinData;
+                ZerocoinGetDirtyBlockData(vZerocoinData);
+                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks, vZerocoinData)) {
                     return AbortNode(state, "Files to write to block index database");
                 }
+                ZerocoinBlockDataFlushed();
             }
             // Finally remove any pruned files
             if (fFlushForPrune)
@@ -3056,6 +3192,10 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            // Snapshot the zerocoin state at the flushed tip so that the next start only replays the blocks after it.
+            // Not done on every flush during initial sync, the replay works from any earlier snapshot.
+            if ((mode == FLUSH_STATE_ALWAYS || fPeriodicFlush) && !ZerocoinWriteStateSnapshot(chainActive.Tip()))
+                return AbortNode(state, "Failed to write zerocoin state to block index database");
             nLastFlush = nNow;
         }
         if (fDoFullFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) &&
@@ -3165,7 +3305,8 @@ bool static DisconnectTip(CValidationState &state, const CChainParams &chainpara
     }
     LogPrint("bench", "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
 	
-	DisconnectTipZC(block, pindexDelete);
+    if (!DisconnectTipZC(block, pindexDelete))
+        return AbortNode(state, "Failed to read zerocoin data of the block");
 	
     // Write the chain state to disk, if necessary.
     if (!FlushStateToDisk(state, FLUSH_STATE_IF_NEEDED))
@@ -3262,6 +3403,7 @@ ConnectTip(CValidationState &state, const CChainParams &chainparams, CBlockIndex
     mempool.removeForBlock(pblock->vtx, pindexNew->nHeight, txConflicted, !IsInitialBlockDownload());
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
+    mnodeman.CheckSpentCollaterals(*pblock);
     // Tell wallet about transactions that went from mempool
     // to conflicted:
     BOOST_FOREACH(
@@ -3916,14 +4058,69 @@ bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigne
 
 //btzc: code from vertcoin, add
 bool CheckBlockHeader(const CBlockHeader &block, CValidationState &state, const Consensus::Params &consensusParams,
-                      bool fCheckPOW) {
-    int nHeight = ZerocoinGetNHeight(block);
-    if (fCheckPOW && !CheckProofOfWork(block.GetPoWHash(nHeight), block.nBits, consensusParams)) {
-        return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
+                      bool fCheckPOW, uint256 *phashPoW) {
+    if (fCheckPOW) {
+        int nHeight = ZerocoinGetNHeight(block);
+        uint256 hashPoW = block.GetPoWHash(nHeight);
+        if (!CheckProofOfWork(hashPoW, block.nBits, consensusParams))
+            return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
+        if (phashPoW)
+            *phashPoW = hashPoW;
     }
     return true;
 }
 
+/**
+ * Check the transactions of a block with the zerocoin spend proofs verified on the spend check threads.
+ * Returns false, leaving block.zerocoinTxInfo as it was, if that is not possible or any check fails,
+ * in which case the caller checks the transactions serially to get the same result and error.
+ */
+static bool CheckBlockZerocoinSpendsParallel(const CBlock &block, int nHeight, bool isVerifyDB) {
+    if (!nScriptCheckThreads)
+        return false;
+
+    bool fHasSpends = false;
+    BOOST_FOREACH(const CTransaction &tx, block.vtx) {
+        if (tx.IsZerocoinSpend()) {
+            fHasSpends = true;
+            break;
+        }
+    }
+    if (!fHasSpends)
+        return false;
+
+    CZerocoinTxInfo &zerocoinTxInfo = *block.zerocoinTxInfo;
+    CZerocoinTxInfo zerocoinTxInfoSaved = zerocoinTxInfo;
+
+    bool fOk = true;
+    zerocoinTxInfo.fDeferSpendChecks = true;
+    BOOST_FOREACH(const CTransaction &tx, block.vtx) {
+        CValidationState stateDummy;
+        if (!CheckTransaction(tx, stateDummy, tx.GetHash(), isVerifyDB, nHeight, false, &zerocoinTxInfo)) {
+            fOk = false;
+            break;
+        }
+    }
+    zerocoinTxInfo.fDeferSpendChecks = false;
+
+    if (fOk) {
+        int64_t nTimeStart = GetTimeMicros();
+        size_t nChecks = zerocoinTxInfo.spendChecks.size();
+        {
+            LOCK(cs_zerocoinspendcheckqueue);
+            CCheckQueueControl<CZerocoinSpendCheck> control(&zerocoinspendcheckqueue);
+            control.Add(zerocoinTxInfo.spendChecks);
+            fOk = control.Wait();
+        }
+        LogPrint("bench", "    - Verify %u zerocoin spends: %.2fms\n", nChecks, 0.001 * (GetTimeMicros() - nTimeStart));
+    }
+
+    if (!fOk)
+        zerocoinTxInfo = zerocoinTxInfoSaved;
+    zerocoinTxInfo.spendChecks.clear();
+    return fOk;
+}
+
 bool CheckBlock(const CBlock &block, CValidationState &state, const Consensus::Params &consensusParams, bool fCheckPOW,
                 bool fCheckMerkleRoot, int nHeight, bool isVerifyDB) {
     LogPrintf("CheckBlock() nHeight=%s, blockHash= %s, isVerifyDB = %s\n", nHeight, block.GetHash().ToString(),
@@ -4020,12 +4217,17 @@ bool CheckBlock(const CBlock &block, CValidationState &state, const Consensus::P
             nHeight = ZerocoinGetNHeight(block.GetBlockHeader());
         if (block.zerocoinTxInfo == NULL)
             block.zerocoinTxInfo = std::make_shared<CZerocoinTxInfo>();
-        BOOST_FOREACH(const CTransaction &tx, block.vtx)
-        if (!CheckTransaction(tx, state, tx.GetHash(), isVerifyDB, nHeight, false, block.zerocoinTxInfo.get())) {
-            LogPrintf("block=%s\n", block.ToString());
-            return state.Invalid(false, state.GetRejectCode(), state.GetRejectReason(),
-                                 strprintf("Transaction check failed (tx hash %s) %s", tx.GetHash().ToString(),
-                                           state.GetDebugMessage()));
+        if (!CheckBlockZerocoinSpendsParallel(block, nHeight, isVerifyDB)) {
+            BOOST_FOREACH(const CTransaction &tx, block.vtx)
+            if (!CheckTransaction(tx, state, tx.GetHash(), isVerifyDB, nHeight, false, block.zerocoinTxInfo.get())) {
+                LogPrintf("block=%s\n", block.ToString());
+                // the zerocoin data needed to check the transaction couldn't be read, the block isn't invalid
+                if (state.IsError())
+                    return false;
+                return state.Invalid(false, state.GetRejectCode(), state.GetRejectReason(),
+                                     strprintf("Transaction check failed (tx hash %s) %s", tx.GetHash().ToString(),
+                                               state.GetDebugMessage()));
+            }
         }
         block.zerocoinTxInfo->Complete();
 
@@ -4239,14 +4441,16 @@ bool ContextualCheckBlock(const CBlock &block, CValidationState &state, CBlockIn
     return true;
 }
 
+/** If phashPoW is set and not null, it is the header's PoW hash computed by CheckBlockHeadersPoW(). */
 static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state, const CChainParams &chainparams,
-                              CBlockIndex **ppindex = NULL) {
+                              CBlockIndex **ppindex = NULL, const uint256 *phashPoW = NULL) {
 //    LogPrintf("---AcceptBlockHeader hash=%s--\n", block.GetHash().ToString());
     AssertLockHeld(cs_main);
     // Check for duplicate
     uint256 hash = block.GetHash();
     BlockMap::iterator miSelf = mapBlockIndex.find(hash);
     CBlockIndex *pindex = NULL;
+    uint256 hashPoW;
     if (hash != chainparams.GetConsensus().hashGenesisBlock) {
 
         if (miSelf != mapBlockIndex.end()) {
@@ -4262,7 +4466,14 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
 //        int nHeight = ZerocoinGetNHeight(block);
 //        int64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(
 //                std::chrono::system_clock::now().time_since_epoch()).count();
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+        if (phashPoW && !phashPoW->IsNull()) {
+            // already hashed, only the target is left to check
+            hashPoW = *phashPoW;
+            if (!CheckProofOfWork(hashPoW, block.nBits, chainparams.GetConsensus()))
+                return state.DoS(50, error("%s: proof of work failed: %s", __func__, hash.ToString()),
+                                 REJECT_INVALID, "high-hash");
+        }
+        else if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), true, &hashPoW))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(),
                          FormatStateMessage(state));
 //        int64_t end = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -4297,6 +4508,8 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
     }
     if (pindex == NULL)
         pindex = AddToBlockIndex(block);
+    if (!hashPoW.IsNull())
+        SetBlockIndexPoWHash(pindex, hashPoW);
     if (ppindex)
         *ppindex = pindex;
 //    LogPrintf("--->AcceptBlockHeader success");
@@ -4739,7 +4952,8 @@ bool static LoadBlockIndexDB() {
 
      // some blocks in index can change as a result of ZerocoinBuildStateFromIndex() call
     set<CBlockIndex *> changes;
-    ZerocoinBuildStateFromIndex(&chainActive, changes);
+    if (!ZerocoinBuildStateFromIndex(&chainActive, changes))
+        return error("%s: can't build the zerocoin state from the block index", __func__);
     if (!changes.empty()) {
         setDirtyBlockIndex.insert(changes.begin(), changes.end());
         FlushStateToDisk();
@@ -6796,6 +7010,30 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
+        // Hash the new headers of the batch on the header check threads before taking
+        // cs_main, so only the contextual checks below are done serially. The hashes are
+        // used even if a header fails: AcceptBlockHeader checks them against the target
+        // and treats the peer exactly as if it had hashed the header itself.
+        std::vector<uint256> vPoWHashes;
+        if (nCount > 0) {
+            int nFirstHeight = -1;
+            // headers we already have are skipped by AcceptBlockHeader, don't hash them
+            std::vector<bool> vCheck(nCount);
+            {
+                LOCK(cs_main);
+                BlockMap::iterator mi = mapBlockIndex.find(headers[0].hashPrevBlock);
+                if (mi != mapBlockIndex.end())
+                    nFirstHeight = mi->second->nHeight + 1;
+                for (unsigned int n = 0; n < nCount; n++)
+                    vCheck[n] = mapBlockIndex.count(headers[n].GetHash()) == 0;
+            }
+            bool fContinuous = nFirstHeight >= 0;
+            for (unsigned int n = 1; n < nCount && fContinuous; n++)
+                fContinuous = headers[n].hashPrevBlock == headers[n - 1].GetHash();
+            if (fContinuous)
+                CheckBlockHeadersPoW(headers, nFirstHeight, vCheck, chainparams.GetConsensus(), vPoWHashes);
+        }
+
         {
             LOCK(cs_main);
 
@@ -6837,8 +7075,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
 
             LogPrint("net", "ProcessMessage.AcceptBlockHeader() total %s blocks\n", headers.size());
             CBlockIndex *pindexLast = NULL;
-            BOOST_FOREACH(
-            const CBlockHeader &header, headers) {
+            for (unsigned int n = 0; n < nCount; n++) {
+                const CBlockHeader &header = headers[n];
                 CValidationState state;
 //                int64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(
 //                        std::chrono::system_clock::now().time_since_epoch()).count();
@@ -6849,8 +7087,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
                     Misbehaving(pfrom->GetId(), 20);
                     return error("non-continuous headers sequence");
                 }
-                //TODOS
-                if (!AcceptBlockHeader(header, state, chainparams, &pindexLast)) {
+                if (!AcceptBlockHeader(header, state, chainparams, &pindexLast,
+                                       vPoWHashes.empty() ? NULL : &vPoWHashes[n])) {
                     int nDoS;
                     if (state.IsInvalid(nDoS)) {
                         if (nDoS > 0) Misbehaving(pfrom->GetId(), nDoS);
@@ -7153,30 +7391,61 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
         // message would be undesirable as we transmit it ourselves.
     } else {
 //        LogPrintf("Main.cpp ProcessMessage() strCommand=%s\n", strCommand);
-        // Ignore unknown commands for extensibility
-        bool found = false;
-        const std::vector <std::string> &allMessages = getAllNetMessageTypes();
-        BOOST_FOREACH(const std::string msg, allMessages) {
-            if (msg == strCommand) {
-                found = true;
-                break;
-            }
-        }
+        // Messages of the extensions go to their handler, ignore unknown commands for extensibility
+        if (!messageDispatcher.Dispatch(pfrom, strCommand, vRecv))
+            LogPrint("net", "Unknown command \"%s\" from peer=%d\n", SanitizeString(strCommand), pfrom->id);
+    }
+    return true;
+}
 
-        if (found) {
-            //probably one the extensions
-            darkSendPool.ProcessMessage(pfrom, strCommand, vRecv);
-            mnodeman.ProcessMessage(pfrom, strCommand, vRecv);
-            mnpayments.ProcessMessage(pfrom, strCommand, vRecv);
-            instantsend.ProcessMessage(pfrom, strCommand, vRecv);
-            sporkManager.ProcessSpork(pfrom, strCommand, vRecv);
-            bznodeSync.ProcessMessage(pfrom, strCommand, vRecv);
+/** Processes one message, logs and swallows the exceptions of malformed messages */
+static bool ProcessMessageChecked(CNode *pfrom, const string &strCommand, CDataStream &vRecv, unsigned int nMessageSize,
+                                  int64_t nTimeReceived, const CChainParams &chainparams) {
+    bool fRet = false;
+    int64_t nTimeStart = GetTimeMicros();
+    try {
+        fRet = ProcessMessage(pfrom, strCommand, vRecv, nTimeReceived, chainparams);
+        boost::this_thread::interruption_point();
+    }
+    catch (const std::ios_base::failure &e) {
+        pfrom->PushMessage(NetMsgType::REJECT, strCommand, REJECT_MALFORMED, string("error parsing message"));
+        if (strstr(e.what(), "end of data")) {
+            // Allow exceptions from under-length message on vRecv
+            LogPrintf(
+                    "%s(%s, %u bytes): Exception '%s' caught, normally caused by a message being shorter than its stated length\n",
+                    __func__, SanitizeString(strCommand), nMessageSize, e.what());
+        } else if (strstr(e.what(), "size too large")) {
+            // Allow exceptions from over-long size
+            LogPrintf("%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand),
+                      nMessageSize, e.what());
+        } else if (strstr(e.what(), "non-canonical ReadCompactSize()")) {
+            // Allow exceptions from non-canonical encoding
+            LogPrintf("%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand),
+                      nMessageSize, e.what());
         } else {
-            // Ignore unknown commands for extensibility
-            LogPrint("net", "Unknown command \"%s\" from peer=%d\n", SanitizeString(strCommand), pfrom->id);
+            PrintExceptionContinue(&e, "ProcessMessages() 1");
         }
     }
-    return true;
+    catch (const boost::thread_interrupted &) {
+        throw;
+    }
+    catch (const std::exception &e) {
+        LogPrintf("Exception with strCommand=%s\n", strCommand);
+        PrintExceptionContinue(&e, "ProcessMessages() 2");
+    } catch (...) {
+        PrintExceptionContinue(NULL, "ProcessMessages() 3");
+    }
+    messageDispatcher.RecordMessage(strCommand, nMessageSize, GetTimeMicros() - nTimeStart);
+
+    if (!fRet)
+        LogPrintf("%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize,
+                  pfrom->id);
+    return fRet;
+}
+
+static void ProcessMessageTask(CNode *pfrom, const string &strCommand, std::shared_ptr<CDataStream> pvRecv,
+                               unsigned int nMessageSize, int64_t nTimeReceived) {
+    ProcessMessageChecked(pfrom, strCommand, *pvRecv, nMessageSize, nTimeReceived, Params());
 }
 
 // requires LOCK(cs_vRecvMsg)
@@ -7243,44 +7512,16 @@ bool ProcessMessages(CNode *pfrom) {
             continue;
         }
 
-        // Process message
-        bool fRet = false;
-        try {
-            fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams);
-            boost::this_thread::interruption_point();
-        }
-        catch (const std::ios_base::failure &e) {
-            pfrom->PushMessage(NetMsgType::REJECT, strCommand, REJECT_MALFORMED, string("error parsing message"));
-            if (strstr(e.what(), "end of data")) {
-                // Allow exceptions from under-length message on vRecv
-                LogPrintf(
-                        "%s(%s, %u bytes): Exception '%s' caught, normally caused by a message being shorter than its stated length\n",
-                        __func__, SanitizeString(strCommand), nMessageSize, e.what());
-            } else if (strstr(e.what(), "size too large")) {
-                // Allow exceptions from over-long size
-                LogPrintf("%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand),
-                          nMessageSize, e.what());
-            } else if (strstr(e.what(), "non-canonical ReadCompactSize()")) {
-                // Allow exceptions from non-canonical encoding
-                LogPrintf("%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand),
-                          nMessageSize, e.what());
-            } else {
-                PrintExceptionContinue(&e, "ProcessMessages() 1");
-            }
-        }
-        catch (const boost::thread_interrupted &) {
-            throw;
-        }
-        catch (const std::exception &e) {
-            LogPrintf("Exception with strCommand=%s\n", strCommand);
-            PrintExceptionContinue(&e, "ProcessMessages() 2");
-        } catch (...) {
-            PrintExceptionContinue(NULL, "ProcessMessages() 3");
+        // Bznode payment votes are processed by a message worker, the next
+        // messages of this peer wait for it
+        if (messageDispatcher.IsParallel(strCommand)) {
+            std::shared_ptr<CDataStream> pvRecv(new CDataStream(vRecv));
+            if (QueueMessageTask(pfrom, boost::bind(&ProcessMessageTask, pfrom, strCommand, pvRecv, nMessageSize, msg.nTime)))
+                break;
         }
 
-        if (!fRet)
-            LogPrintf("%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize,
-                      pfrom->id);
+        // Process message
+        ProcessMessageChecked(pfrom, strCommand, vRecv, nMessageSize, msg.nTime, chainparams);
 
         break;
     }
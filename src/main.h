@@ -92,6 +92,9 @@ static const unsigned int DEFAULT_BLOCK_PRIORITY_SIZE = 50000; // 50KB
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** -parheaders and -parspends default (number of header PoW and zerocoin spend checking threads, 0 = half of -par) */
+static const int DEFAULT_HEADERCHECK_THREADS = 0;
+static const int DEFAULT_SPENDCHECK_THREADS = 0;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 128;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -182,6 +185,8 @@ extern CConditionVariable cvBlockChange;
 extern bool fImporting;
 extern bool fReindex;
 extern int nScriptCheckThreads;
+extern int nHeaderCheckThreads;
+extern int nSpendCheckThreads;
 extern bool fTxIndex;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
@@ -275,6 +280,10 @@ bool ProcessMessages(CNode* pfrom);
 bool SendMessages(CNode* pto);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the header proof-of-work checking thread */
+void ThreadHeaderCheck();
+/** Run an instance of the zerocoin spend proof checking thread */
+void ThreadZerocoinSpendCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Format a string that describes several potential problems detected by the core.
@@ -467,6 +476,33 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure representing the proof-of-work check of one block header.
+ * The computed hash is stored through phashPoW so it can be reused.
+ */
+class CHeaderPoWCheck
+{
+private:
+    const CBlockHeader *pheader;
+    int nHeight;
+    const Consensus::Params *pconsensusParams;
+    uint256 *phashPoW;
+
+public:
+    CHeaderPoWCheck(): pheader(NULL), nHeight(0), pconsensusParams(NULL), phashPoW(NULL) {}
+    CHeaderPoWCheck(const CBlockHeader& headerIn, int nHeightIn, const Consensus::Params& consensusParamsIn, uint256* phashPoWIn) :
+        pheader(&headerIn), nHeight(nHeightIn), pconsensusParams(&consensusParamsIn), phashPoW(phashPoWIn) { }
+
+    bool operator()();
+
+    void swap(CHeaderPoWCheck &check) {
+        std::swap(pheader, check.pheader);
+        std::swap(nHeight, check.nHeight);
+        std::swap(pconsensusParams, check.pconsensusParams);
+        std::swap(phashPoW, check.phashPoW);
+    }
+};
+
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes);
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
 bool GetAddressIndex(uint160 addressHash, int type,
@@ -483,7 +519,15 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
 /** Functions for validating blocks and updating the block tree */
 
 /** Context-independent validity checks */
-bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true);
+/** If phashPoW is set and the proof of work was checked, it receives the computed PoW hash */
+bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, uint256* phashPoW = NULL);
+/**
+ * Check the proof of work of a continuous sequence of headers, the first one at height nFirstHeight,
+ * on the header check threads. Only the headers flagged in vCheck are hashed. Does not require cs_main.
+ * vPoWHashes receives the hash of every header that was hashed, null for the others, also on failure.
+ */
+bool CheckBlockHeadersPoW(const std::vector<CBlockHeader>& headers, int nFirstHeight, const std::vector<bool>& vCheck,
+                          const Consensus::Params& consensusParams, std::vector<uint256>& vPoWHashes);
 bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true, int nHeight = INT_MAX, bool isVerifyDB = false);
 
 /** Context-dependent validity checks.
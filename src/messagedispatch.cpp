@@ -0,0 +1,68 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "messagedispatch.h"
+#include "protocol.h"
+
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+CMessageDispatcher messageDispatcher;
+
+static const std::string MESSAGE_COMMAND_OTHER = "*other*";
+
+void CMessageDispatcher::InitStats() const
+{
+    // filled on first use, the list of commands is not ready during static initialization
+    if (!mapStats.empty())
+        return;
+    BOOST_FOREACH(const std::string& strCommand, getAllNetMessageTypes())
+        mapStats[strCommand] = CMessageStats();
+    mapStats[MESSAGE_COMMAND_OTHER] = CMessageStats();
+}
+
+void CMessageDispatcher::RegisterHandler(const std::string& strCommand, const Handler& handler, bool fParallel)
+{
+    assert(!mapHandlers.count(strCommand));
+    mapHandlers[strCommand] = handler;
+    if (fParallel)
+        setParallelCommands.insert(strCommand);
+}
+
+void CMessageDispatcher::UnregisterAllHandlers()
+{
+    mapHandlers.clear();
+    setParallelCommands.clear();
+}
+
+bool CMessageDispatcher::Dispatch(CNode* pfrom, std::string& strCommand, CDataStream& vRecv) const
+{
+    std::map<std::string, Handler>::const_iterator it = mapHandlers.find(strCommand);
+    if (it == mapHandlers.end())
+        return false;
+    it->second(pfrom, strCommand, vRecv);
+    return true;
+}
+
+void CMessageDispatcher::RecordMessage(const std::string& strCommand, unsigned int nBytes, int64_t nTimeMicros)
+{
+    LOCK(cs_stats);
+    InitStats();
+    std::map<std::string, CMessageStats>::iterator it = mapStats.find(strCommand);
+    if (it == mapStats.end())
+        it = mapStats.find(MESSAGE_COMMAND_OTHER);
+    CMessageStats& stats = it->second;
+    stats.nCount++;
+    stats.nBytes += nBytes;
+    stats.nTimeMicros += nTimeMicros;
+    stats.nMaxTimeMicros = std::max(stats.nMaxTimeMicros, nTimeMicros);
+}
+
+std::map<std::string, CMessageStats> CMessageDispatcher::GetStats() const
+{
+    LOCK(cs_stats);
+    InitStats();
+    return mapStats;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef MESSAGEDISPATCH_H
+#define MESSAGEDISPATCH_H
+
+#include "streams.h"
+#include "sync.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <boost/function.hpp>
+
+class CNode;
+class CMessageDispatcher;
+extern CMessageDispatcher messageDispatcher;
+
+/** Number and cost of the messages of one command processed by ProcessMessages() */
+struct CMessageStats
+{
+    uint64_t nCount;
+    uint64_t nBytes;
+    int64_t nTimeMicros;
+    int64_t nMaxTimeMicros;
+
+    CMessageStats() : nCount(0), nBytes(0), nTimeMicros(0), nMaxTimeMicros(0) {}
+};
+
+/**
+ * Routes the messages that ProcessMessage() does not handle itself (bznode,
+ * payments, InstantSend, PrivateSend, spork and sync messages) to the single
+ * handler registered for their command, and keeps the per-command stats of
+ * every processed message.
+ *
+ * Handlers are registered once at startup, before the message handler thread
+ * runs, and are looked up without locking afterwards.
+ */
+class CMessageDispatcher
+{
+public:
+    typedef boost::function<void (CNode*, std::string&, CDataStream&)> Handler;
+
+private:
+    std::map<std::string, Handler> mapHandlers;
+    // commands whose handler can run on a message worker, see QueueMessageTask()
+    std::set<std::string> setParallelCommands;
+
+    // one entry per known command plus "*other*", so that
+    // peers can't grow the map with made up commands
+    mutable CCriticalSection cs_stats;
+    mutable std::map<std::string, CMessageStats> mapStats;
+
+    void InitStats() const;
+
+public:
+    /**
+     * fParallel: the handler does its own locking and may run on a message worker,
+     * concurrently with the handlers of the messages of other peers
+     */
+    void RegisterHandler(const std::string& strCommand, const Handler& handler, bool fParallel = false);
+    void UnregisterAllHandlers();
+
+    bool IsParallel(const std::string& strCommand) const { return setParallelCommands.count(strCommand) != 0; }
+
+    /** Calls the handler of strCommand, returns false if there is none */
+    bool Dispatch(CNode* pfrom, std::string& strCommand, CDataStream& vRecv) const;
+
+    void RecordMessage(const std::string& strCommand, unsigned int nBytes, int64_t nTimeMicros);
+    std::map<std::string, CMessageStats> GetStats() const;
+};
+
+#endif // MESSAGEDISPATCH_H
@@ -28,8 +28,6 @@
 #include "wallet/wallet.h"
 #include "definition.h"
 #include "crypto/scrypt.h"
-#include "crypto/Lyra2Z/Lyra2Z.h"
-#include "crypto/Lyra2Z/Lyra2.h"
 #include "bznode-payments.h"
 #include "bznode-sync.h"
 #include "zerocoin.h"
@@ -1065,14 +1063,8 @@ void static bitcoinzeroMiner(const CChainParams &chainparams) {
 
                 while (true)
                 {
-                    if (pindexPrev->nHeight >= HF_ALGO -1)
-                    {
-                    lyra2z_hash(BEGIN(pblock->nVersion), BEGIN(thash));
-                    }
-                    else
-                    {
-                    LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 330, 256);
-                    }
+                    // GetPoWHash reuses this thread's Lyra2 matrix across nonces
+                    thash = pblock->GetPoWHash(pindexPrev->nHeight + 1);
 
                     if (UintToArith256(thash) <= hashTarget) {
                         // Found a solution
@@ -29,6 +29,10 @@
 
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -47,6 +51,11 @@
 // We add a random period time (0 to 1 seconds) to feeler connections to prevent synchronization.
 #define FEELER_SLEEP_WINDOW 1
 
+// Maximum number of socket events handled per epoll_wait() call
+#define MAX_SOCKET_EVENTS 256
+// Event data of the listening sockets in the epoll set, node sockets use their NodeId
+#define EPOLL_LISTEN_SOCKET ((uint64_t) -1)
+
 #if !defined(HAVE_MSG_NOSIGNAL) && !defined(MSG_NOSIGNAL)
 #define MSG_NOSIGNAL 0
 #endif
@@ -113,6 +122,8 @@ CCriticalSection cs_nLastNodeId;
 
 static CSemaphore *semOutbound = NULL;
 boost::condition_variable messageHandlerCondition;
+// epoll instance of the socket handler, see InitSocketEvents(), INVALID_SOCKET if it uses select()
+static SOCKET hEpollSocket = INVALID_SOCKET;
 
 // Signals for message handling
 static CNodeSignals g_signals;
@@ -385,7 +396,8 @@ CNode *ConnectNode(CAddress addrConnect, const char *pszDest, bool fCountFailure
     if (pszDest ? ConnectSocketByName(addrConnect, hSocket, pszDest, Params().GetDefaultPort(), nConnectTimeout,
                                       &proxyConnectionFailed) :
         ConnectSocket(addrConnect, hSocket, nConnectTimeout, &proxyConnectionFailed)) {
-        if (!IsSelectableSocket(hSocket)) {
+        // only the select() loop of the socket handler is limited to FD_SETSIZE
+        if (hEpollSocket == INVALID_SOCKET && !IsSelectableSocket(hSocket)) {
             LogPrintf("Cannot create connection: non-selectable socket created (fd >= FD_SETSIZE ?)\n");
             CloseSocket(hSocket);
             return NULL;
@@ -716,24 +728,32 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes) {
         pch += handled;
         nBytes -= handled;
 
-        if (msg.complete()) {
-
-            //store received bytes per message command
-            //to prevent a memory DOS, only allow valid commands
-            mapMsgCmdSize::iterator i = mapRecvBytesPerMsgCmd.find(msg.hdr.pchCommand);
-            if (i == mapRecvBytesPerMsgCmd.end())
-                i = mapRecvBytesPerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER);
-            assert(i != mapRecvBytesPerMsgCmd.end());
-            i->second += msg.hdr.nMessageSize + CMessageHeader::HEADER_SIZE;
-
-            msg.nTime = GetTimeMicros();
-            messageHandlerCondition.notify_one();
-        }
+        if (msg.complete())
+            MsgComplete(msg);
     }
 
     return true;
 }
 
+void CNode::MsgComplete(CNetMessage &msg) {
+    //store received bytes per message command
+    //to prevent a memory DOS, only allow valid commands
+    mapMsgCmdSize::iterator i = mapRecvBytesPerMsgCmd.find(msg.hdr.pchCommand);
+    if (i == mapRecvBytesPerMsgCmd.end())
+        i = mapRecvBytesPerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER);
+    assert(i != mapRecvBytesPerMsgCmd.end());
+    i->second += msg.hdr.nMessageSize + CMessageHeader::HEADER_SIZE;
+
+    msg.nTime = GetTimeMicros();
+    messageHandlerCondition.notify_one();
+}
+
+void CNode::ReceiveMsgData(CNetMessage &msg, unsigned int nBytes) {
+    msg.nDataPos += nBytes;
+    if (msg.complete())
+        MsgComplete(msg);
+}
+
 int CNetMessage::readHeader(const char *pch, unsigned int nBytes) {
     // copy data to temporary parsing buffer
     unsigned int nRemaining = 24 - nHdrPos;
@@ -764,6 +784,15 @@ int CNetMessage::readHeader(const char *pch, unsigned int nBytes) {
     return nCopy;
 }
 
+char *CNetMessage::prepareData(unsigned int &nSpace) {
+    if (vRecv.size() == nDataPos) {
+        // Allocate up to 256 KiB ahead, but never more than the total message size.
+        vRecv.resize(std::min(hdr.nMessageSize, nDataPos + 256 * 1024));
+    }
+    nSpace = vRecv.size() - nDataPos;
+    return &vRecv[nDataPos];
+}
+
 int CNetMessage::readData(const char *pch, unsigned int nBytes) {
     unsigned int nRemaining = hdr.nMessageSize - nDataPos;
     unsigned int nCopy = std::min(nRemaining, nBytes);
@@ -1000,7 +1029,7 @@ static void AcceptConnection(const ListenSocket &hListenSocket) {
         return;
     }
 
-    if (!IsSelectableSocket(hSocket)) {
+    if (hEpollSocket == INVALID_SOCKET && !IsSelectableSocket(hSocket)) {
         LogPrintf("connection from %s dropped: non-selectable socket\n", addr.ToString());
         CloseSocket(hSocket);
         return;
@@ -1042,6 +1071,170 @@ static void AcceptConnection(const ListenSocket &hListenSocket) {
     }
 }
 
+// requires LOCK(cs_vRecvMsg)
+static bool CanReceiveMore(CNode *pnode) {
+    return pnode->vRecvMsg.empty() || !pnode->vRecvMsg.front().complete() ||
+           pnode->GetTotalRecvSize() <= ReceiveFloodSize();
+}
+
+// requires LOCK(cs_vRecvMsg)
+// Does one recv() on the socket of pnode. The remaining payload of a partially
+// received message is read straight into its buffer. Returns false once the
+// socket has nothing more to read or was closed.
+static bool SocketRecvData(CNode *pnode) {
+    // typical socket buffer is 8K-64K
+    char pchBuf[0x10000];
+    char *pch = pchBuf;
+    unsigned int nSpace = sizeof(pchBuf);
+    CNetMessage *pmsg = NULL;
+    if (!pnode->vRecvMsg.empty() && pnode->vRecvMsg.back().in_data && !pnode->vRecvMsg.back().complete()) {
+        pmsg = &pnode->vRecvMsg.back();
+        pch = pmsg->prepareData(nSpace);
+    }
+
+    int nBytes = recv(pnode->hSocket, pch, nSpace, MSG_DONTWAIT);
+    if (nBytes > 0) {
+        if (pmsg != NULL)
+            pnode->ReceiveMsgData(*pmsg, nBytes);
+        else if (!pnode->ReceiveMsgBytes(pchBuf, nBytes))
+            pnode->CloseSocketDisconnect();
+        pnode->nLastRecv = GetTime();
+        pnode->nRecvBytes += nBytes;
+        pnode->RecordBytesRecv(nBytes);
+        return pnode->hSocket != INVALID_SOCKET;
+    } else if (nBytes == 0) {
+        // socket closed gracefully
+        if (!pnode->fDisconnect)
+            LogPrint("net", "socket closed\n");
+        pnode->CloseSocketDisconnect();
+    } else if (nBytes < 0) {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR &&
+            nErr != WSAEINPROGRESS) {
+            if (!pnode->fDisconnect)
+                LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
+            pnode->CloseSocketDisconnect();
+        }
+    }
+    return false;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/**
+ * Waits for events on the listening sockets and the sockets of the nodes, and
+ * registers the sockets of new nodes first. The node sockets are edge triggered,
+ * so an event only sets the ready flags of the node, which stay set until
+ * ServiceSocketEpoll() finds the socket drained (recv) or full (send).
+ * Returns true if a listening socket has a connection to accept.
+ */
+static bool WaitForSocketEventsEpoll(int nTimeout) {
+    {
+        LOCK(cs_vNodes);
+        BOOST_FOREACH(CNode * pnode, vNodes)
+        {
+            if (pnode->hSocket == INVALID_SOCKET || pnode->fSocketRegistered)
+                continue;
+            struct epoll_event event;
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.u64 = pnode->id;
+            if (epoll_ctl(hEpollSocket, EPOLL_CTL_ADD, pnode->hSocket, &event) == SOCKET_ERROR) {
+                LogPrintf("epoll_ctl failed for peer=%d: %s\n", pnode->id, NetworkErrorString(WSAGetLastError()));
+                pnode->fDisconnect = true;
+                continue;
+            }
+            pnode->fSocketRegistered = true;
+            pnode->fSocketRecvReady = true;
+            pnode->fSocketSendReady = true;
+        }
+    }
+
+    struct epoll_event events[MAX_SOCKET_EVENTS];
+    int nEvents = epoll_wait(hEpollSocket, events, MAX_SOCKET_EVENTS, nTimeout);
+    boost::this_thread::interruption_point();
+
+    if (nEvents == SOCKET_ERROR) {
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR)
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(nErr));
+        MilliSleep(nTimeout);
+        return false;
+    }
+
+    // A socket closed by another thread, or kept open by a forked child after we
+    // closed it, can still report events. Only apply them to nodes still in vNodes,
+    // which are not deleted while cs_vNodes is held.
+    bool fAccept = false;
+    std::map<NodeId, CNode*> mapEventNodes;
+    for (int i = 0; i < nEvents; i++) {
+        if (events[i].data.u64 == EPOLL_LISTEN_SOCKET)
+            fAccept = true;
+        else
+            mapEventNodes[(NodeId) events[i].data.u64] = NULL;
+    }
+    if (!mapEventNodes.empty()) {
+        LOCK(cs_vNodes);
+        BOOST_FOREACH(CNode * pnode, vNodes)
+        {
+            std::map<NodeId, CNode*>::iterator it = mapEventNodes.find(pnode->id);
+            if (it != mapEventNodes.end())
+                it->second = pnode;
+        }
+        for (int i = 0; i < nEvents; i++) {
+            if (events[i].data.u64 == EPOLL_LISTEN_SOCKET)
+                continue;
+            CNode *pnode = mapEventNodes[(NodeId) events[i].data.u64];
+            if (pnode == NULL)
+                continue;
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                pnode->fSocketRecvReady = true;
+            if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+                pnode->fSocketSendReady = true;
+        }
+    }
+    return fAccept;
+}
+
+/** Sends and receives on the socket of pnode as far as it is ready, with the same priorities as the select() loop */
+static void ServiceSocketEpoll(CNode *pnode) {
+    {
+        TRY_LOCK(pnode->cs_vSend, lockSend);
+        if (lockSend && !pnode->vSendMsg.empty()) {
+            if (pnode->fSocketSendReady) {
+                SocketSendData(pnode);
+                // anything left means the socket buffer is full, the next EPOLLOUT says when it isn't
+                if (!pnode->vSendMsg.empty())
+                    pnode->fSocketSendReady = false;
+            }
+            // drain the write buffer before receiving more
+            if (!pnode->vSendMsg.empty())
+                return;
+        }
+    }
+
+    TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
+    if (!lockRecv)
+        return;
+    while (pnode->fSocketRecvReady && CanReceiveMore(pnode)) {
+        if (!SocketRecvData(pnode))
+            pnode->fSocketRecvReady = false;
+    }
+}
+#endif
+
+bool InitSocketEvents() {
+#ifdef HAVE_SYS_EPOLL_H
+    if (hEpollSocket == INVALID_SOCKET) {
+        hEpollSocket = epoll_create1(EPOLL_CLOEXEC);
+        if (hEpollSocket == INVALID_SOCKET) {
+            LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
 void ThreadSocketHandler() {
     unsigned int nPrevNodeCount = 0;
     while (true) {
@@ -1063,6 +1256,15 @@ void ThreadSocketHandler() {
                     // release outbound grant (if any)
                     pnode->grantOutbound.Release();
 
+#ifdef HAVE_SYS_EPOLL_H
+                    // a forked child may keep the socket open after we close it, and with
+                    // it its registration, so take it out of the epoll set explicitly
+                    if (pnode->fSocketRegistered && pnode->hSocket != INVALID_SOCKET) {
+                        epoll_ctl(hEpollSocket, EPOLL_CTL_DEL, pnode->hSocket, NULL);
+                        pnode->fSocketRegistered = false;
+                    }
+#endif
+
                     // close socket and cleanup
                     pnode->CloseSocketDisconnect();
 
@@ -1117,82 +1319,102 @@ void ThreadSocketHandler() {
         FD_ZERO(&fdsetRecv);
         FD_ZERO(&fdsetSend);
         FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
-
-        BOOST_FOREACH(
-        const ListenSocket &hListenSocket, vhListenSocket) {
-            FD_SET(hListenSocket.socket, &fdsetRecv);
-            hSocketMax = std::max(hSocketMax, hListenSocket.socket);
-            have_fds = true;
-        }
+        bool fAccept = false;
 
+#ifdef HAVE_SYS_EPOLL_H
+        if (hEpollSocket != INVALID_SOCKET) {
+            fAccept = WaitForSocketEventsEpoll(timeout.tv_usec / 1000);
+        } else
+#endif
         {
-            LOCK(cs_vNodes);
-            BOOST_FOREACH(CNode * pnode, vNodes)
-            {
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-                FD_SET(pnode->hSocket, &fdsetError);
-                hSocketMax = std::max(hSocketMax, pnode->hSocket);
+            SOCKET hSocketMax = 0;
+            bool have_fds = false;
+
+            BOOST_FOREACH(
+            const ListenSocket &hListenSocket, vhListenSocket) {
+                FD_SET(hListenSocket.socket, &fdsetRecv);
+                hSocketMax = std::max(hSocketMax, hListenSocket.socket);
                 have_fds = true;
+            }
 
-                // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
-                //   happens when optimistic write failed, we choose to first drain the
-                //   write buffer in this case before receiving more. This avoids
-                //   needlessly queueing received data, if the remote peer is not themselves
-                //   receiving data. This means properly utilizing TCP flow control signalling.
-                // * Otherwise, if there is no (complete) message in the receive buffer,
-                //   or there is space left in the buffer, select() for receiving data.
-                // * (if neither of the above applies, there is certainly one message
-                //   in the receiver buffer ready to be processed).
-                // Together, that means that at least one of the following is always possible,
-                // so we don't deadlock:
-                // * We send some data.
-                // * We wait for data to be received (and disconnect after timeout).
-                // * We process a message in the buffer (message handler thread).
+            {
+                LOCK(cs_vNodes);
+                BOOST_FOREACH(CNode * pnode, vNodes)
                 {
-                    TRY_LOCK(pnode->cs_vSend, lockSend);
-                    if (lockSend && !pnode->vSendMsg.empty()) {
-                        FD_SET(pnode->hSocket, &fdsetSend);
+                    if (pnode->hSocket == INVALID_SOCKET)
                         continue;
+                    FD_SET(pnode->hSocket, &fdsetError);
+                    hSocketMax = std::max(hSocketMax, pnode->hSocket);
+                    have_fds = true;
+
+                    // Implement the following logic:
+                    // * If there is data to send, select() for sending data. As this only
+                    //   happens when optimistic write failed, we choose to first drain the
+                    //   write buffer in this case before receiving more. This avoids
+                    //   needlessly queueing received data, if the remote peer is not themselves
+                    //   receiving data. This means properly utilizing TCP flow control signalling.
+                    // * Otherwise, if there is no (complete) message in the receive buffer,
+                    //   or there is space left in the buffer, select() for receiving data.
+                    // * (if neither of the above applies, there is certainly one message
+                    //   in the receiver buffer ready to be processed).
+                    // Together, that means that at least one of the following is always possible,
+                    // so we don't deadlock:
+                    // * We send some data.
+                    // * We wait for data to be received (and disconnect after timeout).
+                    // * We process a message in the buffer (message handler thread).
+                    {
+                        TRY_LOCK(pnode->cs_vSend, lockSend);
+                        if (lockSend && !pnode->vSendMsg.empty()) {
+                            FD_SET(pnode->hSocket, &fdsetSend);
+                            continue;
+                        }
+                    }
+                    {
+                        TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
+                        if (lockRecv && CanReceiveMore(pnode))
+                            FD_SET(pnode->hSocket, &fdsetRecv);
                     }
-                }
-                {
-                    TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
-                    if (lockRecv && (
-                            pnode->vRecvMsg.empty() || !pnode->vRecvMsg.front().complete() ||
-                            pnode->GetTotalRecvSize() <= ReceiveFloodSize()))
-                        FD_SET(pnode->hSocket, &fdsetRecv);
                 }
             }
-        }
 
-        int nSelect = select(have_fds ? hSocketMax + 1 : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
-        boost::this_thread::interruption_point();
+            int nSelect = select(have_fds ? hSocketMax + 1 : 0,
+                                 &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+            boost::this_thread::interruption_point();
 
-        if (nSelect == SOCKET_ERROR) {
-            if (have_fds) {
-                int nErr = WSAGetLastError();
-                LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
+            if (nSelect == SOCKET_ERROR) {
+                if (have_fds) {
+                    int nErr = WSAGetLastError();
+                    LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
+                    for (unsigned int i = 0; i <= hSocketMax; i++)
+                        FD_SET(i, &fdsetRecv);
+                }
+                FD_ZERO(&fdsetSend);
+                FD_ZERO(&fdsetError);
+                MilliSleep(timeout.tv_usec / 1000);
+            }
+
+            BOOST_FOREACH(
+            const ListenSocket &hListenSocket, vhListenSocket)
+            {
+                if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+                    fAccept = true;
             }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            MilliSleep(timeout.tv_usec / 1000);
         }
 
         //
         // Accept new connections
         //
-        BOOST_FOREACH(
-        const ListenSocket &hListenSocket, vhListenSocket)
-        {
-            if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv)) {
-                AcceptConnection(hListenSocket);
+        if (fAccept) {
+            BOOST_FOREACH(
+            const ListenSocket &hListenSocket, vhListenSocket)
+            {
+#ifdef HAVE_SYS_EPOLL_H
+                // epoll only tells that one of the listening sockets is ready, the others fail with EWOULDBLOCK
+                if (hListenSocket.socket != INVALID_SOCKET && (hEpollSocket != INVALID_SOCKET || FD_ISSET(hListenSocket.socket, &fdsetRecv)))
+#else
+                if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+#endif
+                    AcceptConnection(hListenSocket);
             }
         }
 
@@ -1215,47 +1437,28 @@ void ThreadSocketHandler() {
             //
             if (pnode->hSocket == INVALID_SOCKET)
                 continue;
-            if (FD_ISSET(pnode->hSocket, &fdsetRecv) || FD_ISSET(pnode->hSocket, &fdsetError)) {
-                TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
-                if (lockRecv) {
-                    {
-                        // typical socket buffer is 8K-64K
-                        char pchBuf[0x10000];
-                        int nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                        if (nBytes > 0) {
-                            if (!pnode->ReceiveMsgBytes(pchBuf, nBytes))
-                                pnode->CloseSocketDisconnect();
-                            pnode->nLastRecv = GetTime();
-                            pnode->nRecvBytes += nBytes;
-                            pnode->RecordBytesRecv(nBytes);
-                        } else if (nBytes == 0) {
-                            // socket closed gracefully
-                            if (!pnode->fDisconnect)
-                                LogPrint("net", "socket closed\n");
-                            pnode->CloseSocketDisconnect();
-                        } else if (nBytes < 0) {
-                            // error
-                            int nErr = WSAGetLastError();
-                            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR &&
-                                nErr != WSAEINPROGRESS) {
-                                if (!pnode->fDisconnect)
-                                    LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
-                                pnode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
+#ifdef HAVE_SYS_EPOLL_H
+            if (hEpollSocket != INVALID_SOCKET) {
+                ServiceSocketEpoll(pnode);
+            } else
+#endif
+            {
+                if (FD_ISSET(pnode->hSocket, &fdsetRecv) || FD_ISSET(pnode->hSocket, &fdsetError)) {
+                    TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
+                    if (lockRecv)
+                        SocketRecvData(pnode);
                 }
-            }
 
-            //
-            // Send
-            //
-            if (pnode->hSocket == INVALID_SOCKET)
-                continue;
-            if (FD_ISSET(pnode->hSocket, &fdsetSend)) {
-                TRY_LOCK(pnode->cs_vSend, lockSend);
-                if (lockSend)
-                    SocketSendData(pnode);
+                //
+                // Send
+                //
+                if (pnode->hSocket == INVALID_SOCKET)
+                    continue;
+                if (FD_ISSET(pnode->hSocket, &fdsetSend)) {
+                    TRY_LOCK(pnode->cs_vSend, lockSend);
+                    if (lockSend)
+                        SocketSendData(pnode);
+                }
             }
 
             //
@@ -1780,6 +1983,10 @@ void ThreadMessageHandler() {
             if (pnode->fDisconnect)
                 continue;
 
+            // Wait for the worker, the next messages of this node may depend on the one it processes
+            if (pnode->fMessageInFlight)
+                continue;
+
             // Receive messages
             {
                 TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
@@ -1819,6 +2026,77 @@ void ThreadMessageHandler() {
 }
 
 
+static boost::mutex mutexMessageTasks;
+static boost::condition_variable condMessageTasks;
+static std::deque<std::pair<CNode*, boost::function<void()> > > queueMessageTasks;
+static int nMessageWorkers = 0;
+// set once the workers are interrupted, messages are processed on the handler thread again
+static bool fMessageWorkersStopped = false;
+
+/** Hands a node whose message task is done back to the message handler thread */
+static void FinishMessageTask(CNode* pnode) {
+    pnode->fMessageInFlight = false;
+    {
+        LOCK(cs_vNodes);
+        pnode->Release();
+    }
+    // the node may have more messages waiting
+    messageHandlerCondition.notify_one();
+}
+
+bool QueueMessageTask(CNode* pnode, const boost::function<void()>& task) {
+    if (nMessageWorkers == 0)
+        return false;
+    {
+        boost::unique_lock<boost::mutex> lock(mutexMessageTasks);
+        if (fMessageWorkersStopped)
+            return false;
+        {
+            LOCK(cs_vNodes);
+            pnode->AddRef();
+        }
+        pnode->fMessageInFlight = true;
+        queueMessageTasks.push_back(std::make_pair(pnode, task));
+    }
+    condMessageTasks.notify_one();
+    return true;
+}
+
+void ThreadMessageWorker() {
+    CNode* pnodeTask = NULL;
+    try {
+        while (true) {
+            boost::function<void()> task;
+            {
+                boost::unique_lock<boost::mutex> lock(mutexMessageTasks);
+                while (queueMessageTasks.empty())
+                    condMessageTasks.wait(lock);
+                pnodeTask = queueMessageTasks.front().first;
+                task = queueMessageTasks.front().second;
+                queueMessageTasks.pop_front();
+            }
+
+            task();
+            FinishMessageTask(pnodeTask);
+            pnodeTask = NULL;
+        }
+    }
+    catch (const boost::thread_interrupted&) {
+        if (pnodeTask != NULL)
+            FinishMessageTask(pnodeTask);
+        // release the nodes of the tasks no worker will run anymore
+        std::deque<std::pair<CNode*, boost::function<void()> > > queueDropped;
+        {
+            boost::unique_lock<boost::mutex> lock(mutexMessageTasks);
+            fMessageWorkersStopped = true;
+            queueDropped.swap(queueMessageTasks);
+        }
+        for (size_t i = 0; i < queueDropped.size(); i++)
+            FinishMessageTask(queueDropped[i].first);
+        throw;
+    }
+}
+
 bool BindListenPort(const CService &addrBind, std::string &strError, bool fWhitelisted) {
     strError = "";
     int nOne = 1;
@@ -1908,6 +2186,22 @@ bool BindListenPort(const CService &addrBind, std::string &strError, bool fWhite
         return false;
     }
 
+#ifdef HAVE_SYS_EPOLL_H
+    if (hEpollSocket != INVALID_SOCKET) {
+        // level triggered, connections we couldn't accept yet are reported again
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = EPOLL_LISTEN_SOCKET;
+        if (epoll_ctl(hEpollSocket, EPOLL_CTL_ADD, hListenSocket, &event) == SOCKET_ERROR) {
+            strError = strprintf(_("Error: Listening for incoming connections failed (epoll_ctl returned error %s)"),
+                                 NetworkErrorString(WSAGetLastError()));
+            LogPrintf("%s\n", strError);
+            CloseSocket(hListenSocket);
+            return false;
+        }
+    }
+#endif
+
     vhListenSocket.push_back(ListenSocket(hListenSocket, fWhitelisted));
 
     if (addrBind.IsRoutable() && fDiscover && !fWhitelisted)
@@ -2031,6 +2325,9 @@ void StartNode(boost::thread_group &threadGroup, CScheduler &scheduler) {
     threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "opencon", &ThreadOpenConnections));
 
     // Process messages
+    nMessageWorkers = std::max(0, std::min((int)GetArg("-msghandlerthreads", DEFAULT_MSGHANDLER_THREADS), MAX_MSGHANDLER_THREADS));
+    for (int i = 0; i < nMessageWorkers; i++)
+        threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "msgworker", &ThreadMessageWorker));
     threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "msghand", &ThreadMessageHandler));
 
     // Dump network addresses
@@ -2057,6 +2354,10 @@ public:
     CNetCleanup() {}
 
     ~CNetCleanup() {
+#ifdef HAVE_SYS_EPOLL_H
+        if (hEpollSocket != INVALID_SOCKET)
+            close(hEpollSocket);
+#endif
         // Close sockets
         BOOST_FOREACH(CNode * pnode, vNodes)
         if (pnode->hSocket != INVALID_SOCKET)
@@ -2372,6 +2673,10 @@ CNode::CNode(SOCKET hSocketIn, const CAddress &addrIn, const std::string &addrNa
     fNetworkNode = false;
     fSuccessfullyConnected = false;
     fDisconnect = false;
+    fMessageInFlight = false;
+    fSocketRegistered = false;
+    fSocketRecvReady = false;
+    fSocketSendReady = false;
     nRefCount = 0;
     nSendSize = 0;
     nSendOffset = 0;
@@ -27,6 +27,7 @@
 
 #include <boost/filesystem/path.hpp>
 #include <boost/foreach.hpp>
+#include <boost/function.hpp>
 #include <boost/signals2/signal.hpp>
 
 class CAddrMan;
@@ -73,6 +74,10 @@ static const bool DEFAULT_BLOCKSONLY = false;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** Default for -msghandlerthreads, the workers that process bznode payment votes next to the message handler thread */
+static const int DEFAULT_MSGHANDLER_THREADS = 2;
+/** Maximum number of message workers */
+static const int MAX_MSGHANDLER_THREADS = 16;
 
 static const ServiceFlags REQUIRED_SERVICES = NODE_NETWORK;
 
@@ -97,10 +102,19 @@ CNode* ConnectNode(CAddress addrConnect, const char *pszDest = NULL, bool fCount
 bool OpenNetworkConnection(const CAddress& addrConnect, bool fCountFailure, CSemaphoreGrant *grantOutbound = NULL, const char *strDest = NULL, bool fOneShot = false, bool fFeeler = false);
 void MapPort(bool fUseUPnP);
 unsigned short GetListenPort();
+/** Set up waiting for socket events, i.e. create the epoll instance when built with epoll */
+bool InitSocketEvents();
 bool BindListenPort(const CService &bindAddr, std::string& strError, bool fWhitelisted = false);
 void StartNode(boost::thread_group& threadGroup, CScheduler& scheduler);
 bool StopNode();
 void SocketSendData(CNode *pnode);
+/**
+ * Runs task, which processes a message of pnode, on a message worker. The message
+ * handler thread leaves pnode alone until the task is done, so the messages of a
+ * peer are still processed one at a time and in order.
+ * Returns false if there are no message workers.
+ */
+bool QueueMessageTask(CNode* pnode, const boost::function<void()>& task);
 
 struct CombinerAll
 {
@@ -256,6 +270,8 @@ public:
 
     int readHeader(const char *pch, unsigned int nBytes);
     int readData(const char *pch, unsigned int nBytes);
+    // Buffer for nSpace bytes of the payload still to come, to receive them without a copy
+    char *prepareData(unsigned int &nSpace);
 };
 
 
@@ -362,6 +378,12 @@ public:
     bool fNetworkNode;
     bool fSuccessfullyConnected;
     bool fDisconnect;
+    // A message of this node is being processed by a message worker
+    std::atomic<bool> fMessageInFlight;
+    // State of the socket in the epoll set of the socket handler, only used by that thread
+    bool fSocketRegistered;
+    bool fSocketRecvReady;
+    bool fSocketSendReady;
     // We use fRelayTxes for two purposes -
     // a) it allows us to not relay tx invs before receiving the peer's version message
     // b) the peer may tell us in its version message that we should not relay tx invs
@@ -474,6 +496,9 @@ private:
 
     static uint64_t CalculateKeyedNetGroup(const CAddress& ad);
 
+    // requires LOCK(cs_vRecvMsg)
+    void MsgComplete(CNetMessage &msg);
+
 public:
 
     NodeId GetId() const {
@@ -499,6 +524,10 @@ public:
     // requires LOCK(cs_vRecvMsg)
     bool ReceiveMsgBytes(const char *pch, unsigned int nBytes);
 
+    // requires LOCK(cs_vRecvMsg)
+    // Accounts for nBytes of payload received in place, see CNetMessage::prepareData()
+    void ReceiveMsgData(CNetMessage &msg, unsigned int nBytes);
+
     // requires LOCK(cs_vRecvMsg)
     void SetRecvVersion(int nVersionIn)
     {
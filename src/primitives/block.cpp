@@ -20,23 +20,59 @@
 #include <chrono>
 #include <fstream>
 #include <algorithm>
+#include <new>
 #include <string>
 
+#include <boost/thread/tss.hpp>
+
 uint256 CBlockHeader::GetHash() const
 {
     return SerializeHash(*this);
 }
 
+namespace {
+
+/** Lyra2 memory matrix owned by a single thread and reused for every PoW hash it computes */
+class CLyra2Matrix
+{
+public:
+    lyra2_ctx ctx;
+
+    CLyra2Matrix(uint64_t nRows, uint64_t nCols)
+    {
+        if (LYRA2_init(&ctx, nRows, nCols) != 0)
+            throw std::bad_alloc();
+    }
+
+    ~CLyra2Matrix()
+    {
+        LYRA2_free(&ctx);
+    }
+};
+
+boost::thread_specific_ptr<CLyra2Matrix> lyra2zMatrix;
+boost::thread_specific_ptr<CLyra2Matrix> lyra2Matrix;
+
+lyra2_ctx* GetThreadLyra2Context(boost::thread_specific_ptr<CLyra2Matrix>& matrix, uint64_t nRows, uint64_t nCols)
+{
+    // thread_specific_ptr frees the matrix automatically when the thread ends.
+    if (!matrix.get())
+        matrix.reset(new CLyra2Matrix(nRows, nCols));
+    return &matrix->ctx;
+}
+
+}
+
 uint256 CBlockHeader::GetPoWHash(int nHeight) const
 {
     uint256 powHash;
     if (nHeight >= HF_ALGO)
     {
-    lyra2z_hash(BEGIN(nVersion), BEGIN(powHash));
+    lyra2z_hash_ctx(GetThreadLyra2Context(lyra2zMatrix, 8, 8), BEGIN(nVersion), BEGIN(powHash));
     }
     else
     {
-    LYRA2(BEGIN(powHash), 32, BEGIN(nVersion), 80, BEGIN(nVersion), 80, 2, 330, 256);
+    LYRA2_hash(GetThreadLyra2Context(lyra2Matrix, 330, 256), BEGIN(powHash), 32, BEGIN(nVersion), 80, BEGIN(nVersion), 80, 2);
     }
 
     return powHash;
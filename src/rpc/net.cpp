@@ -7,6 +7,7 @@
 #include "chainparams.h"
 #include "clientversion.h"
 #include "main.h"
+#include "messagedispatch.h"
 #include "net.h"
 #include "netbase.h"
 #include "protocol.h"
@@ -376,6 +377,45 @@ UniValue getnettotals(const UniValue& params, bool fHelp)
     return obj;
 }
 
+UniValue getmessagestats(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() > 0)
+        throw runtime_error(
+            "getmessagestats\n"
+            "\nReturns how many messages of every command were received from peers and how long\n"
+            "the message handler thread spent processing them, since the node started.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"command\": {             (string) The message command, \"*other*\" for unknown commands\n"
+            "    \"count\": n,            (numeric) Number of messages processed\n"
+            "    \"bytes\": n,            (numeric) Total payload size of these messages\n"
+            "    \"totaltime\": n,        (numeric) Total processing time in seconds\n"
+            "    \"maxtime\": n           (numeric) Longest processing time of one message in seconds\n"
+            "  }\n"
+            "  ,...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getmessagestats", "")
+            + HelpExampleRpc("getmessagestats", "")
+        );
+
+    std::map<std::string, CMessageStats> mapStats = messageDispatcher.GetStats();
+
+    UniValue ret(UniValue::VOBJ);
+    for (std::map<std::string, CMessageStats>::const_iterator it = mapStats.begin(); it != mapStats.end(); ++it) {
+        const CMessageStats& stats = it->second;
+        if (stats.nCount == 0)
+            continue;
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("count", stats.nCount));
+        obj.push_back(Pair("bytes", stats.nBytes));
+        obj.push_back(Pair("totaltime", stats.nTimeMicros / 1e6));
+        obj.push_back(Pair("maxtime", stats.nMaxTimeMicros / 1e6));
+        ret.push_back(Pair(it->first, obj));
+    }
+    return ret;
+}
+
 static UniValue GetNetworksInfo()
 {
     UniValue networks(UniValue::VARR);
@@ -581,6 +621,7 @@ static const CRPCCommand commands[] =
     { "network",            "disconnectnode",         &disconnectnode,         true  },
     { "network",            "getaddednodeinfo",       &getaddednodeinfo,       true  },
     { "network",            "getnettotals",           &getnettotals,           true  },
+    { "network",            "getmessagestats",        &getmessagestats,        true  },
     { "network",            "getnetworkinfo",         &getnetworkinfo,         true  },
     { "network",            "setban",                 &setban,                 true  },
     { "network",            "listbanned",             &listbanned,             true  },
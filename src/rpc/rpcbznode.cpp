@@ -100,7 +100,7 @@ UniValue bznode(const UniValue &params, bool fHelp) {
          strCommand != "start-disabled" && strCommand != "list" && strCommand != "list-conf" && strCommand != "count" &&
          strCommand != "debug" && strCommand != "current" && strCommand != "winner" && strCommand != "winners" &&
          strCommand != "genkey" &&
-         strCommand != "connect" && strCommand != "outputs" && strCommand != "status"))
+         strCommand != "connect" && strCommand != "outputs" && strCommand != "status" && strCommand != "sigcache" && strCommand != "maintenance"))
         throw std::runtime_error(
                 "bznode \"command\"...\n"
                         "Set of commands to execute bznode related actions\n"
@@ -111,7 +111,9 @@ UniValue bznode(const UniValue &params, bool fHelp) {
                         "  current      - Print info on current bznode winner to be paid the next block (calculated locally)\n"
                         "  debug        - Print bznode status\n"
                         "  genkey       - Generate new bznodeprivkey\n"
+                        "  maintenance  - Print runs, total and longest time in seconds of every maintenance task\n"
                         "  outputs      - Print bznode compatible outputs\n"
+                        "  sigcache     - Print size, hits and misses of the bznode message signature cache\n"
                         "  start        - Start local Hot bznode configured in bitcoinzero.conf\n"
                         "  start-alias  - Start single remote bznode by assigned alias configured in bznode.conf\n"
                         "  start-<mode> - Start remote bznodes configured in bznode.conf (<mode>: 'all', 'missing', 'disabled')\n"
@@ -173,6 +175,29 @@ UniValue bznode(const UniValue &params, bool fHelp) {
                              mnodeman.CountEnabled(), nCount);
     }
 
+    if (strCommand == "sigcache") {
+        CMessageSigCache& sigCache = darkSendSigner.GetSigCache();
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("size", (uint64_t)sigCache.Size()));
+        obj.push_back(Pair("hits", sigCache.GetHits()));
+        obj.push_back(Pair("misses", sigCache.GetMisses()));
+        return obj;
+    }
+
+    if (strCommand == "maintenance") {
+        std::map<std::string, CMaintenanceStats> mapStats = GetMaintenanceStats();
+        UniValue obj(UniValue::VOBJ);
+        for (std::map<std::string, CMaintenanceStats>::const_iterator it = mapStats.begin(); it != mapStats.end(); ++it) {
+            const CMaintenanceStats& stats = it->second;
+            UniValue taskObj(UniValue::VOBJ);
+            taskObj.push_back(Pair("count", stats.nCount));
+            taskObj.push_back(Pair("totaltime", stats.nTimeMicros / 1e6));
+            taskObj.push_back(Pair("maxtime", stats.nMaxTimeMicros / 1e6));
+            obj.push_back(Pair(it->first, taskObj));
+        }
+        return obj;
+    }
+
     if (strCommand == "current" || strCommand == "winner") {
         int nCount;
         int nHeight;
@@ -9,6 +9,9 @@
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "crypto/Lyra2Z/Lyra2Z.h"
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Sponge.h"
 #include "random.h"
 #include "utilstrencodings.h"
 #include "test/test_bitcoin.h"
@@ -439,4 +442,55 @@ BOOST_AUTO_TEST_CASE(aes_cbc_testvectors) {
                   "b2eb05e2c39be9fcda6c19078c6a9d1b3f461796d6b0d6b2e0c2a72b4d80e644");
 }
 
+BOOST_AUTO_TEST_CASE(lyra2_context_reuse) {
+    // A reused memory matrix must give the same results as a freshly allocated one
+    lyra2_ctx ctx8, ctx330;
+    BOOST_CHECK_EQUAL(LYRA2_init(&ctx8, 8, 8), 0);
+    BOOST_CHECK_EQUAL(LYRA2_init(&ctx330, 330, 256), 0);
+    for (int i = 0; i < 4; i++) {
+        std::vector<unsigned char> header(80);
+        GetRandBytes(&header[0], header.size());
+        unsigned char expected[32], result[32];
+
+        lyra2z_hash((const char*)&header[0], (char*)expected);
+        lyra2z_hash_ctx(&ctx8, (const char*)&header[0], (char*)result);
+        BOOST_CHECK(memcmp(expected, result, 32) == 0);
+
+        BOOST_CHECK_EQUAL(LYRA2(expected, 32, &header[0], 80, &header[0], 80, 2, 330, 256), 0);
+        BOOST_CHECK_EQUAL(LYRA2_hash(&ctx330, result, 32, &header[0], 80, &header[0], 80, 2), 0);
+        BOOST_CHECK(memcmp(expected, result, 32) == 0);
+    }
+    LYRA2_free(&ctx8);
+    LYRA2_free(&ctx330);
+}
+
+BOOST_AUTO_TEST_CASE(lyra2_simd) {
+    // Every sponge implementation supported by this CPU must match the scalar reference
+    int nDefaultImpl = spongeGetImpl();
+    std::vector<unsigned char> input(80);
+    for (unsigned int i = 0; i < input.size(); i++)
+        input[i] = i;
+    for (int impl = SPONGE_IMPL_SCALAR; impl <= SPONGE_IMPL_AVX2; impl++) {
+        if (!spongeSetImpl(impl))
+            continue;
+        unsigned char result[32];
+        BOOST_CHECK_EQUAL(LYRA2(result, 32, &input[0], 80, &input[0], 80, 8, 8, 8), 0);
+        BOOST_CHECK_EQUAL(HexStr(result, result + 32), "ea355bda2f66e86076dcc10acb3259c537513f17e4b2d1fb07dba08479743a4b");
+        BOOST_CHECK_EQUAL(LYRA2(result, 32, &input[0], 80, &input[0], 80, 2, 330, 256), 0);
+        BOOST_CHECK_EQUAL(HexStr(result, result + 32), "bbc07308856eef2305237fd2aa662c6573d2e173fddee568788bc30048d54ab0");
+
+        for (int i = 0; i < 4; i++) {
+            std::vector<unsigned char> header(80);
+            GetRandBytes(&header[0], header.size());
+            unsigned char expected[32];
+            spongeSetImpl(SPONGE_IMPL_SCALAR);
+            lyra2z_hash((const char*)&header[0], (char*)expected);
+            spongeSetImpl(impl);
+            lyra2z_hash((const char*)&header[0], (char*)result);
+            BOOST_CHECK(memcmp(expected, result, 32) == 0);
+        }
+    }
+    spongeSetImpl(nDefaultImpl);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,257 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "checkqueue.h"
+#include "clientversion.h"
+#include "hash.h"
+#include "random.h"
+#include "streams.h"
+#include "utilstrencodings.h"
+#include "zerocoin.h"
+#include "zerocoin_params_blob.h"
+
+#include "test/test_bitcoin.h"
+
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace libzerocoin;
+
+BOOST_FIXTURE_TEST_SUITE(zerocoin_tests, BasicTestingSetup)
+
+/** Product of base^exponent over all terms computed with one pow_mod per term */
+static CBigNum ChainedPowMod(const std::vector<std::pair<CBigNum, CBigNum> >& terms, const CBigNum& modulus)
+{
+    CBigNum result = 1;
+    for (size_t i = 0; i < terms.size(); i++)
+        result = result.mul_mod(terms[i].first.pow_mod(terms[i].second, modulus), modulus);
+    return result;
+}
+
+static void CheckMultiExp(const IntegerGroupParams& group)
+{
+    const CBigNum& modulus = group.modulus;
+    MontgomeryGroup mg(modulus);
+    int nG = mg.addFixedBase(group.g, group.groupOrder.bitSize());
+    int nH = mg.addFixedBase(group.h, group.groupOrder.bitSize());
+
+    std::vector<CBigNum> exponents;
+    exponents.push_back(0);
+    exponents.push_back(1);
+    exponents.push_back(-1);
+    exponents.push_back(CBigNum::randBignum(group.groupOrder));
+    exponents.push_back(-CBigNum::randBignum(group.groupOrder));
+    // larger than the fixed-base tables
+    exponents.push_back(CBigNum::randBignum(modulus * modulus));
+    exponents.push_back(-CBigNum::randBignum(modulus * modulus));
+
+    // one base below and one at or above the modulus
+    std::vector<CBigNum> bases;
+    bases.push_back(CBigNum::randBignum(modulus));
+    bases.push_back(modulus + CBigNum::randBignum(modulus));
+
+    for (size_t i = 0; i < exponents.size(); i++) {
+        const CBigNum& eG = exponents[i];
+        BOOST_CHECK(mg.pow(nG, eG) == group.g.pow_mod(eG, modulus));
+
+        for (size_t j = 0; j < exponents.size(); j++) {
+            const CBigNum& eH = exponents[j];
+            const CBigNum& base = bases[(i + j) % bases.size()];
+            const CBigNum& e = exponents[(i + 2 * j) % exponents.size()];
+
+            std::vector<std::pair<CBigNum, CBigNum> > terms;
+            terms.push_back(std::make_pair(group.g, eG));
+            terms.push_back(std::make_pair(group.h, eH));
+            BOOST_CHECK(mg.multiExp({MontgomeryGroup::FixedTerm(nG, eG), MontgomeryGroup::FixedTerm(nH, eH)}) == ChainedPowMod(terms, modulus));
+
+            terms.push_back(std::make_pair(base, e));
+            BOOST_CHECK(mg.multiExp({MontgomeryGroup::FixedTerm(nG, eG), MontgomeryGroup::FixedTerm(nH, eH)},
+                                    {MontgomeryGroup::Term(base, e)}) == ChainedPowMod(terms, modulus));
+        }
+    }
+
+    // no terms at all
+    BOOST_CHECK(mg.multiExp(std::vector<MontgomeryGroup::FixedTerm>()) == CBigNum(1));
+    BOOST_CHECK(mg.getInverse(nG).mul_mod(group.g, modulus) == CBigNum(1));
+}
+
+BOOST_AUTO_TEST_CASE(bignum_move)
+{
+    CBigNum a = 12345;
+    CBigNum b(std::move(a));
+    BOOST_CHECK(b == CBigNum(12345));
+    // the moved-from number is still usable
+    BOOST_CHECK(a == CBigNum(0));
+    a += 7;
+    BOOST_CHECK(a == CBigNum(7));
+
+    CBigNum c = 99;
+    c = std::move(b);
+    BOOST_CHECK(c == CBigNum(12345));
+    BOOST_CHECK(b == CBigNum(99));
+    b = a;
+    BOOST_CHECK(b == CBigNum(7));
+}
+
+BOOST_AUTO_TEST_CASE(multiexp_matches_pow_mod)
+{
+    const libzerocoin::Params* params = ZCParamsV2();
+    CheckMultiExp(params->accumulatorParams.accumulatorPoKCommitmentGroup);
+    CheckMultiExp(params->accumulatorParams.accumulatorQRNCommitmentGroup);
+    CheckMultiExp(params->serialNumberSoKCommitmentGroup);
+}
+
+BOOST_AUTO_TEST_CASE(accumulator_proof_of_knowledge)
+{
+    const libzerocoin::Params* params = ZCParamsV2();
+    PrivateCoin coin(params, ZQ_LOVELACE, ZEROCOIN_TX_VERSION_2);
+    Accumulator accumulator(params, ZQ_LOVELACE);
+    AccumulatorWitness witness(params, accumulator, coin.getPublicCoin());
+    for (int i = 0; i < 3; i++) {
+        PrivateCoin other(params, ZQ_LOVELACE, ZEROCOIN_TX_VERSION_2);
+        accumulator += other.getPublicCoin();
+        witness += other.getPublicCoin();
+    }
+    accumulator += coin.getPublicCoin();
+
+    Commitment commitmentToCoin(&params->accumulatorParams.accumulatorPoKCommitmentGroup, coin.getPublicCoin().getValue());
+    AccumulatorProofOfKnowledge pok(&params->accumulatorParams, commitmentToCoin, witness, accumulator);
+    BOOST_CHECK(pok.Verify(accumulator, commitmentToCoin.getCommitmentValue()));
+
+    // Wrong accumulator or commitment
+    Accumulator otherAccumulator(accumulator);
+    otherAccumulator += PrivateCoin(params, ZQ_LOVELACE, ZEROCOIN_TX_VERSION_2).getPublicCoin();
+    BOOST_CHECK(!pok.Verify(otherAccumulator, commitmentToCoin.getCommitmentValue()));
+    Commitment otherCommitment(&params->accumulatorParams.accumulatorPoKCommitmentGroup, coin.getPublicCoin().getValue());
+    BOOST_CHECK(!pok.Verify(accumulator, otherCommitment.getCommitmentValue()));
+
+    // A serialized copy verifies, one with a changed byte does not
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << pok;
+    CDataStream ssTampered(ss);
+
+    AccumulatorProofOfKnowledge pokCopy(&params->accumulatorParams);
+    ss >> pokCopy;
+    BOOST_CHECK(pokCopy.Verify(accumulator, commitmentToCoin.getCommitmentValue()));
+
+    ssTampered[15] ^= 1;
+    AccumulatorProofOfKnowledge pokTampered(&params->accumulatorParams);
+    ssTampered >> pokTampered;
+    BOOST_CHECK(!pokTampered.Verify(accumulator, commitmentToCoin.getCommitmentValue()));
+}
+
+static void AddSpendChecks(CCheckQueueControl<CZerocoinSpendCheck>& control, const libzerocoin::Params* params,
+                           const CoinSpend& spend, const SpendMetaData& metaData,
+                           const std::vector<CBigNum>& accumulatorValues, int nChecks)
+{
+    std::vector<CZerocoinSpendCheck> vChecks;
+    for (int i = 0; i < nChecks; i++) {
+        vChecks.push_back(CZerocoinSpendCheck(params, spend, ZQ_LOVELACE, metaData));
+        for (size_t j = 0; j < accumulatorValues.size(); j++)
+            vChecks.back().AddAccumulatorValue(accumulatorValues[j], GetRandHash());
+    }
+    control.Add(vChecks);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_spend_checks)
+{
+    const libzerocoin::Params* params = ZCParamsV2();
+    PrivateCoin coin(params, ZQ_LOVELACE, ZEROCOIN_TX_VERSION_2);
+    Accumulator accumulator(params, ZQ_LOVELACE);
+    AccumulatorWitness witness(params, accumulator, coin.getPublicCoin());
+    PrivateCoin other(params, ZQ_LOVELACE, ZEROCOIN_TX_VERSION_2);
+    accumulator += other.getPublicCoin();
+    witness += other.getPublicCoin();
+    accumulator += coin.getPublicCoin();
+
+    SpendMetaData metaData(0, uint256());
+    CoinSpend spend(params, coin, accumulator, witness, metaData);
+    spend.setVersion(ZEROCOIN_TX_VERSION_2);
+
+    Accumulator otherAccumulator(accumulator);
+    otherAccumulator += PrivateCoin(params, ZQ_LOVELACE, ZEROCOIN_TX_VERSION_2).getPublicCoin();
+
+    boost::thread_group threadGroup;
+    CCheckQueue<CZerocoinSpendCheck> queue(4);
+    for (int i = 0; i < 4; i++)
+        threadGroup.create_thread(boost::bind(&CCheckQueue<CZerocoinSpendCheck>::Thread, boost::ref(queue)));
+
+    std::vector<CBigNum> vGood(1, accumulator.getValue());
+    std::vector<CBigNum> vBad(1, otherAccumulator.getValue());
+    // a check passes if the spend verifies against any of its accumulator values
+    std::vector<CBigNum> vBadThenGood;
+    vBadThenGood.push_back(otherAccumulator.getValue());
+    vBadThenGood.push_back(accumulator.getValue());
+
+    {
+        CCheckQueueControl<CZerocoinSpendCheck> control(&queue);
+        AddSpendChecks(control, params, spend, metaData, vGood, 6);
+        AddSpendChecks(control, params, spend, metaData, vBadThenGood, 2);
+        BOOST_CHECK(control.Wait());
+    }
+
+    // One failing check fails the whole batch
+    {
+        CCheckQueueControl<CZerocoinSpendCheck> control(&queue);
+        AddSpendChecks(control, params, spend, metaData, vGood, 4);
+        AddSpendChecks(control, params, spend, metaData, vBad, 1);
+        AddSpendChecks(control, params, spend, metaData, vGood, 3);
+        BOOST_CHECK(!control.Wait());
+    }
+
+    // So does a spend signed over other metadata
+    {
+        CCheckQueueControl<CZerocoinSpendCheck> control(&queue);
+        AddSpendChecks(control, params, spend, SpendMetaData(1, uint256()), vGood, 1);
+        BOOST_CHECK(!control.Wait());
+    }
+
+    // The queue is ready for the next block after a failure
+    {
+        CCheckQueueControl<CZerocoinSpendCheck> control(&queue);
+        AddSpendChecks(control, params, spend, metaData, vGood, 2);
+        BOOST_CHECK(control.Wait());
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+/** Checks that the embedded blob holds exactly the parameters derived from the modulus, and that they are what params is */
+static void CheckParamsBlob(libzerocoin::Params* params, const char* pszModulus, const char* pszBlob, const char* pszBlobHash)
+{
+    libzerocoin::Params derived(CBigNum(pszModulus), CBigNum(ZEROCOIN_MODULUS));
+    CDataStream ssDerived(SER_DISK, CLIENT_VERSION);
+    ssDerived << derived;
+
+    std::vector<unsigned char> blob = ParseHex(pszBlob);
+    BOOST_CHECK(Hash(blob.begin(), blob.end()) == uint256S(pszBlobHash));
+    BOOST_CHECK(std::vector<unsigned char>(ssDerived.begin(), ssDerived.end()) == blob);
+
+    libzerocoin::Params fromBlob;
+    CDataStream ssBlob(blob, SER_DISK, CLIENT_VERSION);
+    ssBlob >> fromBlob;
+    BOOST_CHECK(ssBlob.empty());
+    BOOST_CHECK(fromBlob.initialized);
+    CDataStream ssFromBlob(SER_DISK, CLIENT_VERSION);
+    ssFromBlob << fromBlob;
+    BOOST_CHECK(ssFromBlob.str() == ssDerived.str());
+
+    CDataStream ssParams(SER_DISK, CLIENT_VERSION);
+    ssParams << *params;
+    BOOST_CHECK(ssParams.str() == ssDerived.str());
+}
+
+BOOST_AUTO_TEST_CASE(params_blob_matches_derived_params)
+{
+    CheckParamsBlob(ZCParams(), ZEROCOIN_MODULUS, ZEROCOIN_PARAMS_BLOB, ZEROCOIN_PARAMS_BLOB_HASH);
+    CheckParamsBlob(ZCParamsV2(), ZEROCOIN_MODULUS_V2, ZEROCOIN_PARAMS_V2_BLOB, ZEROCOIN_PARAMS_V2_BLOB_HASH);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -10,6 +10,7 @@
 #include "pow.h"
 #include "uint256.h"
 #include "main.h"
+#include "zerocoin.h"
 
 #include <stdint.h>
 
@@ -25,6 +26,9 @@ static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
 static const char DB_BLOCK_INDEX = 'b';
+static const char DB_BLOCK_POWHASH = 'w';
+static const char DB_ZEROCOIN_DATA = 'z';
+static const char DB_ZEROCOIN_STATE = 'Z';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_FLAG = 'F';
@@ -74,7 +78,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     return db.WriteBatch(batch);
 }
 
-CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe) {
+CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe), fWrittenByOlderClient(false) {
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -141,7 +145,8 @@ void CCoinsViewDBCursor::Next()
         keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
 }
 
-bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
+bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                                  const std::vector<std::pair<uint256, const CZerocoinBlockData*> >& zerocoinData) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<int, const CBlockFileInfo*> >::const_iterator it=fileInfo.begin(); it != fileInfo.end(); it++) {
         batch.Write(make_pair(DB_BLOCK_FILES, it->first), *it->second);
@@ -149,10 +154,30 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     batch.Write(DB_LAST_BLOCK, nLastFile);
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
         batch.Write(make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
+        if ((*it)->nStatus & BLOCK_HAVE_POWHASH)
+            batch.Write(make_pair(DB_BLOCK_POWHASH, (*it)->GetBlockHash()), (*it)->hashPoW);
+    }
+    for (std::vector<std::pair<uint256, const CZerocoinBlockData*> >::const_iterator it=zerocoinData.begin(); it != zerocoinData.end(); it++) {
+        if (it->second->IsNull())
+            batch.Erase(make_pair(DB_ZEROCOIN_DATA, it->first));
+        else
+            batch.Write(make_pair(DB_ZEROCOIN_DATA, it->first), *it->second);
     }
     return WriteBatch(batch, true);
 }
 
+bool CBlockTreeDB::ReadZerocoinBlockData(const uint256 &hash, CZerocoinBlockData &data) {
+    return Read(make_pair(DB_ZEROCOIN_DATA, hash), data);
+}
+
+bool CBlockTreeDB::ReadZerocoinStateSnapshot(CZerocoinStateSnapshot &snapshot) {
+    return Read(DB_ZEROCOIN_STATE, snapshot);
+}
+
+bool CBlockTreeDB::WriteZerocoinStateSnapshot(const CZerocoinStateSnapshot &snapshot) {
+    return Write(DB_ZEROCOIN_STATE, snapshot, true);
+}
+
 bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
     return Read(make_pair(DB_TXINDEX, txid), pos);
 }
@@ -312,6 +337,15 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
 
     pcursor->Seek(make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // Entries written before BLOCK_HAVE_ZCDATA_COUNTS carry their zerocoin data inline, move it out. Once that
+    // is done the flag is set: an entry without the counts after that was written by an older client, which
+    // found no zerocoin data in the index, and the index has to be rebuilt.
+    bool fZerocoinDataApart = false;
+    ReadFlag("zerocoinblockdata", fZerocoinDataApart);
+    fWrittenByOlderClient = false;
+    CDBBatch batchUpgrade(*this);
+    unsigned int nUpgradeBatchSize = 0, nUpgraded = 0;
+
     // Load mapBlockIndex
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
@@ -331,15 +365,38 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
                 pindexNew->nTime          = diskindex.nTime;
                 pindexNew->nBits          = diskindex.nBits;
                 pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
+                // set again below if the PoW hash record is there
+                pindexNew->nStatus        = diskindex.nStatus & ~BLOCK_HAVE_POWHASH;
                 pindexNew->nTx            = diskindex.nTx;
 
-                pindexNew->accumulatorChanges = diskindex.accumulatorChanges;
-                pindexNew->mintedPubCoins     = diskindex.mintedPubCoins;
-                pindexNew->spentSerials       = diskindex.spentSerials;
+                if (!(diskindex.nStatus & BLOCK_HAVE_ZCDATA_COUNTS)) {
+                    if (fZerocoinDataApart) {
+                        fWrittenByOlderClient = true;
+                        return error("LoadBlockIndex() : block index entry %s was written by an older client", key.second.ToString());
+                    }
+                    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, diskindex.zerocoinData.accumulatorChanges)
+                        diskindex.zerocoinMintCounts[accUpdate.first] = accUpdate.second.second;
+                    diskindex.nZerocoinSpends = diskindex.zerocoinData.spentSerials.size();
+                    if (!diskindex.zerocoinData.IsNull())
+                        batchUpgrade.Write(make_pair(DB_ZEROCOIN_DATA, key.second), diskindex.zerocoinData);
+                    diskindex.zerocoinData = CZerocoinBlockData();
+                    diskindex.nStatus |= BLOCK_HAVE_ZCDATA_COUNTS;
+                    batchUpgrade.Write(key, diskindex);
+                    nUpgraded++;
+                    if (++nUpgradeBatchSize >= 10000) {
+                        if (!WriteBatch(batchUpgrade))
+                            return error("LoadBlockIndex() : failed to move zerocoin data out of the block index");
+                        batchUpgrade.Clear();
+                        nUpgradeBatchSize = 0;
+                    }
+                }
+                pindexNew->zerocoinMintCounts = diskindex.zerocoinMintCounts;
+                pindexNew->nZerocoinSpends    = diskindex.nZerocoinSpends;
 
                 pcursor->Next();
             } else {
+                // an older client rewriting an entry keeps BLOCK_HAVE_ZCDATA_COUNTS but drops the counts
+                fWrittenByOlderClient = fZerocoinDataApart;
                 return error("LoadBlockIndex() : failed to read value");
             }
         } else {
@@ -347,6 +404,46 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
         }
     }
 
+    if (nUpgraded > 0) {
+        if (!WriteBatch(batchUpgrade, true))
+            return error("LoadBlockIndex() : failed to move zerocoin data out of the block index");
+        LogPrintf("LoadBlockIndex(): moved zerocoin data of %u block index entries\n", nUpgraded);
+    }
+    if (!fZerocoinDataApart && !WriteFlag("zerocoinblockdata", true))
+        return error("LoadBlockIndex() : failed to write the zerocoin data flag");
+
+    // Load the verified PoW hashes, written along with their index entries. A hash without an
+    // index entry is stale, drop it instead of creating an entry for a block we don't know.
+    CDBBatch batchStale(*this);
+    unsigned int nStale = 0;
+    pcursor->Seek(make_pair(DB_BLOCK_POWHASH, uint256()));
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, uint256> key;
+        if (pcursor->GetKey(key) && key.first == DB_BLOCK_POWHASH) {
+            uint256 hashPoW;
+            if (!pcursor->GetValue(hashPoW))
+                return error("LoadBlockIndex() : failed to read PoW hash");
+            BlockMap::iterator mi = mapBlockIndex.find(key.second);
+            if (mi == mapBlockIndex.end()) {
+                batchStale.Erase(key);
+                nStale++;
+            } else {
+                mi->second->hashPoW = hashPoW;
+                mi->second->nStatus |= BLOCK_HAVE_POWHASH;
+            }
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    if (nStale > 0) {
+        if (!WriteBatch(batchStale))
+            return error("LoadBlockIndex() : failed to erase stale PoW hashes");
+        LogPrintf("LoadBlockIndex(): erased %u stale PoW hashes\n", nStale);
+    }
+
     return true;
 }
 
@@ -19,6 +19,7 @@
 #include <boost/function.hpp>
 
 class CBlockIndex;
+class CZerocoinStateSnapshot;
 class CCoinsViewDBCursor;
 class uint256;
 
@@ -107,12 +108,19 @@ public:
 private:
     CBlockTreeDB(const CBlockTreeDB&);
     void operator=(const CBlockTreeDB&);
+    //! set by LoadBlockIndexGuts() if it failed on entries an older client wrote after the zerocoin data was moved out
+    bool fWrittenByOlderClient;
 public:
-    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
+    /** Writes the block file info and index entries along with the zerocoin data of the blocks, empty data is erased */
+    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                        const std::vector<std::pair<uint256, const CZerocoinBlockData*> >& zerocoinData);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &fileinfo);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
     bool ReadReindexing(bool &fReindex);
+    bool ReadZerocoinBlockData(const uint256 &hash, CZerocoinBlockData &data);
+    bool ReadZerocoinStateSnapshot(CZerocoinStateSnapshot &snapshot);
+    bool WriteZerocoinStateSnapshot(const CZerocoinStateSnapshot &snapshot);
     bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &list);
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
@@ -132,6 +140,8 @@ public:
     bool ReadFlag(const std::string &name, bool &fValue);
     bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
 	int GetBlockIndexVersion();
+    /** Whether the index has to be rebuilt because an older client wrote to it, see LoadBlockIndexGuts() */
+    bool WrittenByOlderClient() const { return fWrittenByOlderClient; }
 };
 
 #endif // BITCOIN_TXDB_H
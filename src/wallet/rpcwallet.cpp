@@ -2675,7 +2675,7 @@ UniValue mintzerocoin(const UniValue& params, bool fHelp)
 
 
     // Always use modulus v2
-    libzerocoin::Params *zcParams = ZCParamsV2;
+    libzerocoin::Params *zcParams = ZCParamsV2();
 
     // The following constructor does all the work of minting a brand
     // new zerocoin. It stores all the private values inside the
@@ -3013,7 +3013,7 @@ UniValue listspendzerocoins(const UniValue &params, bool fHelp) {
         CDataStream serializedCoinSpend((const char *)&*(txin.scriptSig.begin() + 4),
                                         (const char *)&*txin.scriptSig.end(),
                                         SER_NETWORK, PROTOCOL_VERSION);
-        libzerocoin::CoinSpend spend(fModulusV2 ? ZCParamsV2 : ZCParams, serializedCoinSpend);
+        libzerocoin::CoinSpend spend(fModulusV2 ? ZCParamsV2() : ZCParams(), serializedCoinSpend);
         int spendVersion = spend.getVersion();
 
         entry.push_back(Pair("denomination", (int)spend.getDenomination()));
@@ -0,0 +1,170 @@
+// Copyright (c) 2018 The Bitcoinzero Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "main.h"
+#include "random.h"
+#include "wallet/wallet.h"
+#include "wallet/walletdb.h"
+#include "zerocoin.h"
+
+#include <utility>
+#include <vector>
+
+#include "wallet/test/wallet_test_fixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(zerocoin_witness_tests, WalletTestingSetup)
+
+static const libzerocoin::CoinDenomination denomination = libzerocoin::ZQ_LOVELACE;
+
+/** Params of the native modulus of group 1 the test mints into */
+static libzerocoin::Params* GroupParams()
+{
+    return IsZerocoinTxV2(denomination, 1) ? ZCParamsV2() : ZCParams();
+}
+
+/** Adds a block minting pubCoins into group 1 on top of pindexPrev and makes it the tip */
+static CBlockIndex* AddBlock(CBlockIndex* pindexPrev, const std::vector<CBigNum>& pubCoins, libzerocoin::Accumulator& groupAccumulator)
+{
+    LOCK(cs_main);
+    CBlockIndex* pindex = new CBlockIndex();
+    pindex->pprev = pindexPrev;
+    pindex->nHeight = pindexPrev->nHeight + 1;
+    pindex->phashBlock = &mapBlockIndex.insert(std::make_pair(GetRandHash(), pindex)).first->first;
+    pindex->BuildSkip();
+
+    if (!pubCoins.empty()) {
+        CZerocoinBlockData data;
+        for (size_t i = 0; i < pubCoins.size(); i++)
+            groupAccumulator += libzerocoin::PublicCoin(GroupParams(), pubCoins[i], denomination);
+        data.mintedPubCoins[std::make_pair((int)denomination, 1)] = pubCoins;
+        data.accumulatorChanges[std::make_pair((int)denomination, 1)] = std::make_pair(groupAccumulator.getValue(), (int)pubCoins.size());
+        ZerocoinSetBlockData(pindex, data);
+    }
+
+    chainActive.SetTip(pindex);
+    BOOST_CHECK(CZerocoinState::GetZerocoinState()->AddBlock(pindex));
+    return pindex;
+}
+
+static CBlockIndex* AddEmptyBlocks(CBlockIndex* pindex, int nBlocks, libzerocoin::Accumulator& groupAccumulator)
+{
+    for (int i = 0; i < nBlocks; i++)
+        pindex = AddBlock(pindex, std::vector<CBigNum>(), groupAccumulator);
+    return pindex;
+}
+
+/** Witness the wallet should hold for a coin: its group accumulated without the coin itself */
+static CBigNum ExpectedWitness(const std::vector<CBigNum>& otherCoins)
+{
+    libzerocoin::Params* zcParams = chainActive.Height() >= Params().nModulusV2StartBlock ? ZCParamsV2() : ZCParams();
+    libzerocoin::Accumulator accumulator(zcParams, denomination);
+    for (size_t i = 0; i < otherCoins.size(); i++)
+        accumulator += libzerocoin::PublicCoin(zcParams, otherCoins[i], denomination);
+    return accumulator.getValue();
+}
+
+static CZerocoinEntry AddWalletMint(const libzerocoin::PrivateCoin& coin)
+{
+    CZerocoinEntry entry;
+    entry.value = coin.getPublicCoin().getValue();
+    entry.denomination = denomination;
+    entry.randomness = coin.getRandomness();
+    entry.serialNumber = coin.getSerialNumber();
+    BOOST_CHECK(CWalletDB(pwalletMain->strWalletFile).WriteZerocoinEntry(entry));
+    return entry;
+}
+
+/** Checks that the witness of pubCoin is the expected one, in memory and after loading the wallet again */
+static void CheckWitness(const CBigNum& pubCoin, const CBigNum& expectedWitness)
+{
+    const CBlockIndex* pindexWitness = chainActive[chainActive.Height() - (ZC_MINT_CONFIRMATIONS-1)];
+
+    CZerocoinWitnessEntry entry;
+    BOOST_CHECK(pwalletMain->GetZerocoinWitness(pubCoin, entry));
+    BOOST_CHECK(entry.witness == expectedWitness);
+    BOOST_CHECK(entry.hashBlock == pindexWitness->GetBlockHash());
+
+    CWallet wallet(pwalletMain->strWalletFile);
+    bool fFirstRun;
+    BOOST_CHECK(wallet.LoadWallet(fFirstRun) == DB_LOAD_OK);
+    CZerocoinWitnessEntry loaded;
+    BOOST_CHECK(wallet.GetZerocoinWitness(pubCoin, loaded));
+    BOOST_CHECK(loaded.witness == expectedWitness);
+    BOOST_CHECK(loaded.hashBlock == pindexWitness->GetBlockHash());
+    BOOST_CHECK(loaded.id == 1);
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_witness_persistence_and_rebuild)
+{
+    libzerocoin::Params* groupParams = GroupParams();
+    libzerocoin::Accumulator groupAccumulator(groupParams, denomination);
+
+    libzerocoin::PrivateCoin coin(groupParams, denomination);
+    CBigNum pubCoin = coin.getPublicCoin().getValue();
+    std::vector<CBigNum> otherCoins;
+    for (int i = 0; i < 3; i++)
+        otherCoins.push_back(libzerocoin::PrivateCoin(groupParams, denomination).getPublicCoin().getValue());
+
+    CZerocoinEntry mint = AddWalletMint(coin);
+
+    // The coin and one other mint, no witness before enough confirmations
+    std::vector<CBigNum> vMints;
+    vMints.push_back(otherCoins[0]);
+    vMints.push_back(pubCoin);
+    CBlockIndex* pindexFork = AddBlock(chainActive.Tip(), vMints, groupAccumulator);
+    libzerocoin::Accumulator forkAccumulator(groupAccumulator);
+    AddEmptyBlocks(pindexFork, ZC_MINT_CONFIRMATIONS-2, groupAccumulator);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip());
+    CZerocoinWitnessEntry entry;
+    BOOST_CHECK(!pwalletMain->GetZerocoinWitness(pubCoin, entry));
+
+    AddEmptyBlocks(chainActive.Tip(), 1, groupAccumulator);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip());
+    CheckWitness(pubCoin, ExpectedWitness(std::vector<CBigNum>(1, otherCoins[0])));
+
+    // Mints of the group after the stored witness are added to it
+    AddBlock(chainActive.Tip(), std::vector<CBigNum>(1, otherCoins[1]), groupAccumulator);
+    AddEmptyBlocks(chainActive.Tip(), ZC_MINT_CONFIRMATIONS-1, groupAccumulator);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip());
+    CheckWitness(pubCoin, ExpectedWitness(std::vector<CBigNum>(otherCoins.begin(), otherCoins.begin() + 2)));
+
+    // Reorganize to a branch with another mint: the witness block is gone and the witness is rebuilt
+    {
+        LOCK(cs_main);
+        CZerocoinState* zerocoinState = CZerocoinState::GetZerocoinState();
+        while (chainActive.Tip() != pindexFork) {
+            BOOST_CHECK(zerocoinState->RemoveBlock(chainActive.Tip()));
+            chainActive.SetTip(chainActive.Tip()->pprev);
+        }
+    }
+    AddEmptyBlocks(pindexFork, 1, forkAccumulator);
+    AddBlock(chainActive.Tip(), std::vector<CBigNum>(1, otherCoins[2]), forkAccumulator);
+    AddEmptyBlocks(chainActive.Tip(), ZC_MINT_CONFIRMATIONS-1, forkAccumulator);
+    pwalletMain->UpdatedBlockTip(chainActive.Tip());
+    std::vector<CBigNum> vExpected;
+    vExpected.push_back(otherCoins[0]);
+    vExpected.push_back(otherCoins[2]);
+    CheckWitness(pubCoin, ExpectedWitness(vExpected));
+
+    // The witness of a spent coin is erased
+    mint.IsUsed = true;
+    BOOST_CHECK(CWalletDB(pwalletMain->strWalletFile).WriteZerocoinEntry(mint));
+    pwalletMain->UpdatedBlockTip(chainActive.Tip());
+    BOOST_CHECK(!pwalletMain->GetZerocoinWitness(pubCoin, entry));
+    {
+        CWallet wallet(pwalletMain->strWalletFile);
+        bool fFirstRun;
+        BOOST_CHECK(wallet.LoadWallet(fFirstRun) == DB_LOAD_OK);
+        BOOST_CHECK(!wallet.GetZerocoinWitness(pubCoin, entry));
+    }
+
+    LOCK(cs_main);
+    CZerocoinState::GetZerocoinState()->Reset();
+    ZerocoinBlockDataFlushed();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -973,7 +973,7 @@ bool CWallet::AbandonTransaction(const uint256 &hashTx) {
             CDataStream serializedCoinSpend((const char *)&*(txin.scriptSig.begin() + 4),
                                             (const char *)&*txin.scriptSig.end(),
                                             SER_NETWORK, PROTOCOL_VERSION);
-            libzerocoin::CoinSpend spend(txin.nSequence >= ZC_MODULUS_V2_BASE_ID ? ZCParamsV2 : ZCParams,
+            libzerocoin::CoinSpend spend(txin.nSequence >= ZC_MODULUS_V2_BASE_ID ? ZCParamsV2() : ZCParams(),
                                          serializedCoinSpend);
 
             CBigNum serial = spend.getCoinSerialNumber();
@@ -1081,6 +1081,164 @@ void CWallet::SyncTransaction(const CTransaction &tx, const CBlockIndex *pindex,
     }
 }
 
+void CWallet::LoadZerocoinWitness(const CZerocoinWitnessEntry &entry) {
+    AssertLockHeld(cs_wallet);
+    mapZerocoinWitnesses[entry.value] = entry;
+}
+
+bool CWallet::GetZerocoinWitness(const CBigNum &pubCoin, CZerocoinWitnessEntry &entry) const {
+    LOCK(cs_wallet);
+    map<CBigNum, CZerocoinWitnessEntry>::const_iterator it = mapZerocoinWitnesses.find(pubCoin);
+    if (it == mapZerocoinWitnesses.end())
+        return false;
+    entry = it->second;
+    return true;
+}
+
+bool CWallet::UpdateZerocoinWitness(CWalletDB &walletdb, const CBigNum &pubCoin, int denomination, int id,
+                                    int maxHeight, bool fModulusV2, bool fRebuild, CBigNum &witness) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    CZerocoinState *zerocoinState = CZerocoinState::GetZerocoinState();
+    CZerocoinWitnessEntry &entry = mapZerocoinWitnesses[pubCoin];
+    if (!fRebuild && !entry.IsNull() && entry.denomination == denomination && entry.id == id && entry.fModulusV2 == fModulusV2) {
+        if (entry.hashBlock == chainActive[maxHeight]->GetBlockHash()) {
+            witness = entry.witness;
+            return true;
+        }
+        CZerocoinWitnessEntry advanced = entry;
+        if (zerocoinState->AdvanceWitnessForSpend(&chainActive, maxHeight, denomination, id, pubCoin, fModulusV2,
+                                                  advanced.witness, advanced.hashBlock)) {
+            entry = advanced;
+            walletdb.WriteZerocoinWitness(entry);
+            witness = entry.witness;
+            return true;
+        }
+    }
+
+    // The witness is new, or its block was disconnected: accumulate the whole group again
+    CBigNum newWitness;
+    if (!zerocoinState->GetWitnessForSpend(&chainActive, maxHeight, denomination, id, pubCoin, fModulusV2, newWitness)) {
+        if (entry.IsNull())
+            mapZerocoinWitnesses.erase(pubCoin);
+        return error("%s: can't compute the witness of coin %s", __func__, pubCoin.ToString().substr(0, 15));
+    }
+    entry.value = pubCoin;
+    entry.denomination = denomination;
+    entry.id = id;
+    entry.fModulusV2 = fModulusV2;
+    entry.witness = newWitness;
+    entry.hashBlock = chainActive[maxHeight]->GetBlockHash();
+    walletdb.WriteZerocoinWitness(entry);
+    witness = entry.witness;
+    return true;
+}
+
+void CWallet::UpdatedBlockTip(const CBlockIndex *pindex) {
+    if (!fFileBacked || IsInitialBlockDownload())
+        return;
+
+    // Take copies of the mints and their witnesses, the wallet db is only read again after a mint record changed
+    vector<pair<CBigNum, int> > vMints;
+    map<CBigNum, CZerocoinWitnessEntry> mapWitnesses;
+    {
+        LOCK(cs_wallet);
+        unsigned int nUpdated = nZerocoinEntriesUpdated;
+        if (!fZerocoinMintsLoaded || nUpdated != nZerocoinMintsUpdated) {
+            list <CZerocoinEntry> listPubCoin;
+            CWalletDB(strWalletFile).ListPubCoin(listPubCoin);
+            vZerocoinMints.clear();
+            BOOST_FOREACH(const CZerocoinEntry &coin, listPubCoin) {
+                if (!coin.IsUsed && coin.randomness != 0 && coin.serialNumber != 0)
+                    vZerocoinMints.push_back(make_pair(coin.value, coin.denomination));
+            }
+            nZerocoinMintsUpdated = nUpdated;
+            fZerocoinMintsLoaded = true;
+        }
+        vMints = vZerocoinMints;
+        mapWitnesses = mapZerocoinWitnesses;
+    }
+
+    // Collect the coins to add to each witness under cs_main, the accumulation itself doesn't need the chain
+    vector<pair<CZerocoinWitnessEntry, vector<CBigNum> > > vUpdates;
+    set<CBigNum> setSpendable;
+    {
+        LOCK(cs_main);
+
+        // Keep the witnesses at the height spends are created for, so that shallow reorgs don't touch them
+        bool fModulusV2 = chainActive.Height() >= Params().nModulusV2StartBlock;
+        int maxHeight = chainActive.Height() - (ZC_MINT_CONFIRMATIONS-1);
+        if (maxHeight < 0)
+            return;
+        uint256 hashMaxBlock = chainActive[maxHeight]->GetBlockHash();
+
+        CZerocoinState *zerocoinState = CZerocoinState::GetZerocoinState();
+        BOOST_FOREACH(const PAIRTYPE(CBigNum, int) &mint, vMints) {
+            const CBigNum &pubCoin = mint.first;
+            int denomination = mint.second;
+            int id;
+            int coinHeight = zerocoinState->GetMintedCoinHeightAndId(pubCoin, denomination, id);
+            if (coinHeight <= 0 || coinHeight > maxHeight)
+                continue;
+            setSpendable.insert(pubCoin);
+
+            map<CBigNum, CZerocoinWitnessEntry>::const_iterator it = mapWitnesses.find(pubCoin);
+            if (it != mapWitnesses.end() && it->second.denomination == denomination && it->second.id == id &&
+                    it->second.fModulusV2 == fModulusV2) {
+                if (it->second.hashBlock == hashMaxBlock)
+                    continue;
+                vector<CBigNum> pubCoins;
+                if (zerocoinState->GetPubCoinsToAdvanceWitness(&chainActive, maxHeight, denomination, id, pubCoin,
+                                                               it->second.hashBlock, pubCoins)) {
+                    vUpdates.push_back(make_pair(it->second, pubCoins));
+                    vUpdates.back().first.hashBlock = hashMaxBlock;
+                    continue;
+                }
+            }
+
+            // The witness is new, or its block was disconnected: accumulate the whole group again
+            CZerocoinWitnessEntry entry;
+            vector<CBigNum> pubCoins;
+            if (!zerocoinState->GetWitnessPubCoinsForSpend(&chainActive, maxHeight, denomination, id, pubCoin, fModulusV2,
+                                                           entry.witness, pubCoins)) {
+                LogPrintf("%s: can't compute the witness of coin %s\n", __func__, pubCoin.ToString().substr(0, 15));
+                continue;
+            }
+            entry.value = pubCoin;
+            entry.denomination = denomination;
+            entry.id = id;
+            entry.fModulusV2 = fModulusV2;
+            entry.hashBlock = hashMaxBlock;
+            vUpdates.push_back(make_pair(entry, pubCoins));
+        }
+    }
+
+    for (size_t i = 0; i < vUpdates.size(); i++) {
+        CZerocoinWitnessEntry &entry = vUpdates[i].first;
+        if (!vUpdates[i].second.empty())
+            entry.witness = ZerocoinAccumulate(entry.fModulusV2, entry.denomination, entry.witness, vUpdates[i].second);
+    }
+
+    LOCK(cs_wallet);
+    CWalletDB walletdb(strWalletFile);
+    for (size_t i = 0; i < vUpdates.size(); i++) {
+        const CZerocoinWitnessEntry &entry = vUpdates[i].first;
+        mapZerocoinWitnesses[entry.value] = entry;
+        walletdb.WriteZerocoinWitness(entry);
+    }
+
+    // Forget the witnesses of spent coins. Witnesses added by a spend since the copy was taken are left alone
+    for (map<CBigNum, CZerocoinWitnessEntry>::iterator it = mapZerocoinWitnesses.begin(); it != mapZerocoinWitnesses.end(); ) {
+        if (mapWitnesses.count(it->first) > 0 && setSpendable.count(it->first) == 0) {
+            walletdb.EraseZerocoinWitness(it->second);
+            mapZerocoinWitnesses.erase(it++);
+        }
+        else
+            ++it;
+    }
+}
+
 
 isminetype CWallet::IsMine(const CTxIn &txin) const {
     {
@@ -3198,7 +3356,7 @@ bool CWallet::CreateZerocoinMintModel(string &stringError, string denomAmount) {
     }
 
     // Set up the Zerocoin Params object
-    libzerocoin::Params *zcParams = ZCParamsV2;
+    libzerocoin::Params *zcParams = ZCParamsV2();
 	
 	int mintVersion = ZEROCOIN_TX_VERSION_1;
 	
@@ -3687,7 +3845,7 @@ bool CWallet::CreateZerocoinSpendTransaction(std::string &thirdPartyaddress, int
 
             // Set up the Zerocoin Params object
             bool fModulusV2 = chainActive.Height() >= Params().nModulusV2StartBlock;
-            libzerocoin::Params *zcParams = fModulusV2 ? ZCParamsV2 : ZCParams;
+            libzerocoin::Params *zcParams = fModulusV2 ? ZCParamsV2() : ZCParams();
 
             // Select not yet used coin from the wallet with minimal possible id
 
@@ -3747,13 +3905,24 @@ bool CWallet::CreateZerocoinSpendTransaction(std::string &thirdPartyaddress, int
                 return false;
             }
 
-            // 4. Get witness from the index
-            libzerocoin::AccumulatorWitness witness =
-                    zerocoinState->GetWitnessForSpend(&chainActive,
-                                                      chainActive.Height()-(ZC_MINT_CONFIRMATIONS-1),
-                                                      denomination, coinId,
-                                                      coinToUse.value,
-                                                      fModulusV2);
+            // 4. Get witness, normally kept up to date by UpdatedBlockTip
+            CWalletDB walletdb(strWalletFile);
+            int maxHeight = chainActive.Height()-(ZC_MINT_CONFIRMATIONS-1);
+            CBigNum witnessValue;
+            if (!UpdateZerocoinWitness(walletdb, coinToUse.value, denomination, coinId, maxHeight, fModulusV2, false, witnessValue)) {
+                strFailReason = _("can't compute the witness of the mint coin");
+                return false;
+            }
+            libzerocoin::Accumulator witnessAccumulator(zcParams, witnessValue, denomination);
+            if (!libzerocoin::AccumulatorWitness(zcParams, witnessAccumulator, pubCoinSelected).VerifyWitness(accumulator, pubCoinSelected)) {
+                LogPrintf("CreateZerocoinSpendTransaction: stored witness doesn't match the accumulator, rebuilding it\n");
+                if (!UpdateZerocoinWitness(walletdb, coinToUse.value, denomination, coinId, maxHeight, fModulusV2, true, witnessValue)) {
+                    strFailReason = _("can't compute the witness of the mint coin");
+                    return false;
+                }
+                witnessAccumulator = libzerocoin::Accumulator(zcParams, witnessValue, denomination);
+            }
+            libzerocoin::AccumulatorWitness witness(zcParams, witnessAccumulator, pubCoinSelected);
 
             int serializedId = coinId + (fModulusV2 ? ZC_MODULUS_V2_BASE_ID : 0);
 
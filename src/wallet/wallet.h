@@ -569,6 +569,54 @@ private:
 };
 
 
+/**
+ * Accumulator witness of a minted coin of the wallet: the accumulator of all coins of its group
+ * minted up to block hashBlock except the coin itself. Kept up to date with the chain so that a spend
+ * doesn't have to accumulate the whole group again.
+ */
+class CZerocoinWitnessEntry
+{
+public:
+    Bignum value;
+    int denomination;
+    int id;
+    bool fModulusV2;
+    Bignum witness;
+    uint256 hashBlock;
+
+    CZerocoinWitnessEntry()
+    {
+        SetNull();
+    }
+
+    void SetNull()
+    {
+        value = 0;
+        denomination = -1;
+        id = -1;
+        fModulusV2 = false;
+        witness = 0;
+        hashBlock.SetNull();
+    }
+
+    bool IsNull() const
+    {
+        return hashBlock.IsNull();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(value);
+        READWRITE(denomination);
+        READWRITE(id);
+        READWRITE(fModulusV2);
+        READWRITE(witness);
+        READWRITE(hashBlock);
+    }
+};
+
 /**
  * A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
  * and provides the ability to create new transactions.
@@ -618,6 +666,20 @@ private:
     /* the HD chain data model (external chain counters) */
     CHDChain hdChain;
 
+    /* accumulator witnesses of the minted coins, by public coin value */
+    std::map<CBigNum, CZerocoinWitnessEntry> mapZerocoinWitnesses;
+
+    /* public coin value and denomination of the unspent minted coins, reloaded from the wallet db
+     * when nZerocoinEntriesUpdated moves past nZerocoinMintsUpdated */
+    std::vector<std::pair<CBigNum, int> > vZerocoinMints;
+    unsigned int nZerocoinMintsUpdated;
+    bool fZerocoinMintsLoaded;
+
+    /* Bring the witness of a minted coin up to maxHeight, rebuilding it from the chain if fRebuild is set
+     * or it can't be advanced. Returns false if the chain data needed for that can't be read */
+    bool UpdateZerocoinWitness(CWalletDB &walletdb, const CBigNum &pubCoin, int denomination, int id,
+                               int maxHeight, bool fModulusV2, bool fRebuild, CBigNum &witness);
+
 public:
     /*
      * Main wallet lock.
@@ -675,6 +737,8 @@ public:
         fAnonymizableTallyCachedNonDenom = false;
         vecAnonymizableTallyCached.clear();
         vecAnonymizableTallyCachedNonDenom.clear();
+        nZerocoinMintsUpdated = 0;
+        fZerocoinMintsLoaded = false;
     }
 
     std::map<uint256, CWalletTx> mapWallet;
@@ -786,6 +850,9 @@ public:
     void MarkDirty();
     bool AddToWallet(const CWalletTx& wtxIn, bool fFromLoadWallet, CWalletDB* pwalletdb);
     void SyncTransaction(const CTransaction& tx, const CBlockIndex *pindex, const CBlock* pblock);
+    void UpdatedBlockTip(const CBlockIndex *pindex);
+    void LoadZerocoinWitness(const CZerocoinWitnessEntry& entry);
+    bool GetZerocoinWitness(const CBigNum& pubCoin, CZerocoinWitnessEntry& entry) const;
     bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate);
     int ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate = false);
     void ReacceptWalletTransactions();
@@ -24,6 +24,7 @@
 using namespace std;
 
 static uint64_t nAccountingEntryNumber = 0;
+std::atomic<unsigned int> nZerocoinEntriesUpdated(0);
 
 //
 // CWalletDB
@@ -251,13 +252,23 @@ CWalletDB::ReadZerocoinAccumulator(libzerocoin::Accumulator &accumulator, libzer
 //}
 
 bool CWalletDB::WriteZerocoinEntry(const CZerocoinEntry &zerocoin) {
+    nZerocoinEntriesUpdated++;
     return Write(make_pair(string("zerocoin"), zerocoin.value), zerocoin, true);
 }
 
 bool CWalletDB::EraseZerocoinEntry(const CZerocoinEntry &zerocoin) {
+    nZerocoinEntriesUpdated++;
     return Erase(make_pair(string("zerocoin"), zerocoin.value));
 }
 
+bool CWalletDB::WriteZerocoinWitness(const CZerocoinWitnessEntry &witness) {
+    return Write(make_pair(string("zcwitness"), witness.value), witness, true);
+}
+
+bool CWalletDB::EraseZerocoinWitness(const CZerocoinWitnessEntry &witness) {
+    return Erase(make_pair(string("zcwitness"), witness.value));
+}
+
 // Check Calculated Blocked for Zerocoin
 bool CWalletDB::ReadCalculatedZCBlock(int &height) {
     height = 0;
@@ -630,6 +641,10 @@ bool ReadKeyValue(CWallet *pwallet, CDataStream &ssKey, CDataStream &ssValue,
                 strErr = "Error reading wallet database: LoadDestData failed";
                 return false;
             }
+        } else if (strType == "zcwitness") {
+            CZerocoinWitnessEntry witness;
+            ssValue >> witness;
+            pwallet->LoadZerocoinWitness(witness);
         } else if (strType == "hdchain") {
             CHDChain chain;
             ssValue >> chain;
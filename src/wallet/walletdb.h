@@ -12,6 +12,7 @@
 #include "wallet/db.h"
 #include "key.h"
 
+#include <atomic>
 #include <list>
 #include <stdint.h>
 #include <string>
@@ -21,6 +22,9 @@
 
 static const bool DEFAULT_FLUSHWALLET = true;
 
+/** Incremented on every write or erase of a "zerocoin" record, so that copies of the records can tell they are stale */
+extern std::atomic<unsigned int> nZerocoinEntriesUpdated;
+
 class CAccount;
 class CAccountingEntry;
 struct CBlockLocator;
@@ -33,6 +37,7 @@ class uint160;
 class uint256;
 class CZerocoinEntry;
 class CZerocoinSpendEntry;
+class CZerocoinWitnessEntry;
 
 /** Error statuses for the wallet database */
 enum DBErrors
@@ -181,6 +186,9 @@ public:
     bool ReadZerocoinAccumulator(libzerocoin::Accumulator& accumulator, libzerocoin::CoinDenomination denomination, int pubcoinid);
     // bool EraseZerocoinAccumulator(libzerocoin::Accumulator& accumulator, libzerocoin::CoinDenomination denomination, int pubcoinid);
 
+    bool WriteZerocoinWitness(const CZerocoinWitnessEntry& witness);
+    bool EraseZerocoinWitness(const CZerocoinWitnessEntry& witness);
+
     bool ReadCalculatedZCBlock(int& height);
     bool WriteCalculatedZCBlock(int height);
 
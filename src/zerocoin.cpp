@@ -1,6 +1,7 @@
 #include "main.h"
 #include "zerocoin.h"
 #include "timedata.h"
+#include "txdb.h"
 #include "chainparams.h"
 #include "util.h"
 #include "base58.h"
@@ -8,12 +9,22 @@
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "consensus/consensus.h"
+#include "crypto/sha256.h"
+#include "memusage.h"
+#include "random.h"
+#include "streams.h"
+#include "clientversion.h"
+#include "zerocoin_params_blob.h"
 
 #include <atomic>
+#include <list>
 #include <sstream>
 #include <chrono>
 
 #include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 using namespace std;
 
@@ -23,23 +34,273 @@ int64_t nMinimumInputValue = DUST_HARD_LIMIT;
 
 // btzc: add zerocoin init
 // zerocoin init
-static CBigNum bnTrustedModulus(ZEROCOIN_MODULUS), bnTrustedModulusV2(ZEROCOIN_MODULUS_V2);
 
-// Set up the Zerocoin Params object
-uint32_t securityLevel = 80;
-libzerocoin::Params *ZCParams = new libzerocoin::Params(bnTrustedModulus, bnTrustedModulus);
-libzerocoin::Params *ZCParamsV2 = new libzerocoin::Params(bnTrustedModulusV2, bnTrustedModulus);
+/**
+ * Reads the Params for a trusted modulus from their precomputed blob, see libzerocoin/paramblob.cpp.
+ * The parameters are derived from the modulus again if the blob doesn't match its hash or the modulus.
+ */
+static libzerocoin::Params *LoadZerocoinParams(const char *pszModulus, const char *pszSeed, const char *pszBlob, const char *pszBlobHash)
+{
+    CBigNum bnModulus(pszModulus), bnSeed(pszSeed);
+    std::vector<unsigned char> blob = ParseHex(pszBlob);
+    if (Hash(blob.begin(), blob.end()) == uint256S(pszBlobHash)) {
+        try {
+            std::unique_ptr<libzerocoin::Params> params(new libzerocoin::Params());
+            CDataStream ss(blob, SER_DISK, CLIENT_VERSION);
+            ss >> *params;
+            if (ss.empty() && params->initialized && params->accumulatorParams.accumulatorModulus == bnModulus)
+                return params.release();
+        } catch (const std::exception &e) {
+            LogPrintf("LoadZerocoinParams: %s\n", e.what());
+        }
+    }
+    LogPrintf("LoadZerocoinParams: precomputed parameters are invalid, deriving them from the modulus\n");
+    return new libzerocoin::Params(bnModulus, bnSeed);
+}
+
+// Set up the Zerocoin Params objects on first use
+libzerocoin::Params *ZCParams()
+{
+    static libzerocoin::Params *params = LoadZerocoinParams(ZEROCOIN_MODULUS, ZEROCOIN_MODULUS,
+            ZEROCOIN_PARAMS_BLOB, ZEROCOIN_PARAMS_BLOB_HASH);
+    return params;
+}
+
+libzerocoin::Params *ZCParamsV2()
+{
+    static libzerocoin::Params *params = LoadZerocoinParams(ZEROCOIN_MODULUS_V2, ZEROCOIN_MODULUS,
+            ZEROCOIN_PARAMS_V2_BLOB, ZEROCOIN_PARAMS_V2_BLOB_HASH);
+    return params;
+}
 
 static CZerocoinState zerocoinState;
 
+namespace {
+
+class CZerocoinSpendCacheHasher
+{
+public:
+    size_t operator()(const uint256& key) const {
+        return key.GetCheapHash();
+    }
+};
+
+/**
+ * Cache of successful spend proof verifications, to avoid verifying a spend twice (once when accepted into
+ * memory pool, and again when its block is connected). A spend either verifies against a given accumulator
+ * value or not, so entries stay valid across reorganizations. The cache only lives in memory and starts
+ * empty on every restart, it is not persisted to disk.
+ */
+class CZerocoinSpendCache
+{
+private:
+    //! Entries are SHA256(nonce || txid || accumulator block hash || accumulator value)
+    uint256 nonce;
+    typedef boost::unordered_set<uint256, CZerocoinSpendCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_spendcache;
+
+public:
+    CZerocoinSpendCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    uint256 ComputeEntry(const uint256 &hashTx, const uint256 &accumulatorBlockHash, const CBigNum &accumulatorValue)
+    {
+        uint256 entry;
+        std::vector<unsigned char> vchValue = accumulatorValue.getvch();
+        CSHA256().Write(nonce.begin(), 32).Write(hashTx.begin(), 32).Write(accumulatorBlockHash.begin(), 32)
+                .Write(vchValue.data(), vchValue.size()).Finalize(entry.begin());
+        return entry;
+    }
+
+    bool Get(const uint256 &entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_spendcache);
+        return setValid.count(entry);
+    }
+
+    void Set(const uint256 &entry)
+    {
+        size_t nMaxCacheSize = GetArg("-maxzcspendcachesize", DEFAULT_MAX_ZC_SPEND_CACHE_SIZE) * ((size_t) 1 << 20);
+        if (nMaxCacheSize <= 0) return;
+
+        boost::unique_lock<boost::shared_mutex> lock(cs_spendcache);
+        while (memusage::DynamicUsage(setValid) > nMaxCacheSize)
+        {
+            map_type::size_type s = GetRand(setValid.bucket_count());
+            map_type::local_iterator it = setValid.begin(s);
+            if (it != setValid.end(s)) {
+                setValid.erase(*it);
+            }
+        }
+
+        setValid.insert(entry);
+    }
+};
+
+CZerocoinSpendCache spendCache;
+
+/**
+ * Zerocoin data of the most recently used blocks. Entries are shared so that callers can keep using
+ * data that has been evicted in the meantime. Data set since the last flush is kept apart and never
+ * evicted, it is written to the block tree db along with the index entries of its blocks.
+ */
+class CZerocoinBlockDataCache
+{
+private:
+    typedef std::list<std::pair<uint256, std::shared_ptr<const CZerocoinBlockData> > > list_type;
+    //! most recently used first
+    list_type entries;
+    boost::unordered_map<uint256, list_type::iterator, BlockHasher> mapEntries;
+    //! not written yet
+    std::map<uint256, std::shared_ptr<const CZerocoinBlockData> > mapDirty;
+    CCriticalSection cs_blockdatacache;
+
+public:
+    std::shared_ptr<const CZerocoinBlockData> Get(const uint256 &hash)
+    {
+        LOCK(cs_blockdatacache);
+        auto itDirty = mapDirty.find(hash);
+        if (itDirty != mapDirty.end())
+            return itDirty->second;
+        auto it = mapEntries.find(hash);
+        if (it == mapEntries.end())
+            return std::shared_ptr<const CZerocoinBlockData>();
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    void Set(const uint256 &hash, const std::shared_ptr<const CZerocoinBlockData> &data, bool fDirty)
+    {
+        LOCK(cs_blockdatacache);
+        if (fDirty)
+            mapDirty[hash] = data;
+        auto it = mapEntries.find(hash);
+        if (it != mapEntries.end()) {
+            entries.erase(it->second);
+            mapEntries.erase(it);
+        }
+        entries.push_front(make_pair(hash, data));
+        mapEntries[hash] = entries.begin();
+        while (entries.size() > ZC_BLOCK_DATA_CACHE_SIZE) {
+            mapEntries.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    void GetDirty(std::vector<std::pair<uint256, const CZerocoinBlockData *> > &vData)
+    {
+        LOCK(cs_blockdatacache);
+        vData.reserve(vData.size() + mapDirty.size());
+        for (const auto &dirty: mapDirty)
+            vData.push_back(make_pair(dirty.first, dirty.second.get()));
+    }
+
+    void ClearDirty()
+    {
+        LOCK(cs_blockdatacache);
+        mapDirty.clear();
+    }
+};
+
+CZerocoinBlockDataCache blockDataCache;
+
+}
+
+bool ZerocoinGetBlockData(const CBlockIndex *pindex, std::shared_ptr<const CZerocoinBlockData> &data) {
+    static const std::shared_ptr<const CZerocoinBlockData> emptyData = std::make_shared<CZerocoinBlockData>();
+    if (!pindex->HasZerocoinData()) {
+        data = emptyData;
+        return true;
+    }
+
+    uint256 hash = pindex->GetBlockHash();
+    data = blockDataCache.Get(hash);
+    if (!data) {
+        std::shared_ptr<CZerocoinBlockData> dataRead = std::make_shared<CZerocoinBlockData>();
+        if (!pblocktree->ReadZerocoinBlockData(hash, *dataRead))
+            return error("%s: can't read zerocoin data of block %s", __func__, hash.ToString());
+        data = dataRead;
+        blockDataCache.Set(hash, data, false);
+    }
+    return true;
+}
+
+void ZerocoinSetBlockData(CBlockIndex *pindex, const CZerocoinBlockData &data) {
+    if (data.IsNull() && !pindex->HasZerocoinData())
+        return;
+
+    pindex->zerocoinMintCounts.clear();
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, data.accumulatorChanges)
+        pindex->zerocoinMintCounts[accUpdate.first] = accUpdate.second.second;
+    pindex->nZerocoinSpends = data.spentSerials.size();
+
+    blockDataCache.Set(pindex->GetBlockHash(), std::make_shared<const CZerocoinBlockData>(data), true);
+}
+
+void ZerocoinGetDirtyBlockData(std::vector<std::pair<uint256, const CZerocoinBlockData *> > &vData) {
+    blockDataCache.GetDirty(vData);
+}
+
+void ZerocoinBlockDataFlushed() {
+    blockDataCache.ClearDirty();
+}
+
+// Accumulator value after the mints of given denomination and id in the block, fFound is false if there were
+// none. Returns false if the zerocoin data of the block can't be read
+static bool GetBlockAccumulatorValue(const CBlockIndex *pindex, const pair<int,int> &denomAndId, bool fAlternativeModulus,
+                                     CBigNum &value, bool &fFound) {
+    fFound = false;
+    if (pindex->zerocoinMintCounts.count(denomAndId) == 0)
+        return true;
+
+    if (fAlternativeModulus) {
+        auto it = pindex->alternativeAccumulatorChanges.find(denomAndId);
+        if (it != pindex->alternativeAccumulatorChanges.end()) {
+            value = it->second.first;
+            fFound = true;
+        }
+        return true;
+    }
+
+    std::shared_ptr<const CZerocoinBlockData> zerocoinData;
+    if (!ZerocoinGetBlockData(pindex, zerocoinData))
+        return false;
+    auto it = zerocoinData->accumulatorChanges.find(denomAndId);
+    if (it != zerocoinData->accumulatorChanges.end()) {
+        value = it->second.first;
+        fFound = true;
+    }
+    return true;
+}
+
+// Public coins minted in the block with given denomination and id. Returns false if the zerocoin data of the
+// block can't be read
+static bool GetBlockMintedPubCoins(const CBlockIndex *pindex, const pair<int,int> &denomAndId, vector<CBigNum> &pubCoins) {
+    pubCoins.clear();
+    if (pindex->zerocoinMintCounts.count(denomAndId) == 0)
+        return true;
+
+    std::shared_ptr<const CZerocoinBlockData> zerocoinData;
+    if (!ZerocoinGetBlockData(pindex, zerocoinData))
+        return false;
+    auto it = zerocoinData->mintedPubCoins.find(denomAndId);
+    if (it != zerocoinData->mintedPubCoins.end())
+        pubCoins = it->second;
+    return true;
+}
+
 static bool CheckZerocoinSpendSerial(CValidationState &state, CZerocoinTxInfo *zerocoinTxInfo, libzerocoin::CoinDenomination denomination, const CBigNum &serial, int nHeight, bool fConnectTip) {
     if (nHeight > Params().nCheckBugFixedAtBlock) {
+        CZerocoinKey serialKey(serial);
         // check for zerocoin transaction in this block as well
-        if (zerocoinTxInfo && !zerocoinTxInfo->fInfoIsComplete && zerocoinTxInfo->spentSerials.count(serial) > 0)
+        if (zerocoinTxInfo && !zerocoinTxInfo->fInfoIsComplete && zerocoinTxInfo->spentSerials.count(serialKey) > 0)
             return state.DoS(0, error("CTransaction::CheckTransaction() : two or more spends with same serial in the same block"));
 
         // check for used serials in zerocoinState
-        if (zerocoinState.IsUsedCoinSerial(serial)) {
+        if (zerocoinState.IsUsedCoinSerial(serialKey)) {
             // Proceed with checks ONLY if we're accepting tx into the memory pool or connecting block to the existing blockchain
             if (nHeight == INT_MAX || fConnectTip) {
                 if (nHeight < Params().nSpendV15StartBlock)
@@ -87,7 +348,7 @@ bool CheckSpendBitcoinzeroTransaction(const CTransaction &tx,
         bool fModulusV2 = pubcoinId >= ZC_MODULUS_V2_BASE_ID, fModulusV2InIndex = false;
         if (fModulusV2)
             pubcoinId -= ZC_MODULUS_V2_BASE_ID;
-        libzerocoin::Params *zcParams = fModulusV2 ? ZCParamsV2 : ZCParams;
+        libzerocoin::Params *zcParams = fModulusV2 ? ZCParamsV2() : ZCParams();
 
         if (txin.scriptSig.size() < 4)
             return state.DoS(100,
@@ -128,8 +389,9 @@ bool CheckSpendBitcoinzeroTransaction(const CTransaction &tx,
             }
         }
 
-        if (fModulusV2InIndex != fModulusV2)
-            zerocoinState.CalculateAlternativeModulusAccumulatorValues(&chainActive, (int)targetDenomination, pubcoinId);
+        if (fModulusV2InIndex != fModulusV2 &&
+                !zerocoinState.CalculateAlternativeModulusAccumulatorValues(&chainActive, (int)targetDenomination, pubcoinId))
+            return state.Error("CheckSpendBitcoinzeroTransaction: can't read zerocoin data");
 
         uint256 txHashForMetadata;
 
@@ -197,26 +459,63 @@ bool CheckSpendBitcoinzeroTransaction(const CTransaction &tx,
 				index = index->pprev;
 		}
 
-        decltype(&CBlockIndex::accumulatorChanges) accChanges = fModulusV2 == fModulusV2InIndex ?
-                    &CBlockIndex::accumulatorChanges : &CBlockIndex::alternativeAccumulatorChanges;
-
-        // Enumerate all the accumulator changes seen in the blockchain starting with the latest block
-        // In most cases the latest accumulator value will be used for verification
-        do {
-            if ((index->*accChanges).count(denominationAndId) > 0) {
-                libzerocoin::Accumulator accumulator(zcParams,
-                                                     (index->*accChanges)[denominationAndId].first,
-                                                     targetDenomination);
-                LogPrintf("CheckSpendBitcoinzeroTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
-                passVerify = newSpend.Verify(accumulator, newMetadata);
+        bool fAlternativeModulus = fModulusV2 != fModulusV2InIndex;
+        CBigNum accumulatorValue;
+
+        if (zerocoinTxInfo && zerocoinTxInfo->fDeferSpendChecks) {
+            // Collect the accumulator values the loop below would try, in the same order. The proof is checked
+            // later together with the other spends of the block, the caller falls back to this path on failure
+            CZerocoinSpendCheck check(zcParams, newSpend, targetDenomination, newMetadata);
+            while (true) {
+                bool fFound;
+                if (!GetBlockAccumulatorValue(index, denominationAndId, fAlternativeModulus, accumulatorValue, fFound))
+                    return state.Error("CheckSpendBitcoinzeroTransaction: can't read zerocoin data");
+                if (fFound) {
+                    uint256 cacheEntry = spendCache.ComputeEntry(hashTx, index->GetBlockHash(), accumulatorValue);
+                    if (spendCache.Get(cacheEntry)) {
+                        passVerify = true;
+                        break;
+                    }
+                    check.AddAccumulatorValue(accumulatorValue, cacheEntry);
+                }
+                if (index == coinGroup.firstBlock || spendHasBlockHash)
+                    break;
+                index = index->pprev;
             }
+            if (!passVerify && check.HasAccumulatorValues()) {
+                zerocoinTxInfo->spendChecks.push_back(CZerocoinSpendCheck());
+                zerocoinTxInfo->spendChecks.back().swap(check);
+                passVerify = true;
+            }
+        }
+        else {
+            // Enumerate all the accumulator changes seen in the blockchain starting with the latest block
+            // In most cases the latest accumulator value will be used for verification
+            do {
+                bool fFound;
+                if (!GetBlockAccumulatorValue(index, denominationAndId, fAlternativeModulus, accumulatorValue, fFound))
+                    return state.Error("CheckSpendBitcoinzeroTransaction: can't read zerocoin data");
+                if (fFound) {
+                    uint256 cacheEntry = spendCache.ComputeEntry(hashTx, index->GetBlockHash(), accumulatorValue);
+                    if (spendCache.Get(cacheEntry)) {
+                        passVerify = true;
+                    }
+                    else {
+                        libzerocoin::Accumulator accumulator(zcParams, accumulatorValue, targetDenomination);
+                        LogPrintf("CheckSpendBitcoinzeroTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
+                        passVerify = newSpend.Verify(accumulator, newMetadata);
+                        if (passVerify)
+                            spendCache.Set(cacheEntry);
+                    }
+                }
 
-	        // if spend has block hash we don't need to look further
-			if (index == coinGroup.firstBlock || spendHasBlockHash)
-                break;
-            else
-                index = index->pprev;
-        } while (!passVerify);
+                // if spend has block hash we don't need to look further
+                if (index == coinGroup.firstBlock || spendHasBlockHash)
+                    break;
+                else
+                    index = index->pprev;
+            } while (!passVerify);
+        }
 
         // Rare case: accumulator value contains some but NOT ALL coins from one block. In this case we will
         // have to enumerate over coins manually. No optimization is really needed here because it's a rarity
@@ -224,14 +523,16 @@ bool CheckSpendBitcoinzeroTransaction(const CTransaction &tx,
         if (!passVerify && spendVersion == ZEROCOIN_TX_VERSION_1) {
             // Build vector of coins sorted by the time of mint
             index = coinGroup.lastBlock;
-            vector<CBigNum> pubCoins = index->mintedPubCoins[denominationAndId];
+            vector<CBigNum> pubCoins;
+            if (!GetBlockMintedPubCoins(index, denominationAndId, pubCoins))
+                return state.Error("CheckSpendBitcoinzeroTransaction: can't read zerocoin data");
             if (index != coinGroup.firstBlock) {
                 do {
                     index = index->pprev;
-                    if (index->mintedPubCoins.count(denominationAndId) > 0)
-                        pubCoins.insert(pubCoins.begin(),
-                                        index->mintedPubCoins[denominationAndId].cbegin(),
-                                        index->mintedPubCoins[denominationAndId].cend());
+                    vector<CBigNum> blockPubCoins;
+                    if (!GetBlockMintedPubCoins(index, denominationAndId, blockPubCoins))
+                        return state.Error("CheckSpendBitcoinzeroTransaction: can't read zerocoin data");
+                    pubCoins.insert(pubCoins.begin(), blockPubCoins.cbegin(), blockPubCoins.cend());
                 } while (index != coinGroup.firstBlock);
             }
 
@@ -268,7 +569,7 @@ bool CheckSpendBitcoinzeroTransaction(const CTransaction &tx,
             if(!isVerifyDB && !isCheckWallet) {
                 if (zerocoinTxInfo && !zerocoinTxInfo->fInfoIsComplete) {
                     // add spend information to the index
-                    zerocoinTxInfo->spentSerials[serial] = (int)newSpend.getDenomination();
+                    zerocoinTxInfo->spentSerials[CZerocoinKey(serial)] = make_pair(serial, (int)newSpend.getDenomination());
                     zerocoinTxInfo->zcTransactions.insert(hashTx);
 
                     if (newSpend.getVersion() == ZEROCOIN_TX_VERSION_1)
@@ -284,6 +585,17 @@ bool CheckSpendBitcoinzeroTransaction(const CTransaction &tx,
 	return true;
 }
 
+bool CZerocoinSpendCheck::operator()() {
+    for (size_t i = 0; i < accumulatorValues.size(); i++) {
+        libzerocoin::Accumulator accumulator(params, accumulatorValues[i], denomination);
+        if (spend->Verify(accumulator, metaData)) {
+            spendCache.Set(cacheEntries[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
 bool CheckMintBitcoinzeroTransaction(const CTxOut &txout,
                                CValidationState &state,
                                uint256 hashTx,
@@ -332,7 +644,7 @@ bool CheckMintBitcoinzeroTransaction(const CTxOut &txout,
     case libzerocoin::ZQ_PEDERSEN*COIN:
     case libzerocoin::ZQ_WILLIAMSON*COIN:
         libzerocoin::CoinDenomination denomination = (libzerocoin::CoinDenomination)(txout.nValue / COIN);
-        libzerocoin::PublicCoin checkPubCoin(ZCParamsV2, pubCoin, denomination);
+        libzerocoin::PublicCoin checkPubCoin(ZCParamsV2(), pubCoin, denomination);
         if (!checkPubCoin.validate())
             return state.DoS(100,
                 false,
@@ -444,8 +756,8 @@ bool CheckZerocoinTransaction(const CTransaction &tx,
 	return true;
 }
 
-void DisconnectTipZC(CBlock & /*block*/, CBlockIndex *pindexDelete) {
-    zerocoinState.RemoveBlock(pindexDelete);
+bool DisconnectTipZC(CBlock & /*block*/, CBlockIndex *pindexDelete) {
+    return zerocoinState.RemoveBlock(pindexDelete);
 }
 
 CBigNum ZerocoinGetSpendSerialNumber(const CTransaction &tx) {
@@ -458,7 +770,7 @@ CBigNum ZerocoinGetSpendSerialNumber(const CTransaction &tx) {
         CDataStream serializedCoinSpend((const char *)&*(txin.scriptSig.begin() + 4),
                                     (const char *)&*txin.scriptSig.end(),
                                     SER_NETWORK, PROTOCOL_VERSION);
-        libzerocoin::CoinSpend spend(txin.nSequence >= ZC_MODULUS_V2_BASE_ID ? ZCParamsV2 : ZCParams, serializedCoinSpend);
+        libzerocoin::CoinSpend spend(txin.nSequence >= ZC_MODULUS_V2_BASE_ID ? ZCParamsV2() : ZCParams(), serializedCoinSpend);
         return spend.getCoinSerialNumber();
     }
     catch (const std::runtime_error &) {
@@ -483,17 +795,18 @@ bool ConnectBlockZC(CValidationState &state, const CChainParams &chainparams, CB
             }
         }
 
-	    if (!fJustCheck)
-			pindexNew->spentSerials.clear();
-	    
+        // zerocoin data of the block is built from scratch and replaces whatever was stored before
+        CZerocoinBlockData zerocoinData;
+
         if (pindexNew->nHeight > Params().nCheckBugFixedAtBlock) {
-            BOOST_FOREACH(const PAIRTYPE(CBigNum,int) &serial, pblock->zerocoinTxInfo->spentSerials) {
-                if (!CheckZerocoinSpendSerial(state, pblock->zerocoinTxInfo.get(), (libzerocoin::CoinDenomination)serial.second, serial.first, pindexNew->nHeight, true))
+            for (const auto &spentSerial: pblock->zerocoinTxInfo->spentSerials) {
+                const CBigNum &serial = spentSerial.second.first;
+                if (!CheckZerocoinSpendSerial(state, pblock->zerocoinTxInfo.get(), (libzerocoin::CoinDenomination)spentSerial.second.second, serial, pindexNew->nHeight, true))
                     return false;
 	            
 	            if (!fJustCheck) {
-		            pindexNew->spentSerials.insert(serial.first);
-		            zerocoinState.AddSpend(serial.first);
+		            zerocoinData.spentSerials.insert(serial);
+		            zerocoinState.AddSpend(serial);
 	            }
             }
         }
@@ -506,16 +819,22 @@ bool ConnectBlockZC(CValidationState &state, const CChainParams &chainparams, CB
             CBigNum oldAccValue(0);
             int denomination = mint.first;            
             int mintId = zerocoinState.AddMint(pindexNew, denomination, mint.second, oldAccValue);
+            if (mintId == 0)
+                return state.Error("ConnectBlockZC(): can't read zerocoin data of the previous mints");
 
-            libzerocoin::Params *zcParams = IsZerocoinTxV2((libzerocoin::CoinDenomination)denomination, mintId) ? ZCParamsV2 : ZCParams;
-
-            if (!oldAccValue)
-                oldAccValue = zcParams->accumulatorParams.accumulatorBase;
+            libzerocoin::Params *zcParams = IsZerocoinTxV2((libzerocoin::CoinDenomination)denomination, mintId) ? ZCParamsV2() : ZCParams();
 
             LogPrintf("ConnectTipZC: mint added denomination=%d, id=%d\n", denomination, mintId);
             pair<int,int> denomAndId = make_pair(denomination, mintId);
 
-            pindexNew->mintedPubCoins[denomAndId].push_back(mint.second);
+            // continue from the previous mint of the group in this block if there was one
+            if (zerocoinData.accumulatorChanges.count(denomAndId) > 0)
+                oldAccValue = zerocoinData.accumulatorChanges[denomAndId].first;
+
+            if (!oldAccValue)
+                oldAccValue = zcParams->accumulatorParams.accumulatorBase;
+
+            zerocoinData.mintedPubCoins[denomAndId].push_back(mint.second);
 
             CZerocoinState::CoinGroupInfo coinGroupInfo;
             zerocoinState.GetCoinGroupInfo(denomination, mintId, coinGroupInfo);
@@ -526,20 +845,23 @@ bool ConnectBlockZC(CValidationState &state, const CChainParams &chainparams, CB
                                                  (libzerocoin::CoinDenomination)denomination);
             accumulator += pubCoin;
 
-            if (pindexNew->accumulatorChanges.count(denomAndId) > 0) {
-                pair<CBigNum,int> &accChange = pindexNew->accumulatorChanges[denomAndId];
+            if (zerocoinData.accumulatorChanges.count(denomAndId) > 0) {
+                pair<CBigNum,int> &accChange = zerocoinData.accumulatorChanges[denomAndId];
                 accChange.first = accumulator.getValue();
                 accChange.second++;
             }
             else {
-                pindexNew->accumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), 1);
+                zerocoinData.accumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), 1);
             }
             // invalidate alternative accumulator value for this denomination and id
             pindexNew->alternativeAccumulatorChanges.erase(denomAndId);
-        }               
+        }
+
+        ZerocoinSetBlockData(pindexNew, zerocoinData);
     }
     else if (!fJustCheck) {
-        zerocoinState.AddBlock(pindexNew);
+        if (!zerocoinState.AddBlock(pindexNew))
+            return state.Error("ConnectBlockZC(): can't read zerocoin data of the block");
     }
 
 	return true;
@@ -559,10 +881,29 @@ int ZerocoinGetNHeight(const CBlockHeader &block) {
 
 bool ZerocoinBuildStateFromIndex(CChain *chain, set<CBlockIndex *> &changes) {
     zerocoinState.Reset();
-    for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
-        zerocoinState.AddBlock(blockIndex);
 
-    changes = zerocoinState.RecalculateAccumulators(chain);
+    // Start from the snapshot written on the last flush if its block is still in the chain
+    CBlockIndex *pindexStart = chain->Genesis();
+    CZerocoinStateSnapshot snapshot;
+    if (pblocktree->ReadZerocoinStateSnapshot(snapshot)) {
+        BlockMap::iterator mi = mapBlockIndex.find(snapshot.hashBlock);
+        if (snapshot.nSnapshotVersion == CZerocoinStateSnapshot::CURRENT_VERSION &&
+                mi != mapBlockIndex.end() && chain->Contains(mi->second) && zerocoinState.LoadSnapshot(snapshot)) {
+            LogPrintf("ZerocoinBuildStateFromIndex: loaded state snapshot at height %d\n", mi->second->nHeight);
+            pindexStart = chain->Next(mi->second);
+        }
+        else {
+            LogPrintf("ZerocoinBuildStateFromIndex: state snapshot doesn't match the chain, rebuilding\n");
+        }
+    }
+
+    for (CBlockIndex *blockIndex = pindexStart; blockIndex; blockIndex=chain->Next(blockIndex)) {
+        if (!zerocoinState.AddBlock(blockIndex))
+            return false;
+    }
+
+    if (!zerocoinState.RecalculateAccumulators(chain, changes))
+        return false;
 
     // DEBUG
     LogPrintf("Latest IDs are %d, %d, %d, %d, %d\n",
@@ -574,6 +915,19 @@ bool ZerocoinBuildStateFromIndex(CChain *chain, set<CBlockIndex *> &changes) {
 	return true;
 }
 
+bool ZerocoinWriteStateSnapshot(const CBlockIndex *pindexTip) {
+    if (pindexTip == NULL)
+        return true;
+
+    int64_t nTimeStart = GetTimeMicros();
+    CZerocoinStateSnapshot snapshot;
+    zerocoinState.GetSnapshot(pindexTip->GetBlockHash(), snapshot);
+    if (!pblocktree->WriteZerocoinStateSnapshot(snapshot))
+        return error("%s: failed to write zerocoin state", __func__);
+    LogPrint("bench", "    - Write zerocoin state snapshot at height %d: %.2fms\n", pindexTip->nHeight, 0.001 * (GetTimeMicros() - nTimeStart));
+    return true;
+}
+
 // CZerocoinTxInfo
 
 void CZerocoinTxInfo::Complete() {
@@ -591,16 +945,26 @@ void CZerocoinTxInfo::Complete() {
     fInfoIsComplete = true;
 }
 
-// CZerocoinState::CBigNumHash
+// CZerocoinKey
 
-std::size_t CZerocoinState::CBigNumHash::operator ()(const CBigNum &bn) const noexcept {
-    // we are operating on almost random big numbers and least significant bytes (save for few last bytes) give us a good hash
-    vector<unsigned char> bnData = bn.ToBytes();
-    if (bnData.size() < sizeof(size_t)*3)
-        // rare case, put ones like that into one hash bin
-        return 0;
-    else
-        return ((size_t*)bnData.data())[1];
+CZerocoinKey::CZerocoinKey(const CBigNum &bn) {
+    // large enough for the numbers of both moduli, bigger ones take the allocating path
+    unsigned char buffer[512];
+    unsigned char fNegative = BN_is_negative(&bn) ? 1 : 0;
+    int nBytes = BN_num_bytes(&bn);
+
+    CSHA256 hasher;
+    hasher.Write(&fNegative, 1);
+    if (nBytes <= (int)sizeof(buffer)) {
+        BN_bn2bin(&bn, buffer);
+        hasher.Write(buffer, nBytes);
+    }
+    else {
+        vector<unsigned char> vch(nBytes);
+        BN_bn2bin(&bn, vch.data());
+        hasher.Write(vch.data(), nBytes);
+    }
+    hasher.Finalize(begin());
 }
 
 // CZerocoinState
@@ -622,12 +986,17 @@ int CZerocoinState::AddMint(CBlockIndex *index, int denomination, const CBigNum
     CoinGroupInfo &coinGroup = coinGroups[make_pair(denomination, mintId)];
 	int coinsPerId = IsZerocoinTxV2((libzerocoin::CoinDenomination)denomination, mintId) ? ZC_SPEND_V2_COINSPERID : ZC_SPEND_V1_COINSPERID;
     if (coinGroup.nCoins < coinsPerId || coinGroup.lastBlock == index) {
+        // a previous mint of this block is picked up by the caller
+        if (coinGroup.nCoins > 0 && coinGroup.lastBlock != index) {
+            bool fFound;
+            if (!GetBlockAccumulatorValue(coinGroup.lastBlock, make_pair(denomination,mintId), false, previousAccValue, fFound))
+                return 0;
+        }
         if (coinGroup.nCoins++ == 0) {
             // first groups of coins for given denomination
             coinGroup.firstBlock = coinGroup.lastBlock = index;
         }
         else {
-            previousAccValue = coinGroup.lastBlock->accumulatorChanges[make_pair(denomination,mintId)].first;
             coinGroup.lastBlock = index;
         }
     }
@@ -642,50 +1011,65 @@ int CZerocoinState::AddMint(CBlockIndex *index, int denomination, const CBigNum
     coinInfo.denomination = denomination;
     coinInfo.id = mintId;
     coinInfo.nHeight = index->nHeight;
-    mintedPubCoins.insert(pair<CBigNum,CMintedCoinInfo>(pubCoin, coinInfo));
+    mintedPubCoins.insert(make_pair(CZerocoinKey(pubCoin), coinInfo));
 
     return mintId;
 }
 
 void CZerocoinState::AddSpend(const CBigNum &serial) {
-    usedCoinSerials.insert(serial);
+    usedCoinSerials.insert(CZerocoinKey(serial));
 }
 
-void CZerocoinState::AddBlock(CBlockIndex *index) {
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, index->accumulatorChanges)
+bool CZerocoinState::AddBlock(CBlockIndex *index) {
+    if (!index->HasZerocoinData())
+        return true;
+
+    std::shared_ptr<const CZerocoinBlockData> zerocoinData;
+    if (!ZerocoinGetBlockData(index, zerocoinData))
+        return false;
+
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), int) &mintCount, index->zerocoinMintCounts)
     {
-        CoinGroupInfo   &coinGroup = coinGroups[accUpdate.first];
+        CoinGroupInfo   &coinGroup = coinGroups[mintCount.first];
 
         if (coinGroup.firstBlock == NULL)
             coinGroup.firstBlock = index;
         coinGroup.lastBlock = index;
-        coinGroup.nCoins += accUpdate.second.second;
+        coinGroup.nCoins += mintCount.second;
     }
 
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, index->mintedPubCoins) {
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, zerocoinData->mintedPubCoins) {
         latestCoinIds[pubCoins.first.first] = pubCoins.first.second;
         BOOST_FOREACH(const CBigNum &coin, pubCoins.second) {
             CMintedCoinInfo coinInfo;
             coinInfo.denomination = pubCoins.first.first;
             coinInfo.id = pubCoins.first.second;
             coinInfo.nHeight = index->nHeight;
-            mintedPubCoins.insert(pair<CBigNum,CMintedCoinInfo>(coin, coinInfo));
+            mintedPubCoins.insert(make_pair(CZerocoinKey(coin), coinInfo));
         }
     }
 
     if (index->nHeight > Params().nCheckBugFixedAtBlock) {
-        BOOST_FOREACH(const CBigNum &serial, index->spentSerials) {
-            usedCoinSerials.insert(serial);
+        BOOST_FOREACH(const CBigNum &serial, zerocoinData->spentSerials) {
+            usedCoinSerials.insert(CZerocoinKey(serial));
         }
     }
+    return true;
 }
 
-void CZerocoinState::RemoveBlock(CBlockIndex *index) {
+bool CZerocoinState::RemoveBlock(CBlockIndex *index) {
+    if (!index->HasZerocoinData())
+        return true;
+
+    std::shared_ptr<const CZerocoinBlockData> zerocoinData;
+    if (!ZerocoinGetBlockData(index, zerocoinData))
+        return false;
+
     // roll back accumulator updates
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, index->accumulatorChanges)
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), int) &accUpdate, index->zerocoinMintCounts)
     {
         CoinGroupInfo   &coinGroup = coinGroups[accUpdate.first];
-        int  nMintsToForget = accUpdate.second.second;
+        int  nMintsToForget = accUpdate.second;
 
         assert(coinGroup.nCoins >= nMintsToForget);
 
@@ -700,14 +1084,14 @@ void CZerocoinState::RemoveBlock(CBlockIndex *index) {
             do {
                 assert(coinGroup.lastBlock != coinGroup.firstBlock);
                 coinGroup.lastBlock = coinGroup.lastBlock->pprev;
-            } while (coinGroup.lastBlock->accumulatorChanges.count(accUpdate.first) == 0);
+            } while (coinGroup.lastBlock->zerocoinMintCounts.count(accUpdate.first) == 0);
         }
     }
 
     // roll back mints
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, index->mintedPubCoins) {
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, zerocoinData->mintedPubCoins) {
         BOOST_FOREACH(const CBigNum &coin, pubCoins.second) {
-            auto coins = mintedPubCoins.equal_range(coin);
+            auto coins = mintedPubCoins.equal_range(CZerocoinKey(coin));
             auto coinIt = find_if(coins.first, coins.second, [=](const decltype(mintedPubCoins)::value_type &v) {
                 return v.second.denomination == pubCoins.first.first &&
                         v.second.id == pubCoins.first.second;
@@ -718,9 +1102,10 @@ void CZerocoinState::RemoveBlock(CBlockIndex *index) {
     }
 
     // roll back spends
-    BOOST_FOREACH(const CBigNum &serial, index->spentSerials) {
-        usedCoinSerials.erase(serial);
+    BOOST_FOREACH(const CBigNum &serial, zerocoinData->spentSerials) {
+        usedCoinSerials.erase(CZerocoinKey(serial));
     }
+    return true;
 }
 
 bool CZerocoinState::GetCoinGroupInfo(int denomination, int id, CoinGroupInfo &result) {
@@ -733,11 +1118,15 @@ bool CZerocoinState::GetCoinGroupInfo(int denomination, int id, CoinGroupInfo &r
 }
 
 bool CZerocoinState::IsUsedCoinSerial(const CBigNum &coinSerial) {
+    return IsUsedCoinSerial(CZerocoinKey(coinSerial));
+}
+
+bool CZerocoinState::IsUsedCoinSerial(const CZerocoinKey &coinSerial) {
     return usedCoinSerials.count(coinSerial) != 0;
 }
 
 bool CZerocoinState::HasCoin(const CBigNum &pubCoin) {
-    return mintedPubCoins.count(pubCoin) != 0;
+    return mintedPubCoins.count(CZerocoinKey(pubCoin)) != 0;
 }
 
 int CZerocoinState::GetAccumulatorValueForSpend(CChain *chain, int maxHeight, int denomination, int id,
@@ -751,33 +1140,28 @@ int CZerocoinState::GetAccumulatorValueForSpend(CChain *chain, int maxHeight, in
     CoinGroupInfo coinGroup = coinGroups[denomAndId];
     CBlockIndex *lastBlock = coinGroup.lastBlock;
 
-    assert(lastBlock->accumulatorChanges.count(denomAndId) > 0);
-    assert(coinGroup.firstBlock->accumulatorChanges.count(denomAndId) > 0);
+    assert(lastBlock->zerocoinMintCounts.count(denomAndId) > 0);
+    assert(coinGroup.firstBlock->zerocoinMintCounts.count(denomAndId) > 0);
 
     // is native modulus for denomination and id v2?
     bool nativeModulusIsV2 = IsZerocoinTxV2((libzerocoin::CoinDenomination)denomination, id);
-    // field in the block index structure for accesing accumulator changes
-    decltype(&CBlockIndex::accumulatorChanges) accChangeField;
-    if (nativeModulusIsV2 != useModulusV2) {
-        CalculateAlternativeModulusAccumulatorValues(chain, denomination, id);
-        accChangeField = &CBlockIndex::alternativeAccumulatorChanges;
-    }
-    else {
-        accChangeField = &CBlockIndex::accumulatorChanges;
-    }
+    bool fAlternativeModulus = nativeModulusIsV2 != useModulusV2;
+    if (fAlternativeModulus && !CalculateAlternativeModulusAccumulatorValues(chain, denomination, id))
+        return 0;
 
     int numberOfCoins = 0;
     for (;;) {
-        map<pair<int,int>, pair<CBigNum,int>> &accumulatorChanges = lastBlock->*accChangeField;
-        if (accumulatorChanges.count(denomAndId) > 0) {
+        if (lastBlock->zerocoinMintCounts.count(denomAndId) > 0) {
             if (lastBlock->nHeight <= maxHeight) {
                 if (numberOfCoins == 0) {
                     // latest block satisfying given conditions
                     // remember accumulator value and block hash
-                    accumulator = accumulatorChanges[denomAndId].first;
+                    bool fFound;
+                    if (!GetBlockAccumulatorValue(lastBlock, denomAndId, fAlternativeModulus, accumulator, fFound))
+                        return 0;
                     blockHash = lastBlock->GetBlockHash();
                 }
-                numberOfCoins += accumulatorChanges[denomAndId].second;
+                numberOfCoins += lastBlock->zerocoinMintCounts[denomAndId];
             }
         }
 
@@ -790,8 +1174,17 @@ int CZerocoinState::GetAccumulatorValueForSpend(CChain *chain, int maxHeight, in
     return numberOfCoins;
 }
 
-libzerocoin::AccumulatorWitness CZerocoinState::GetWitnessForSpend(CChain *chain, int maxHeight, int denomination,
-                                                                   int id, const CBigNum &pubCoin, bool useModulusV2) {
+CBigNum ZerocoinAccumulate(bool useModulusV2, int denomination, const CBigNum &value, const vector<CBigNum> &pubCoins) {
+    libzerocoin::Params *zcParams = useModulusV2 ? ZCParamsV2() : ZCParams();
+    libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
+    libzerocoin::Accumulator accumulator(zcParams, value, d);
+    for (const CBigNum &coin: pubCoins)
+        accumulator += libzerocoin::PublicCoin(zcParams, coin, d);
+    return accumulator.getValue();
+}
+
+bool CZerocoinState::GetWitnessPubCoinsForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin,
+                                                bool useModulusV2, CBigNum &value, vector<CBigNum> &pubCoins) {
 
     libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
     pair<int, int> denomAndId = pair<int, int>(denomination, id);
@@ -805,36 +1198,36 @@ libzerocoin::AccumulatorWitness CZerocoinState::GetWitnessForSpend(CChain *chain
 
     assert(coinId == id);
 
-    libzerocoin::Params *zcParams = useModulusV2 ? ZCParamsV2 : ZCParams;
+    libzerocoin::Params *zcParams = useModulusV2 ? ZCParamsV2() : ZCParams();
     bool nativeModulusIsV2 = IsZerocoinTxV2((libzerocoin::CoinDenomination)denomination, id);
-    decltype(&CBlockIndex::accumulatorChanges) accChangeField;
-    if (nativeModulusIsV2 != useModulusV2) {
-        CalculateAlternativeModulusAccumulatorValues(chain, denomination, id);
-        accChangeField = &CBlockIndex::alternativeAccumulatorChanges;
-    }
-    else {
-        accChangeField = &CBlockIndex::accumulatorChanges;
-    }
+    bool fAlternativeModulus = nativeModulusIsV2 != useModulusV2;
+    if (fAlternativeModulus && !CalculateAlternativeModulusAccumulatorValues(chain, denomination, id))
+        return false;
 
     // Find accumulator value preceding mint operation
     CBlockIndex *mintBlock = (*chain)[mintHeight];
     CBlockIndex *block = mintBlock;
-    libzerocoin::Accumulator accumulator(zcParams, d);
+    value = libzerocoin::Accumulator(zcParams, d).getValue();
     if (block != coinGroup.firstBlock) {
+        bool fFound;
         do {
             block = block->pprev;
-        } while ((block->*accChangeField).count(denomAndId) == 0);
-        accumulator = libzerocoin::Accumulator(zcParams, (block->*accChangeField)[denomAndId].first, d);
+            if (!GetBlockAccumulatorValue(block, denomAndId, fAlternativeModulus, value, fFound))
+                return false;
+        } while (!fFound);
     }
 
-    // Now add to the accumulator every coin minted since that moment except pubCoin
+    // Now collect every coin minted since that moment except pubCoin
+    pubCoins.clear();
     block = coinGroup.lastBlock;
     for (;;) {
-        if (block->nHeight <= maxHeight && block->mintedPubCoins.count(denomAndId) > 0) {
-            vector<CBigNum> &pubCoins = block->mintedPubCoins[denomAndId];
-            for (const CBigNum &coin: pubCoins) {
+        if (block->nHeight <= maxHeight && block->zerocoinMintCounts.count(denomAndId) > 0) {
+            vector<CBigNum> blockPubCoins;
+            if (!GetBlockMintedPubCoins(block, denomAndId, blockPubCoins))
+                return false;
+            for (const CBigNum &coin: blockPubCoins) {
                 if (block != mintBlock || coin != pubCoin)
-                    accumulator += libzerocoin::PublicCoin(zcParams, coin, d);
+                    pubCoins.push_back(coin);
             }
         }
         if (block != mintBlock)
@@ -843,11 +1236,63 @@ libzerocoin::AccumulatorWitness CZerocoinState::GetWitnessForSpend(CChain *chain
             break;
     }
 
-    return libzerocoin::AccumulatorWitness(zcParams, accumulator, libzerocoin::PublicCoin(zcParams, pubCoin, d));
+    return true;
+}
+
+bool CZerocoinState::GetWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin,
+                                        bool useModulusV2, CBigNum &witness) {
+    CBigNum value;
+    vector<CBigNum> pubCoins;
+    if (!GetWitnessPubCoinsForSpend(chain, maxHeight, denomination, id, pubCoin, useModulusV2, value, pubCoins))
+        return false;
+    witness = ZerocoinAccumulate(useModulusV2, denomination, value, pubCoins);
+    return true;
+}
+
+bool CZerocoinState::GetPubCoinsToAdvanceWitness(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin,
+                                                 const uint256 &hashWitnessBlock, vector<CBigNum> &pubCoins) {
+
+    pair<int, int> denomAndId = pair<int, int>(denomination, id);
+
+    BlockMap::const_iterator mi = mapBlockIndex.find(hashWitnessBlock);
+    if (mi == mapBlockIndex.end() || !chain->Contains(mi->second) || mi->second->nHeight > maxHeight)
+        return false;
+
+    if (coinGroups.count(denomAndId) == 0)
+        return false;
+
+    // No coins of the group are minted after its last block
+    pubCoins.clear();
+    int lastHeight = min(maxHeight, coinGroups[denomAndId].lastBlock->nHeight);
+    for (int nHeight = mi->second->nHeight + 1; nHeight <= lastHeight; nHeight++) {
+        CBlockIndex *block = (*chain)[nHeight];
+        if (block->zerocoinMintCounts.count(denomAndId) == 0)
+            continue;
+        vector<CBigNum> blockPubCoins;
+        if (!GetBlockMintedPubCoins(block, denomAndId, blockPubCoins))
+            return false;
+        for (const CBigNum &coin: blockPubCoins) {
+            if (coin != pubCoin)
+                pubCoins.push_back(coin);
+        }
+    }
+
+    return true;
+}
+
+bool CZerocoinState::AdvanceWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin,
+                                            bool useModulusV2, CBigNum &witness, uint256 &hashWitnessBlock) {
+    vector<CBigNum> pubCoins;
+    if (!GetPubCoinsToAdvanceWitness(chain, maxHeight, denomination, id, pubCoin, hashWitnessBlock, pubCoins))
+        return false;
+    if (!pubCoins.empty())
+        witness = ZerocoinAccumulate(useModulusV2, denomination, witness, pubCoins);
+    hashWitnessBlock = (*chain)[maxHeight]->GetBlockHash();
+    return true;
 }
 
 int CZerocoinState::GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomination, int &id) {
-    auto coins = mintedPubCoins.equal_range(pubCoin);
+    auto coins = mintedPubCoins.equal_range(CZerocoinKey(pubCoin));
     auto coinIt = find_if(coins.first, coins.second,
                           [=](const decltype(mintedPubCoins)::value_type &v) { return v.second.denomination == denomination; });
 
@@ -859,10 +1304,10 @@ int CZerocoinState::GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomin
         return -1;
 }
 
-void CZerocoinState::CalculateAlternativeModulusAccumulatorValues(CChain *chain, int denomination, int id) {
+bool CZerocoinState::CalculateAlternativeModulusAccumulatorValues(CChain *chain, int denomination, int id) {
     libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
     pair<int, int> denomAndId = pair<int, int>(denomination, id);
-    libzerocoin::Params *altParams = IsZerocoinTxV2(d, id) ? ZCParams : ZCParamsV2;
+    libzerocoin::Params *altParams = IsZerocoinTxV2(d, id) ? ZCParams() : ZCParamsV2();
     libzerocoin::Accumulator accumulator(altParams, d);
 
     assert(coinGroups.count(denomAndId) > 0);
@@ -871,14 +1316,16 @@ void CZerocoinState::CalculateAlternativeModulusAccumulatorValues(CChain *chain,
 
     CBlockIndex *block = coinGroup.firstBlock;
     for (;;) {
-        if (block->accumulatorChanges.count(denomAndId) > 0) {
+        if (block->zerocoinMintCounts.count(denomAndId) > 0) {
             if (block->alternativeAccumulatorChanges.count(denomAndId) > 0)
                 // already calculated, update accumulator with cached value
                 accumulator = libzerocoin::Accumulator(altParams, block->alternativeAccumulatorChanges[denomAndId].first, d);
             else {
                 // re-create accumulator changes with alternative params
-                assert(block->mintedPubCoins.count(denomAndId) > 0);
-                const vector<CBigNum> &mintedCoins = block->mintedPubCoins[denomAndId];
+                vector<CBigNum> mintedCoins;
+                if (!GetBlockMintedPubCoins(block, denomAndId, mintedCoins))
+                    return false;
+                assert(!mintedCoins.empty());
                 BOOST_FOREACH(const CBigNum &c, mintedCoins) {
                     accumulator += libzerocoin::PublicCoin(altParams, c, d);
                 }
@@ -891,6 +1338,7 @@ void CZerocoinState::CalculateAlternativeModulusAccumulatorValues(CChain *chain,
         else
             break;
     }
+    return true;
 }
 
 bool CZerocoinState::TestValidity(CChain *chain) {
@@ -898,28 +1346,35 @@ bool CZerocoinState::TestValidity(CChain *chain) {
         fprintf(stderr, "TestValidity[denomination=%d, id=%d]\n", coinGroup.first.first, coinGroup.first.second);
 
         bool fModulusV2 = IsZerocoinTxV2((libzerocoin::CoinDenomination)coinGroup.first.first, coinGroup.first.second);
-        libzerocoin::Params *zcParams = fModulusV2 ? ZCParamsV2 : ZCParams;
+        libzerocoin::Params *zcParams = fModulusV2 ? ZCParamsV2() : ZCParams();
 
         libzerocoin::Accumulator acc(&zcParams->accumulatorParams, (libzerocoin::CoinDenomination)coinGroup.first.first);
 
         CBlockIndex *block = coinGroup.second.firstBlock;
         for (;;) {
-            if (block->accumulatorChanges.count(coinGroup.first) > 0) {
-                if (block->mintedPubCoins.count(coinGroup.first) == 0) {
+            if (block->zerocoinMintCounts.count(coinGroup.first) > 0) {
+                std::shared_ptr<const CZerocoinBlockData> zerocoinData;
+                if (!ZerocoinGetBlockData(block, zerocoinData)) {
+                    fprintf(stderr, "  can't read zerocoin data at height %d\n", block->nHeight);
+                    return false;
+                }
+                if (zerocoinData->mintedPubCoins.count(coinGroup.first) == 0 || zerocoinData->accumulatorChanges.count(coinGroup.first) == 0) {
                     fprintf(stderr, "  no minted coins\n");
                     return false;
                 }
 
-                BOOST_FOREACH(const CBigNum &pubCoin, block->mintedPubCoins[coinGroup.first]) {
+                const vector<CBigNum> &pubCoins = zerocoinData->mintedPubCoins.at(coinGroup.first);
+                const pair<CBigNum,int> &accChange = zerocoinData->accumulatorChanges.at(coinGroup.first);
+                BOOST_FOREACH(const CBigNum &pubCoin, pubCoins) {
                     acc += libzerocoin::PublicCoin(zcParams, pubCoin, (libzerocoin::CoinDenomination)coinGroup.first.first);
                 }
 
-                if (acc.getValue() != block->accumulatorChanges[coinGroup.first].first) {
+                if (acc.getValue() != accChange.first) {
                     fprintf (stderr, "  accumulator value mismatch at height %d\n", block->nHeight);
                     return false;
                 }
 
-                if (block->accumulatorChanges[coinGroup.first].second != (int)block->mintedPubCoins[coinGroup.first].size()) {
+                if (accChange.second != (int)pubCoins.size() || block->zerocoinMintCounts[coinGroup.first] != accChange.second) {
                     fprintf(stderr, "  number of minted coins mismatch at height %d\n", block->nHeight);
                     return false;
                 }
@@ -937,27 +1392,30 @@ bool CZerocoinState::TestValidity(CChain *chain) {
     return true;
 }
 
-set<CBlockIndex *> CZerocoinState::RecalculateAccumulators(CChain *chain) {
-    set<CBlockIndex *> changes;
-
+bool CZerocoinState::RecalculateAccumulators(CChain *chain, set<CBlockIndex *> &changes) {
     BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), CoinGroupInfo) &coinGroup, coinGroups) {
         // Skip non-modulusv2 groups
         if (!IsZerocoinTxV2((libzerocoin::CoinDenomination)coinGroup.first.first, coinGroup.first.second))
             continue;
 
-        libzerocoin::Accumulator acc(&ZCParamsV2->accumulatorParams, (libzerocoin::CoinDenomination)coinGroup.first.first);
+        libzerocoin::Accumulator acc(&ZCParamsV2()->accumulatorParams, (libzerocoin::CoinDenomination)coinGroup.first.first);
 
         // Try to calculate accumulator for the first batch of mints. If it doesn't match we need to recalculate the rest of it
         CBlockIndex *block = coinGroup.second.firstBlock;
         for (;;) {
-            if (block->accumulatorChanges.count(coinGroup.first) > 0) {
-                BOOST_FOREACH(const CBigNum &pubCoin, block->mintedPubCoins[coinGroup.first]) {
-                    acc += libzerocoin::PublicCoin(ZCParamsV2, pubCoin, (libzerocoin::CoinDenomination)coinGroup.first.first);
+            if (block->zerocoinMintCounts.count(coinGroup.first) > 0) {
+                std::shared_ptr<const CZerocoinBlockData> storedData;
+                if (!ZerocoinGetBlockData(block, storedData))
+                    return false;
+                CZerocoinBlockData zerocoinData = *storedData;
+                const vector<CBigNum> &pubCoins = zerocoinData.mintedPubCoins[coinGroup.first];
+                BOOST_FOREACH(const CBigNum &pubCoin, pubCoins) {
+                    acc += libzerocoin::PublicCoin(ZCParamsV2(), pubCoin, (libzerocoin::CoinDenomination)coinGroup.first.first);
                 }
 
                 // First block case is special: do the check
                 if (block == coinGroup.second.firstBlock) {
-                    if (acc.getValue() != block->accumulatorChanges[coinGroup.first].first)
+                    if (acc.getValue() != zerocoinData.accumulatorChanges[coinGroup.first].first)
                         // recalculation is needed
                         LogPrintf("ZerocoinState: accumulator recalculation for denomination=%d, id=%d\n", coinGroup.first.first, coinGroup.first.second);
                     else
@@ -965,7 +1423,8 @@ set<CBlockIndex *> CZerocoinState::RecalculateAccumulators(CChain *chain) {
                         break;
                 }
 
-                block->accumulatorChanges[coinGroup.first] = make_pair(acc.getValue(), (int)block->mintedPubCoins[coinGroup.first].size());
+                zerocoinData.accumulatorChanges[coinGroup.first] = make_pair(acc.getValue(), (int)pubCoins.size());
+                ZerocoinSetBlockData(block, zerocoinData);
                 changes.insert(block);
             }
 
@@ -976,30 +1435,33 @@ set<CBlockIndex *> CZerocoinState::RecalculateAccumulators(CChain *chain) {
         }
     }
 
-    return changes;
+    return true;
 }
 
 bool CZerocoinState::AddSpendToMempool(const CBigNum &coinSerial, uint256 txHash) {
-    if (IsUsedCoinSerial(coinSerial) || mempoolCoinSerials.count(coinSerial))
+    CZerocoinKey key(coinSerial);
+    if (IsUsedCoinSerial(key) || mempoolCoinSerials.count(key))
         return false;
 
-    mempoolCoinSerials[coinSerial] = txHash;
+    mempoolCoinSerials[key] = txHash;
     return true;
 }
 
 void CZerocoinState::RemoveSpendFromMempool(const CBigNum &coinSerial) {
-    mempoolCoinSerials.erase(coinSerial);
+    mempoolCoinSerials.erase(CZerocoinKey(coinSerial));
 }
 
 uint256 CZerocoinState::GetMempoolConflictingTxHash(const CBigNum &coinSerial) {
-    if (mempoolCoinSerials.count(coinSerial) == 0)
+    auto it = mempoolCoinSerials.find(CZerocoinKey(coinSerial));
+    if (it == mempoolCoinSerials.end())
         return uint256();
 
-    return mempoolCoinSerials[coinSerial];
+    return it->second;
 }
 
 bool CZerocoinState::CanAddSpendToMempool(const CBigNum &coinSerial) {
-    return !IsUsedCoinSerial(coinSerial) && mempoolCoinSerials.count(coinSerial) == 0;
+    CZerocoinKey key(coinSerial);
+    return !IsUsedCoinSerial(key) && mempoolCoinSerials.count(key) == 0;
 }
 
 void CZerocoinState::Reset() {
@@ -1010,6 +1472,65 @@ void CZerocoinState::Reset() {
     mempoolCoinSerials.clear();
 }
 
+void CZerocoinState::GetSnapshot(const uint256 &hashBlock, CZerocoinStateSnapshot &snapshot) const {
+    snapshot.hashBlock = hashBlock;
+
+    snapshot.coinGroups.reserve(coinGroups.size());
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), CoinGroupInfo) &coinGroup, coinGroups) {
+        CZerocoinStateSnapshot::CoinGroup group;
+        group.denomination = coinGroup.first.first;
+        group.id = coinGroup.first.second;
+        group.firstBlockHash = coinGroup.second.firstBlock->GetBlockHash();
+        group.lastBlockHash = coinGroup.second.lastBlock->GetBlockHash();
+        group.nCoins = coinGroup.second.nCoins;
+        snapshot.coinGroups.push_back(group);
+    }
+
+    snapshot.mintedPubCoins.reserve(mintedPubCoins.size());
+    for (const auto &coin: mintedPubCoins) {
+        CZerocoinStateSnapshot::MintedCoin mintedCoin;
+        mintedCoin.pubCoin = coin.first;
+        mintedCoin.denomination = coin.second.denomination;
+        mintedCoin.id = coin.second.id;
+        mintedCoin.nHeight = coin.second.nHeight;
+        snapshot.mintedPubCoins.push_back(mintedCoin);
+    }
+
+    snapshot.latestCoinIds = latestCoinIds;
+    snapshot.usedCoinSerials.assign(usedCoinSerials.begin(), usedCoinSerials.end());
+}
+
+bool CZerocoinState::LoadSnapshot(const CZerocoinStateSnapshot &snapshot) {
+    Reset();
+
+    BOOST_FOREACH(const CZerocoinStateSnapshot::CoinGroup &group, snapshot.coinGroups) {
+        BlockMap::iterator first = mapBlockIndex.find(group.firstBlockHash);
+        BlockMap::iterator last = mapBlockIndex.find(group.lastBlockHash);
+        if (first == mapBlockIndex.end() || last == mapBlockIndex.end()) {
+            Reset();
+            return false;
+        }
+        CoinGroupInfo &coinGroup = coinGroups[make_pair(group.denomination, group.id)];
+        coinGroup.firstBlock = first->second;
+        coinGroup.lastBlock = last->second;
+        coinGroup.nCoins = group.nCoins;
+    }
+
+    mintedPubCoins.reserve(snapshot.mintedPubCoins.size());
+    BOOST_FOREACH(const CZerocoinStateSnapshot::MintedCoin &mintedCoin, snapshot.mintedPubCoins) {
+        CMintedCoinInfo coinInfo;
+        coinInfo.denomination = mintedCoin.denomination;
+        coinInfo.id = mintedCoin.id;
+        coinInfo.nHeight = mintedCoin.nHeight;
+        mintedPubCoins.insert(make_pair(mintedCoin.pubCoin, coinInfo));
+    }
+
+    latestCoinIds = snapshot.latestCoinIds;
+    usedCoinSerials.reserve(snapshot.usedCoinSerials.size());
+    usedCoinSerials.insert(snapshot.usedCoinSerials.begin(), snapshot.usedCoinSerials.end());
+    return true;
+}
+
 CZerocoinState *CZerocoinState::GetZerocoinState() {
     return &zerocoinState;
 }
@@ -10,9 +10,30 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
+#include <memory>
 
-// zerocoin parameters
-extern libzerocoin::Params *ZCParams, *ZCParamsV2;
+// zerocoin parameters, loaded from their precomputed values on first use
+libzerocoin::Params *ZCParams();
+libzerocoin::Params *ZCParamsV2();
+
+// Limit size of the cache of verified zerocoin spends to less than 4MB
+static const unsigned int DEFAULT_MAX_ZC_SPEND_CACHE_SIZE = 4;
+// Number of blocks whose zerocoin data is kept in memory
+static const unsigned int ZC_BLOCK_DATA_CACHE_SIZE = 2000;
+
+/**
+ * Fixed-width lookup key for a coin serial or public coin value: the SHA256 of the number. Keys are compared with
+ * memcmp and the hash tables use a word of the digest, so a lookup doesn't go through the bignum again.
+ */
+class CZerocoinKey : public uint256 {
+public:
+    CZerocoinKey() {}
+    explicit CZerocoinKey(const CBigNum &bn);
+};
+
+struct CZerocoinKeyHasher {
+    std::size_t operator()(const CZerocoinKey &key) const noexcept { return key.GetCheapHash(); }
+};
 
 // Test for zerocoin transaction version 2
 inline bool IsZerocoinTxV2(libzerocoin::CoinDenomination denomination, int coinId) {
@@ -24,6 +45,44 @@ inline bool IsZerocoinTxV2(libzerocoin::CoinDenomination denomination, int coinI
 	    || ((denomination == libzerocoin::ZQ_WILLIAMSON) && (coinId >= params.nSpendV2ID_100));
 }
 
+/**
+ * Closure representing the proof check of one zerocoin spend. The accumulator values are tried in order
+ * and the check passes as soon as the spend verifies against one of them.
+ */
+class CZerocoinSpendCheck {
+private:
+    const libzerocoin::Params *params;
+    std::shared_ptr<const libzerocoin::CoinSpend> spend;
+    libzerocoin::CoinDenomination denomination;
+    libzerocoin::SpendMetaData metaData;
+    vector<CBigNum> accumulatorValues;
+    // spend cache entry for every accumulator value
+    vector<uint256> cacheEntries;
+
+public:
+    CZerocoinSpendCheck(): params(NULL), denomination(libzerocoin::ZQ_LOVELACE), metaData(0, uint256()) {}
+    CZerocoinSpendCheck(const libzerocoin::Params *paramsIn, const libzerocoin::CoinSpend &spendIn,
+                        libzerocoin::CoinDenomination denominationIn, const libzerocoin::SpendMetaData &metaDataIn) :
+        params(paramsIn), spend(std::make_shared<libzerocoin::CoinSpend>(spendIn)), denomination(denominationIn), metaData(metaDataIn) {}
+
+    void AddAccumulatorValue(const CBigNum &accumulatorValue, const uint256 &cacheEntry) {
+        accumulatorValues.push_back(accumulatorValue);
+        cacheEntries.push_back(cacheEntry);
+    }
+    bool HasAccumulatorValues() const { return !accumulatorValues.empty(); }
+
+    bool operator()();
+
+    void swap(CZerocoinSpendCheck &check) {
+        std::swap(params, check.params);
+        spend.swap(check.spend);
+        std::swap(denomination, check.denomination);
+        std::swap(metaData, check.metaData);
+        accumulatorValues.swap(check.accumulatorValues);
+        cacheEntries.swap(check.cacheEntries);
+    }
+};
+
 // Zerocoin transaction info, added to the CBlock to ensure zerocoin mint/spend transactions got their info stored into
 // index
 class CZerocoinTxInfo {
@@ -32,8 +91,8 @@ public:
     set<uint256> zcTransactions;
     // <denomination, pubCoin> for all the mints
     vector<pair<int,CBigNum> > mints;
-    // serial for every spend (map from serial to denomination)
-    map<CBigNum,int> spentSerials;
+    // serial for every spend (map from serial key to serial and denomination)
+    unordered_map<CZerocoinKey,pair<CBigNum,int>,CZerocoinKeyHasher> spentSerials;
 
     // are there v1 spends in the block?
     bool fHasSpendV1;
@@ -41,7 +100,11 @@ public:
     // information about transactions in the block is complete
     bool fInfoIsComplete;
 
-    CZerocoinTxInfo(): fHasSpendV1(false), fInfoIsComplete(false) {}
+    // if set, spend proofs are not verified on the spot but collected into spendChecks
+    bool fDeferSpendChecks;
+    vector<CZerocoinSpendCheck> spendChecks;
+
+    CZerocoinTxInfo(): fHasSpendV1(false), fInfoIsComplete(false), fDeferSpendChecks(false) {}
     // finalize everything
     void Complete();
 };
@@ -55,7 +118,22 @@ bool CheckZerocoinTransaction(const CTransaction &tx,
     bool isCheckWallet,
     CZerocoinTxInfo *zerocoinTxInfo);
 
-void DisconnectTipZC(CBlock &block, CBlockIndex *pindexDelete);
+/**
+ * Gets the zerocoin data of a block, read from the block tree db unless recently used or not
+ * flushed yet. Returns false if it can't be read.
+ */
+bool ZerocoinGetBlockData(const CBlockIndex *pindex, std::shared_ptr<const CZerocoinBlockData> &data);
+/**
+ * Sets the zerocoin data of a block and updates the counts in its index entry. The data is written
+ * by the next FlushStateToDisk() along with the index entry, which the caller marks dirty.
+ */
+void ZerocoinSetBlockData(CBlockIndex *pindex, const CZerocoinBlockData &data);
+/** Zerocoin data set since the last flush. The pointers stay valid until ZerocoinBlockDataFlushed() */
+void ZerocoinGetDirtyBlockData(std::vector<std::pair<uint256, const CZerocoinBlockData *> > &vData);
+/** Called once the data returned by ZerocoinGetDirtyBlockData() is written */
+void ZerocoinBlockDataFlushed();
+
+bool DisconnectTipZC(CBlock &block, CBlockIndex *pindexDelete);
 bool ConnectBlockZC(CValidationState &state, const CChainParams &chainparams, CBlockIndex *pindexNew, const CBlock *pblock, bool fJustCheck=false);
 
 int ZerocoinGetNHeight(const CBlockHeader &block);
@@ -64,6 +142,78 @@ bool ZerocoinBuildStateFromIndex(CChain *chain, set<CBlockIndex *> &changes);
 
 CBigNum ZerocoinGetSpendSerialNumber(const CTransaction &tx);
 
+// Add pubCoins to the accumulator value of a denomination. Doesn't use the chain, no lock is needed
+CBigNum ZerocoinAccumulate(bool useModulusV2, int denomination, const CBigNum &value, const std::vector<CBigNum> &pubCoins);
+
+/*
+ * CZerocoinState as written to the block tree db on flush, with block index pointers replaced by block hashes.
+ * At startup only the blocks after hashBlock are added to the state loaded from it.
+ */
+class CZerocoinStateSnapshot {
+public:
+    static const int CURRENT_VERSION = 2;
+
+    struct CoinGroup {
+        int denomination;
+        int id;
+        uint256 firstBlockHash;
+        uint256 lastBlockHash;
+        int nCoins;
+
+        ADD_SERIALIZE_METHODS;
+        template <typename Stream, typename Operation>
+        inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+            READWRITE(denomination);
+            READWRITE(id);
+            READWRITE(firstBlockHash);
+            READWRITE(lastBlockHash);
+            READWRITE(nCoins);
+        }
+    };
+
+    struct MintedCoin {
+        CZerocoinKey pubCoin;
+        int denomination;
+        int id;
+        int nHeight;
+
+        ADD_SERIALIZE_METHODS;
+        template <typename Stream, typename Operation>
+        inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+            READWRITE(pubCoin);
+            READWRITE(denomination);
+            READWRITE(id);
+            READWRITE(nHeight);
+        }
+    };
+
+    int nSnapshotVersion;
+    // block the state is at
+    uint256 hashBlock;
+    vector<CoinGroup> coinGroups;
+    vector<MintedCoin> mintedPubCoins;
+    map<int, int> latestCoinIds;
+    vector<CZerocoinKey> usedCoinSerials;
+
+    CZerocoinStateSnapshot() : nSnapshotVersion(CURRENT_VERSION) {}
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(nSnapshotVersion);
+        if (nSnapshotVersion != CURRENT_VERSION)
+            return;
+        READWRITE(hashBlock);
+        READWRITE(coinGroups);
+        READWRITE(mintedPubCoins);
+        READWRITE(latestCoinIds);
+        READWRITE(usedCoinSerials);
+    }
+};
+
+/** Writes the zerocoin state, which has to be at pindexTip, to the block tree db */
+bool ZerocoinWriteStateSnapshot(const CBlockIndex *pindexTip);
+
 /*
  * State of minted/spent coins as extracted from the index
  */
@@ -82,11 +232,6 @@ public:
     };
 
 private:
-    // Custom hash for big numbers
-    struct CBigNumHash {
-        std::size_t operator()(const CBigNum &bn) const noexcept;
-    };
-
     struct CMintedCoinInfo {
         int         denomination;
         int         id;
@@ -96,7 +241,7 @@ private:
     // Collection of coin groups. Map from <denomination,id> to CoinGroupInfo structure
     map<pair<int, int>, CoinGroupInfo> coinGroups;
     // Set of all minted pubCoin values
-    unordered_multimap<CBigNum,CMintedCoinInfo,CBigNumHash> mintedPubCoins;
+    unordered_multimap<CZerocoinKey,CMintedCoinInfo,CZerocoinKeyHasher> mintedPubCoins;
     // Latest IDs of coins by denomination
     map<int, int> latestCoinIds;
 
@@ -105,52 +250,76 @@ public:
     CZerocoinState();
 
     // Set of all used coin serials. Allows multiple entries for the same coin serial for historical reasons
-    unordered_multiset<CBigNum,CBigNumHash> usedCoinSerials;
+    unordered_multiset<CZerocoinKey,CZerocoinKeyHasher> usedCoinSerials;
 
     // serials of spends currently in the mempool mapped to tx hashes
-    unordered_map<CBigNum,uint256,CBigNumHash> mempoolCoinSerials;
+    unordered_map<CZerocoinKey,uint256,CZerocoinKeyHasher> mempoolCoinSerials;
 
-    // Add mint, automatically assigning id to it. Returns id and previous accumulator value (if any)
+    // Add mint, automatically assigning id to it. Returns id and previous accumulator value (if any),
+    // 0 if the zerocoin data of the previous block of the group can't be read
     int AddMint(CBlockIndex *index, int denomination, const CBigNum &pubCoin, CBigNum &previousAccValue);
     // Add serial to the list of used ones
     void AddSpend(const CBigNum &serial);
 
-    // Add everything from the block to the state
-    void AddBlock(CBlockIndex *index);
-    // Disconnect block from the chain rolling back mints and spends
-    void RemoveBlock(CBlockIndex *index);
+    // Add everything from the block to the state. Returns false if its zerocoin data can't be read
+    bool AddBlock(CBlockIndex *index);
+    // Disconnect block from the chain rolling back mints and spends. Returns false if its zerocoin data can't be read
+    bool RemoveBlock(CBlockIndex *index);
 
     // Query coin group with given denomination and id
     bool GetCoinGroupInfo(int denomination, int id, CoinGroupInfo &result);
 
     // Query if the coin serial was previously used
     bool IsUsedCoinSerial(const CBigNum &coinSerial);
+    bool IsUsedCoinSerial(const CZerocoinKey &coinSerial);
     // Query if there is a coin with given pubCoin value
     bool HasCoin(const CBigNum &pubCoin);
 
     // Given denomination and id returns latest accumulator value and corresponding block hash
     // Do not take into account coins with height more than maxHeight
-    // Returns number of coins satisfying conditions
+    // Returns number of coins satisfying conditions, 0 if the zerocoin data of a block can't be read
     int GetAccumulatorValueForSpend(CChain *chain, int maxHeight, int denomination, int id, CBigNum &accumulator, uint256 &blockHash, bool useModulusV2);
 
-    // Get witness
-    libzerocoin::AccumulatorWitness GetWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin, bool useModulusV2);
+    // Get the accumulator value preceding the mint of pubCoin and the other coins of its group minted up to
+    // maxHeight, the two make up the witness of pubCoin. False if the zerocoin data of a block can't be read
+    bool GetWitnessPubCoinsForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin, bool useModulusV2,
+                                    CBigNum &value, std::vector<CBigNum> &pubCoins);
+
+    // Get witness, false if the zerocoin data of a block can't be read
+    bool GetWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin, bool useModulusV2, CBigNum &witness);
+
+    // Add the coins minted after block hashWitnessBlock up to maxHeight to a witness of GetWitnessForSpend
+    // and move hashWitnessBlock to the block at maxHeight. Returns false if hashWitnessBlock is not in
+    // the chain anymore or above maxHeight, the witness has to be rebuilt then. Also false if the zerocoin
+    // data of a block can't be read
+    bool AdvanceWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin, bool useModulusV2,
+                                CBigNum &witness, uint256 &hashWitnessBlock);
+
+    // Get the coins AdvanceWitnessForSpend adds to a witness without accumulating them, same return value
+    bool GetPubCoinsToAdvanceWitness(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin,
+                                     const uint256 &hashWitnessBlock, std::vector<CBigNum> &pubCoins);
 
     // Return height of mint transaction and id of minted coin
     int GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomination, int &id);
 
-    // If needed calculate accumulators for alternative accumulator modulus
-    void CalculateAlternativeModulusAccumulatorValues(CChain *chain, int denomination, int id);
+    // If needed calculate accumulators for alternative accumulator modulus. Returns false if the zerocoin data
+    // of a block can't be read
+    bool CalculateAlternativeModulusAccumulatorValues(CChain *chain, int denomination, int id);
 
     // Reset to initial values
     void Reset();
 
+    // Copy the state into a snapshot taken at block hashBlock
+    void GetSnapshot(const uint256 &hashBlock, CZerocoinStateSnapshot &snapshot) const;
+    // Replace the state with the snapshot. Returns false and leaves the state empty if it refers to unknown blocks
+    bool LoadSnapshot(const CZerocoinStateSnapshot &snapshot);
+
     // Test function
     bool TestValidity(CChain *chain);
 
     // Recalculate accumulators. Needed if upgrade from pre-modulusv2 version is detected
-    // Returns set of indices that changed
-    set<CBlockIndex *> RecalculateAccumulators(CChain *chain);
+    // Adds the indices that changed to changes, returns false if the zerocoin data of a block can't be read
+    bool RecalculateAccumulators(CChain *chain, set<CBlockIndex *> &changes);
 
     // Check if there is a conflicting tx in the blockchain or mempool
     bool CanAddSpendToMempool(const CBigNum &coinSerial);
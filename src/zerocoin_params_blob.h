@@ -0,0 +1,86 @@
+// Generated by libzerocoin/paramblob, do not edit.
+// Serialized libzerocoin::Params for the moduli in zerocoin_params.h and
+// the double SHA256 of every blob.
+
+#ifndef ZEROCOIN_PARAMS_BLOB_H
+#define ZEROCOIN_PARAMS_BLOB_H
+
+static const char ZEROCOIN_PARAMS_BLOB[] =
+    "0101fd35015703722021822271391020219143563686375119382735026453444050889978163814835421918932375663382629966724772571814977707807"
+    "35235751164692204042784145447565140119324463524941043983033614443813566267191620566030770366510481740601153816981128243882846523"
+    "34997320794474471887334298675743204665181485902537364322241849759869682182226354261715151246871195718191864542061029747901844208"
+    "88745904339700709590857933617750169146827149017563896102274783417159737677280728398726994428072091480828508461174991559892188250"
+    "5149126490829106447880585218402656555907070262360436781377770232402026212829145798830440321827404993786575849095510202c103004668"
+    "220bac4912c9c854042e1f5db23f40ece2a788ba9650351c873cdaaaeddbcc52a445784311c8a92cf4f0d2db49f9447e742944959c8e9bd5eb42b060159453ce"
+    "6d906abc0746069a18d307da3c865e09c60d5c9ab946e5ea6213b584dee9279570bad8250c60c6c93c6cadbee399370d1fadd0aeed7a9b395947cd70ee078c46"
+    "7195d65ad47fdb8b442e2f044653093c1bf9f678d2de9f55f35645f2f3961ba9cb155bb43b0d4324bfa6739cc60dc30a46835ac77eb1eab8a10d91d3af7892cb"
+    "101ab6b3f1d34bf078aafc3946d97a926e19092131ecb06c3a2e9b3e192817217ef86800cf7ab07828e89a39e76811f3ea08652a0100fd3501abbd79fc1f48a0"
+    "7c44e48671db13cf786bbf4a100461319fbd7d4fd51a5f8fdf0b9e03a9c95e41bc79ff552404cfe52d202f4fe46b468be130e0c408eaf08f47ba39ae9cb21fd7"
+    "e648a38848e45fc65d135749392f24d92fa300919d5e6719bb033fba37f89db3f81791ad3b9ac0e8aa8e5f8f8930659ca8a2a888ece82ccd03a791fb72caded6"
+    "feda83d0dc23b311d6f1430653f65476f7f957672c57d7d25776e0644552662cfdb56ac370aca32684ce7e926ffe109cd6fcbd3ce9f8485ca587dc4b4e739ec1"
+    "05a9873d0aac32e47e045c2287e9acc9cd14457596e6fed8b83aeb74e21cb5b43db768ce8663f8a59af49395f7bf3db8efbd8edaad6a4e7c2b801db90893562c"
+    "889193483c277f194a7a1148715d44231646a0a9b58676afd7a32ae770171b02ba14817f7a65c0712dc1dc2e6c01fd350112ff1be82210cc7b91480ca37f54ca"
+    "487e4b38c93ac5a121e63f72351702a6ec93ca2aa93f14eb2f27d85fb0fd2b17dfce3db5e00105d6445521435c1a86862f9f5d185b537bb2c4456381270a1c93"
+    "d2052254c01416b194153ae3d8d392103a385f61d17710e9f27d48d17f69d2b371e5d5f476d1fda4419cef126084f10959143a63c346c31daac6169b19ffcbcd"
+    "f6a803d797597d841a629721c50c0c6383e6ceb07ce81f48a7c5f4b4a7fde36cc8e51e78ee96715033b34ae9c2c324be23346e319b64f71e83dfc397d73bbb57"
+    "a7b11f8a4392706fa46f6943a50bb0eb29c1a3ae7a4b5ef50d032952a04ba57ece8bc0025732ae1c58d2fdc40bbc98db0835e8d1942d840c2be69736dfebe480"
+    "d2a76fa85e82b29b761e2113b5cb8c72637d71b20feaee17608a0e591af82c23815f7f9615010000410000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000008819ffe13070b2c7746ed631b53a59e214562e6ef63bf"
+    "0d62d2f38b0349bf27d768b9131eae792efb6f057d868b3f6568800e9bbdf01cfa50a20057cc15dd7880f895450f44c07634de61b6baa206edf499c4157b1452"
+    "db1903d57cd9e4fd38789dee6451411ededbbc3f1a4bbdb285802356713293671bb81dbbb56cb5770ab9d000a000000080000000008008bc30ab82c20b90d6f2"
+    "5a995147b79982939a33176328a2430414232869cfc7c7e9371e5c31b3715f476021bf8a282ecd81df9b6366a30e2bfeac5fde332caa7a81761d4fba23f45a8a"
+    "523eec553152b196d167553a8ab861aaf06ce4232dfbe455542c2f5a6d4a0c90bfa99c4cfe57e50b0253ab52ff045be47554ac71661680d71edf1faed7cdecf9"
+    "13fcd694e633c7c50a07ba78682aff6ebf5a03ae13ec73215005f76d184a20729da868fb8fdd7b4bb827b2798b7dba5a2b50144f1cf8c59dab37abb94000b7c3"
+    "42c11d418487c4b1d53856a365ee30469023e5d17a416f9bf96c1e605fcb32e90d45c44f4d8adf0b727470f6ccb75780f5b672750c7e07819ffe13070b2c7746"
+    "ed631b53a59e214562e6ef63bf0d62d2f38b0349bf27d768b9131eae792efb6f057d868b3f6568800e9bbdf01cfa50a20057cc15dd7880f895450f44c07634de"
+    "61b6baa206edf499c4157b1452db1903d57cd9e4fd38789dee6451411ededbbc3f1a4bbdb285802356713293671bb81dbbb56cb5770ab9d00021d3d2b9a02443"
+    "e626fe79dc0eb54c049b001ba38ccc72f58d7119466d38a84ccd000081734e7a0e8c99bdcec1c4f20f89ace13d524a617c5870b9a4123c3e7971b8287f6376ba"
+    "b25d8f95d801c5681f4e39555d301e28b36f48ab3588c1ed092405f938d6574bbc7fba132c9d134eaf29f3f6810bd9be0b448a10fee79fdbd344d6ed0e7514e0"
+    "ac4c96361d84d530538759af6008bc8445eccf75de051fd67f1cee44b90c81b600eb8af4c2882b7a9f1dda04bb4c57037a65e4ce9af7fc8bfa407b3dc269593c"
+    "ae4527a196f09881a4e0d1895970a8cdab1b128a210ad3a18e6dcdc054dbe84892513c1741745a41ef7b4190e22465023640df6321ef4b6460fb9f318113688f"
+    "8d8eb1753e50421fe6e88a3d8ba16287fd5b15008abe5a221852e77b1017183781cf62e726e99c1161a97f32029fa5f8c8c297d4803a1faaaf935294832eb3cf"
+    "af90c864892fb2dadd6bace3214c167d2e750c6f34e3600f4848befeb473d235a9c8fccc4e9ee15cf394372577f48c118f8cb1cf1e8daa8361db96d9e80f6189"
+    "1f42f23e1679e9e81962b0714b98893bcf5b78768c1f34fc3b53ed68ca4ea966f25c819ffe13070b2c7746ed631b53a59e214562e6ef63bf0d62d2f38b0349bf"
+    "27d768b9131eae792efb6f057d868b3f6568800e9bbdf01cfa50a20057cc15dd7880f895450f44c07634de61b6baa206edf499c4157b1452db1903d57cd9e4fd"
+    "38789dee6451411ededbbc3f1a4bbdb285802356713293671bb81dbbb56cb5770ab9d0005000000050000000";
+static const char ZEROCOIN_PARAMS_BLOB_HASH[] = "a7ec7d5d604f375bbda296eace7f8fceb8d02b52f6051947868308920c0fb4fd";
+
+static const char ZEROCOIN_PARAMS_V2_BLOB[] =
+    "0101fd0101e5c71c36c6489d3916bcf71768eba533e724c85450f930ccbc6628171556f531311b0ffca3241f72d873d3d9a4166be523793b3c5bdc614cf22029"
+    "64929572bc32adbd2595902c8765ad956aac109f6005cd80dcad1318cbb53453f8095813f659517da33e5f95eb6ce69d430927443f374dd689af79c402fc666c"
+    "d2efdae8f74a52efbd92f535bebb30d7c4c291b98eba643167d1e41b78fd7b1fb5044af1b4359f03803ca30ed492855ecfc709eb46b68433c9ffb6b4448bff65"
+    "770b5b1fa313288c64f00741a032deacc2acee1a72bd110065d1932fc79e18a11e8edbf07f5bbb5035466f72a8f1f590c781109173cd13a67a1a20904475b0c3"
+    "dcee0c97c70002c103004668220bac4912c9c854042e1f5db23f40ece2a788ba9650351c873cdaaaeddbcc52a445784311c8a92cf4f0d2db49f9447e74294495"
+    "9c8e9bd5eb42b060159453ce6d906abc0746069a18d307da3c865e09c60d5c9ab946e5ea6213b584dee9279570bad8250c60c6c93c6cadbee399370d1fadd0ae"
+    "ed7a9b395947cd70ee078c467195d65ad47fdb8b442e2f044653093c1bf9f678d2de9f55f35645f2f3961ba9cb155bb43b0d4324bfa6739cc60dc30a46835ac7"
+    "7eb1eab8a10d91d3af7892cb101ab6b3f1d34bf078aafc3946d97a926e19092131ecb06c3a2e9b3e192817217ef86800cf7ab07828e89a39e76811f3ea08652a"
+    "0100fd00013af67773e96c967550708dd569175ff4fc93e23623907e9c6bf1515e6ca969f276f1705b7779a367e9182b36cfbab21b24fe8c1e4ab8f469d1ccf6"
+    "0ead6993d8496f1e4071c1f222e0eac9b443113c95f721c2979257f04594087b6e5fae7d48ba321949733100fb4dd669480236296d23797b1ad6ca71ec66b283"
+    "87c511d90bb045bc8f31d557c9d82e19bc4f6bb920e3a51e7a5d809c13a5c631968df49feafb2d18794a3b0d81ed047ae416d22bd9901da29074ad0e562964d3"
+    "c791064467da0f68282310a0f5cab2691d2bb51a6be079587b988a6b63cdfefe28791324ff4a1ece68b96dfdb0ffca722bfc97c0baf9da774dbbbecac9fe4a2b"
+    "4e56dc2463fd000102d847efc664c5b5f7b6e9dc95d38fb4622a4484284e74364f8ab3606d4b6a9e10a2f63c32007de97991eb26609a64e15ca8567f80ec3402"
+    "f016b111fe2147f6d00ef551cbd70b32ee28f1570739e0faa4c64d2ddcbb912566000ef7148a35a073109ec46378cdac024426e785a5228dc6e2eabfa9eb04b8"
+    "9fe04c1b37c746f1504557b262b2cb45d305790077d4394b326819f235cce029aa4c2108f5595a3bd7757dccd261107cb3cfce786bb7b64e0d0fa1bd4d45a411"
+    "61b15292fd386f7248b437bd4e747d2b014e1d49117739d9be077ee44f526d2bf5d3d412fdb2d281f030a77fef640cea9557d2ec0faf1236151bfb523ded6025"
+    "bdc409d157bea3610000410000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000008819ffe13070b2c7746ed631b53a59e214562e6ef63bf0d62d2f38b0349bf27d768b9131eae792efb6f057d868b3f6568800e9bbd"
+    "f01cfa50a20057cc15dd7880f895450f44c07634de61b6baa206edf499c4157b1452db1903d57cd9e4fd38789dee6451411ededbbc3f1a4bbdb2858023567132"
+    "93671bb81dbbb56cb5770ab9d000a000000080000000008008bc30ab82c20b90d6f25a995147b79982939a33176328a2430414232869cfc7c7e9371e5c31b371"
+    "5f476021bf8a282ecd81df9b6366a30e2bfeac5fde332caa7a81761d4fba23f45a8a523eec553152b196d167553a8ab861aaf06ce4232dfbe455542c2f5a6d4a"
+    "0c90bfa99c4cfe57e50b0253ab52ff045be47554ac71661680d71edf1faed7cdecf913fcd694e633c7c50a07ba78682aff6ebf5a03ae13ec73215005f76d184a"
+    "20729da868fb8fdd7b4bb827b2798b7dba5a2b50144f1cf8c59dab37abb94000b7c342c11d418487c4b1d53856a365ee30469023e5d17a416f9bf96c1e605fcb"
+    "32e90d45c44f4d8adf0b727470f6ccb75780f5b672750c7e07819ffe13070b2c7746ed631b53a59e214562e6ef63bf0d62d2f38b0349bf27d768b9131eae792e"
+    "fb6f057d868b3f6568800e9bbdf01cfa50a20057cc15dd7880f895450f44c07634de61b6baa206edf499c4157b1452db1903d57cd9e4fd38789dee6451411ede"
+    "dbbc3f1a4bbdb285802356713293671bb81dbbb56cb5770ab9d00021d3d2b9a02443e626fe79dc0eb54c049b001ba38ccc72f58d7119466d38a84ccd00008173"
+    "4e7a0e8c99bdcec1c4f20f89ace13d524a617c5870b9a4123c3e7971b8287f6376bab25d8f95d801c5681f4e39555d301e28b36f48ab3588c1ed092405f938d6"
+    "574bbc7fba132c9d134eaf29f3f6810bd9be0b448a10fee79fdbd344d6ed0e7514e0ac4c96361d84d530538759af6008bc8445eccf75de051fd67f1cee44b90c"
+    "81b600eb8af4c2882b7a9f1dda04bb4c57037a65e4ce9af7fc8bfa407b3dc269593cae4527a196f09881a4e0d1895970a8cdab1b128a210ad3a18e6dcdc054db"
+    "e84892513c1741745a41ef7b4190e22465023640df6321ef4b6460fb9f318113688f8d8eb1753e50421fe6e88a3d8ba16287fd5b15008abe5a221852e77b1017"
+    "183781cf62e726e99c1161a97f32029fa5f8c8c297d4803a1faaaf935294832eb3cfaf90c864892fb2dadd6bace3214c167d2e750c6f34e3600f4848befeb473"
+    "d235a9c8fccc4e9ee15cf394372577f48c118f8cb1cf1e8daa8361db96d9e80f61891f42f23e1679e9e81962b0714b98893bcf5b78768c1f34fc3b53ed68ca4e"
+    "a966f25c819ffe13070b2c7746ed631b53a59e214562e6ef63bf0d62d2f38b0349bf27d768b9131eae792efb6f057d868b3f6568800e9bbdf01cfa50a20057cc"
+    "15dd7880f895450f44c07634de61b6baa206edf499c4157b1452db1903d57cd9e4fd38789dee6451411ededbbc3f1a4bbdb285802356713293671bb81dbbb56c"
+    "b5770ab9d0005000000050000000";
+static const char ZEROCOIN_PARAMS_V2_BLOB_HASH[] = "b42cad84b369bf9ff08e2e6f81f612613eb69b15d43e5978fe94e8da86f10a73";
+
+#endif // ZEROCOIN_PARAMS_BLOB_H